@@ -0,0 +1,78 @@
+/*
+Measures the time per state of the escape time of the built-in maps in double precision, computed one state at a time
+(`observable::generic::EscapeTime<double>`) and for a batch of states (`map::batch::escape_time`), for every SIMD
+width supported by the CPU.
+*/
+#include <chrono>
+
+#include "batch.h"
+#include "observable.h"
+#include "proposal.h"
+
+
+typedef Eigen::Matrix<double, Eigen::Dynamic, 1> DVector;
+
+
+//! returns the time in nanoseconds of the escape time of one state, averaged over the `points`.
+template <typename Map>
+double time_scalar(Map & map, std::vector<DVector> const& points, unsigned int max_time) {
+    observable::generic::EscapeTime<double> observable(map, max_time);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < points.size(); i++)
+        observable.observe(points[i]);
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count()/points.size();
+}
+
+
+//! the same as `time_scalar`, with a batch of all the `points`.
+template <typename BatchMap>
+double time_batch(BatchMap const& map, std::vector<DVector> const& points, unsigned int max_time) {
+    map::batch::Block<double> block(points[0].size(), points.size());
+    for (size_t i = 0; i < points.size(); i++)
+        block.set(i, points[i]);
+    std::vector<unsigned int> times;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    map::batch::escape_time(map, block, max_time, times);
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count()/points.size();
+}
+
+
+template <typename BatchMap, typename Map>
+void measure(std::string const& name, BatchMap const& batch_map, Map & map, unsigned int N, unsigned int max_time) {
+    std::vector<DVector> points(N);
+    for (unsigned int i = 0; i < N; i++)
+        points[i] = proposal::proposeUniform(map.boundary);
+
+    double scalar_time = time_scalar(map, points, max_time);
+    for (int width = 16; width <= map::batch::simd::max_width(); width *= 2) {
+        map::batch::simd::width() = width;
+        double batch_time = time_batch(batch_map, points, max_time);
+        std::cout << format("%-16s %2d bytes: %8.1f ns (scalar) %8.1f ns (batch) speedup %.2f",
+                            name.c_str(), width, scalar_time, batch_time, scalar_time/batch_time) << std::endl;
+    }
+    map::batch::simd::width() = map::batch::simd::max_width();
+}
+
+
+int main() {
+    unsigned int N = 1 << 16;
+    unsigned int max_time = 100;
+
+    map::generic::OpenTent<double> open_tent(3, 5);
+    measure("OpenTent", map::batch::OpenTent<double>(3, 5), open_tent, N, max_time);
+
+    map::generic::Logistic<double> logistic(4);
+    measure("Logistic", map::batch::Logistic<double>(4), logistic, N, max_time);
+
+    map::generic::Standard<double> standard(6);
+    measure("Standard", map::batch::Standard<double>(6), standard, N, max_time);
+
+    map::generic::NCoupledHenon<double> henon(8);
+    measure("NCoupledHenon(8)", map::batch::NCoupledHenon<double>(8), henon, N/8, max_time);
+
+    return 0;
+}
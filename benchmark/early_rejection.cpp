@@ -0,0 +1,46 @@
+/*
+Measures the time per Markov step of the canonical ensembles exp(-beta t) of the escape time t of the standard map in
+`mpfr::mpreal`, with uniform proposals, without and with `MetropolisHastings::early_rejection`, for beta from 0.25 to 2.
+*/
+#include <chrono>
+
+#include "map.h"
+#include "sampler.h"
+
+
+//! returns the time in microseconds of one Markov step and the mean escape time of the samples.
+std::pair<double, double> time_step(map::Standard & map, double beta, bool early_rejection, unsigned int samples) {
+    observable::EscapeTime observable(map, 199);
+    SamplingHistogram<observable::EscapeTime> histogram(0, 200, 200);
+    for (unsigned int b = 0; b <= histogram.bins(); b++)
+        histogram.log_pi[b] = -beta*b;
+    proposal::Uniform<observable::EscapeTime> proposal(map.boundary);
+    MetropolisHastings<observable::EscapeTime, proposal::Uniform<observable::EscapeTime> > mc(observable, proposal,
+                                                                                            histogram);
+    mc.early_rejection = early_rejection;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    mc.sample(samples, samples/10);
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+    double mean = 0;
+    for (unsigned int b = 0; b < histogram.bins(); b++)
+        mean += histogram.value(b)*histogram[b]*1./histogram.count();
+    return std::make_pair(elapsed.count()/(samples + samples/10), mean);
+}
+
+
+int main() {
+    unsigned int samples = 20000;
+    mpfr::mpreal::set_default_prec(128);
+    map::Standard map(6);
+
+    for (double beta = 0.25; beta <= 2; beta *= 2) {
+        std::pair<double, double> full = time_step(map, beta, false, samples);
+        std::pair<double, double> early = time_step(map, beta, true, samples);
+        std::cout << format("beta %4.2f: %8.2f us (<t> = %5.2f) with early rejection %8.2f us (<t> = %5.2f) "
+                            "speedup %5.2f", beta, full.first, full.second, early.first, early.second,
+                            full.first/early.first) << std::endl;
+    }
+    return 0;
+}
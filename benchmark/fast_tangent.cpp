@@ -0,0 +1,56 @@
+/*
+Measures the time per step of the tangent space of `NCoupledHenon(8)` along trajectories in `mpfr::mpreal`, evolved
+in arbitrary precision (`observable::EscapeWithVector`, `observable::Lyapunov`) and in double precision
+(`observable::EscapeWithFastVector`, `observable::FastLyapunov`), for precisions of 64 to 1024 bits.
+*/
+#include <chrono>
+
+#include "observable.h"
+#include "proposal.h"
+
+
+//! returns the time in nanoseconds of one step, averaged over the `points`.
+template <typename Observable>
+double time_step(Observable & observable, std::vector<Vector> const& points, double steps) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < points.size(); i++)
+        observable.observe(points[i]);
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count()/points.size()/steps;
+}
+
+
+int main() {
+    unsigned int N = 200;
+    unsigned int tobs = 20;
+
+    for (unsigned int precision = 64; precision <= 1024; precision *= 2) {
+        mpfr::mpreal::set_default_prec(precision);
+        map::NCoupledHenon map(8);
+        std::vector<Vector> points(N);
+        for (unsigned int i = 0; i < N; i++)
+            points[i] = proposal::proposeUniform(map.boundary);
+
+        // the escape times are short: the time per step of the vectors uses the total number of steps.
+        observable::EscapeWithVector escape(map);
+        observable::EscapeWithFastVector fast_escape(map);
+        unsigned int steps = 0;
+        for (unsigned int i = 0; i < N; i++) {
+            escape.observe(points[i]);
+            steps += escape.escape_time;
+        }
+        double vector_time = time_step(escape, points, steps*1./N);
+        double fast_vector_time = time_step(fast_escape, points, steps*1./N);
+
+        observable::Lyapunov lyapunov(map, tobs);
+        observable::FastLyapunov fast_lyapunov(map, tobs);
+        double matrix_time = time_step(lyapunov, points, tobs);
+        double fast_matrix_time = time_step(fast_lyapunov, points, tobs);
+
+        std::cout << format("%4d bits: vector %8.0f ns (mpreal) %8.0f ns (double) speedup %5.2f; "
+                            "matrix %8.0f ns (mpreal) %8.0f ns (double) speedup %5.2f",
+                            precision, vector_time, fast_vector_time, vector_time/fast_vector_time,
+                            matrix_time, fast_matrix_time, matrix_time/fast_matrix_time) << std::endl;
+    }
+    return 0;
+}
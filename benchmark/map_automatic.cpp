@@ -0,0 +1,128 @@
+/*
+Measures the time of one step of the state and of a tangent vector of the standard map and of `NCoupledHenon(8)`
+written only with their evolution (`map::generic::Automatic`), compared with the evolution alone (`Map::T`) and with
+the hand-written derivatives of `map.h` (`Map::step`), in double precision and with `mpfr::mpreal` of 128 bits.
+*/
+#include <chrono>
+
+#include "map.h"
+#include "proposal.h"
+
+
+template <typename Float>
+class AutomaticStandard : public map::generic::Automatic<AutomaticStandard<Float>, Float> {
+    Float k;
+    std::vector<std::pair<Float, Float> > bounding_box;
+public:
+    AutomaticStandard(Float k) : map::generic::Automatic<AutomaticStandard<Float>, Float>(2, "sm"),
+                                 k(k/(2*aux::Scalar<Float>::pi())), bounding_box(2, std::make_pair(Float(0), Float(1))) {
+        this->boundary = bounding_box;
+    }
+
+    template <typename Scalar>
+    void evolve(Eigen::Matrix<Scalar, Eigen::Dynamic, 1> & point) const {
+        using std::sin;
+        Float const& pi = aux::Scalar<Float>::pi();
+        point[0] += k*sin(2*pi*point[1]);
+        point[1] += point[0];
+        this->apply_boundary_conditions(point, bounding_box);
+    }
+
+    bool has_exited(Eigen::Matrix<Float, Eigen::Dynamic, 1> const& point) const {
+        return point[1] < 0.1;
+    }
+};
+
+
+template <typename Float>
+class AutomaticHenon : public map::generic::Automatic<AutomaticHenon<Float>, Float> {
+    std::vector<Float> a;
+    Float b, k;
+public:
+    AutomaticHenon(unsigned int D) : map::generic::Automatic<AutomaticHenon<Float>, Float>(D, "ch"), a(D/2),
+                                     b(aux::from_string<Float>("0.3")), k(aux::from_string<Float>("0.4")) {
+        for (unsigned int i = 0; i < D/2; i++)
+            a[i] = 3 + Float(2)*i/(D/2 - 1);
+        for (unsigned int i = 0; i < D; i++)
+            this->boundary[i] = std::make_pair(Float(-4), Float(4));
+    }
+
+    template <typename Scalar>
+    void evolve(Eigen::Matrix<Scalar, Eigen::Dynamic, 1> & point) const {
+        unsigned int const D = this->D;
+        Scalar x0 = point[0];
+        for (unsigned int i = 0; i < D/2; i++) {
+            Scalar x = point[i];
+            Scalar u = i + 1 == D/2 ? x0 : point[i + 1];
+            point[i] = a[i] - x*x + b*point[i + D/2] + k*(x - u);
+            point[i + D/2] = x;
+        }
+    }
+
+    bool has_exited(Eigen::Matrix<Float, Eigen::Dynamic, 1> const& point) const {
+        for (unsigned int i = 0; i < this->D; i++)
+            if (point[i] < -4 or point[i] > 4)
+                return true;
+        return false;
+    }
+};
+
+
+enum Mode {STATE, TANGENT, JACOBIAN};
+
+//! returns the time in nanoseconds of one step, averaged over `steps` steps.
+template <typename Map>
+double time_step(Map & map, Mode mode, unsigned int steps) {
+    typename Map::Vector point = proposal::proposeUniform(map.boundary);
+    typename Map::Vector tangent = aux::unitaryVector<typename Map::Scalar>(map.D);
+    typename Map::Matrix jacobian(map.D, map.D);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned int t = 0; t < steps; t++) {
+        map.step(point, mode == STATE ? nullptr : &tangent, mode == JACOBIAN ? &jacobian : nullptr);
+        if (map.has_exited(point))
+            point = proposal::proposeUniform(map.boundary);
+        aux::normalize(tangent);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count()/steps;
+}
+
+
+template <typename Map, typename Automatic>
+void measure(std::string const& name, Map & map, Automatic & automatic, unsigned int steps) {
+    double state_time = time_step(map, STATE, steps);
+    std::cout << format("%-24s %8.0f ns (T)", name.c_str(), state_time) << std::endl;
+    Mode modes[] = {TANGENT, JACOBIAN};
+    std::string names[] = {"tangent", "jacobian"};
+    for (unsigned int m = 0; m < 2; m++) {
+        double manual_time = time_step(map, modes[m], steps);
+        double automatic_time = time_step(automatic, modes[m], steps);
+        std::cout << format("%-24s %8.0f ns (derivatives) %8.0f ns (automatic) %5.2f T", names[m].c_str(),
+                            manual_time, automatic_time, automatic_time/state_time) << std::endl;
+    }
+}
+
+
+int main() {
+    unsigned int steps = 100000;
+    mpfr::mpreal::set_default_prec(128);
+
+    map::generic::Standard<double> standard(6);
+    AutomaticStandard<double> automatic_standard(6);
+    measure("Standard double", standard, automatic_standard, steps);
+
+    map::Standard mp_standard(6);
+    AutomaticStandard<mpfr::mpreal> mp_automatic_standard(6);
+    measure("Standard mpreal", mp_standard, mp_automatic_standard, steps);
+
+    map::generic::NCoupledHenon<double> henon(8);
+    AutomaticHenon<double> automatic_henon(8);
+    measure("NCoupledHenon(8) double", henon, automatic_henon, steps);
+
+    map::NCoupledHenon mp_henon(8);
+    AutomaticHenon<mpfr::mpreal> mp_automatic_henon(8);
+    measure("NCoupledHenon(8) mpreal", mp_henon, mp_automatic_henon, steps/10);
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+/*
+Measures the time of the evolution of a tangent vector of `NCoupledHenon(D)` for D = 2...64, with the dense jacobian
+(`tangent = map.jacobian(point)*tangent`) and with the jacobian-vector product (`map.jvp(point, tangent)`), in double
+precision and with `mpfr::mpreal` of 128 bits.
+*/
+#include <chrono>
+
+#include "map.h"
+#include "proposal.h"
+
+
+//! returns the time in nanoseconds of one product, averaged over the `points`.
+template <typename Map>
+double time_product(Map & map, std::vector<typename Map::Vector> const& points, bool dense) {
+    typedef typename Map::Vector Vector;
+    Vector tangent = aux::unitaryVector<typename Map::Scalar>(map.D);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < points.size(); i++) {
+        if (dense)
+            tangent = map.jacobian(points[i])*tangent;
+        else
+            map.jvp(points[i], tangent);
+        aux::normalize(tangent);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count()/points.size();
+}
+
+
+template <typename Float>
+void measure(std::string const& name, unsigned int D, unsigned int N) {
+    map::generic::NCoupledHenon<Float> map(D);
+    std::vector<typename map::generic::NCoupledHenon<Float>::Vector> points(N);
+    for (unsigned int i = 0; i < N; i++)
+        points[i] = proposal::proposeUniform(map.boundary);
+
+    double dense_time = time_product(map, points, true);
+    double jvp_time = time_product(map, points, false);
+    std::cout << format("%-8s D = %2d: %10.0f ns (jacobian) %8.0f ns (jvp) speedup %.2f",
+                        name.c_str(), D, dense_time, jvp_time, dense_time/jvp_time) << std::endl;
+}
+
+
+int main() {
+    mpfr::mpreal::set_default_prec(128);
+
+    for (unsigned int D = 2; D <= 64; D *= 2)
+        measure<double>("double", D, 100000);
+    for (unsigned int D = 2; D <= 64; D *= 2)
+        measure<mpfr::mpreal>("mpreal", D, 10000/D);
+
+    return 0;
+}
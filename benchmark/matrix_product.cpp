@@ -0,0 +1,67 @@
+/*
+Measures the time per step of the jacobian of the trajectories of `NCoupledHenon(D)` for D = 2...64
+(`observable::generic::EscapeWithMatrix::evolve`), with the sparse product of the jacobians of the steps (`Map::sparsity`) and with the
+dense one, in double precision and with `mpfr::mpreal` of 128 bits.
+*/
+#include <chrono>
+
+#include "observable.h"
+#include "proposal.h"
+
+
+//! `NCoupledHenon` without the declaration of its sparsity: `ComputeMatrix` multiplies dense matrices.
+template <typename Float>
+class DenseHenon : public map::generic::NCoupledHenon<Float> {
+public:
+    DenseHenon(unsigned int D) : map::generic::NCoupledHenon<Float>(D) {}
+
+    typename map::generic::NCoupledHenon<Float>::Pattern sparsity() const {
+        return typename map::generic::NCoupledHenon<Float>::Pattern();
+    }
+};
+
+
+//! returns the time in nanoseconds of one step, averaged over `steps` steps from each of the `points`.
+template <typename Map>
+double time_step(Map & map, std::vector<typename Map::Vector> const& points, unsigned int steps) {
+    typedef typename Map::Scalar Float;
+    observable::generic::EscapeWithMatrix<Float> observable(map);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < points.size(); i++) {
+        typename Map::Vector point = points[i];
+        for (unsigned int t = 0; t < steps; t++)
+            observable.evolve(point);
+        observable.jacobian /= observable.jacobian.norm();  // so that it never overflows.
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count()/points.size()/steps;
+}
+
+
+template <typename Float>
+void measure(std::string const& name, unsigned int D, unsigned int N) {
+    unsigned int steps = 4;
+    map::generic::NCoupledHenon<Float> sparse_map(D);
+    DenseHenon<Float> dense_map(D);
+    std::vector<typename map::generic::NCoupledHenon<Float>::Vector> points(N);
+    for (unsigned int i = 0; i < N; i++)
+        points[i] = proposal::proposeUniform(sparse_map.boundary);
+
+    double dense_time = time_step(dense_map, points, steps);
+    double sparse_time = time_step(sparse_map, points, steps);
+    std::cout << format("%-8s D = %2d: %10.0f ns (dense) %10.0f ns (sparse) speedup %.2f",
+                        name.c_str(), D, dense_time, sparse_time, dense_time/sparse_time) << std::endl;
+}
+
+
+int main() {
+    mpfr::mpreal::set_default_prec(128);
+
+    for (unsigned int D = 2; D <= 64; D *= 2)
+        measure<double>("double", D, 10000/D);
+    for (unsigned int D = 2; D <= 64; D *= 2)
+        measure<mpfr::mpreal>("mpreal", D, 1000/D);
+
+    return 0;
+}
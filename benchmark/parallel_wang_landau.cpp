@@ -0,0 +1,50 @@
+/*
+Measures the scaling of `ParallelWangLandau` with the number of threads, from 1 to 64 walkers, on the escape time of
+`OpenTent(3, 5)` and of `NCoupledHenon(8)` in `mpfr::mpreal`: the time of a fixed number of Markov steps of all the
+walkers together (strong scaling), its speedup over one walker and the parallel efficiency. The speedup is bounded by
+the cores of the machine (`std::thread::hardware_concurrency`).
+*/
+#include <chrono>
+
+#include "map.h"
+#include "sampler.h"
+
+
+//! returns the time in seconds of `stages` stages of `samples` steps with `walkers` walkers.
+template <typename Map>
+double time_sampling(Map const& map, unsigned int max_time, unsigned int walkers, unsigned int stages,
+                     unsigned int samples) {
+    typedef proposal::PowerLawIsotropic<observable::EscapeTime> Proposal;
+    observable::EscapeTime observable(map, max_time);
+    Proposal proposal(map.boundary, -1, 20);
+    SamplingHistogram<observable::EscapeTime> histogram(0, max_time, max_time);
+    ParallelWangLandau<observable::EscapeTime, Proposal> mc(observable, proposal, histogram, walkers, 1);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    mc.sample(stages, samples);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+
+template <typename Map>
+void scaling(std::string name, Map const& map, unsigned int max_time, unsigned int stages, unsigned int samples) {
+    double serial = 0;
+    for (unsigned int walkers = 1; walkers <= 64; walkers *= 2) {
+        double time = time_sampling(map, max_time, walkers, stages, samples);
+        if (walkers == 1)
+            serial = time;
+        std::cout << format("%s, %2d threads: %7.3f s, %8.2f us/step, speedup %5.2f, efficiency %4.2f", name.c_str(),
+                            walkers, time, time*1e6/(stages*samples), serial/time, serial/time/walkers) << std::endl;
+    }
+}
+
+
+int main() {
+    mpfr::mpreal::set_default_prec(128);
+    std::cout << format("%d cores", std::thread::hardware_concurrency()) << std::endl;
+
+    scaling("OpenTent(3, 5)", map::OpenTent(3, 5), 10, 4, 50000);
+    scaling("NCoupledHenon(8)", map::NCoupledHenon(8), 20, 4, 5000);
+    return 0;
+}
@@ -0,0 +1,72 @@
+/*
+Measures the time of one uniform and one normal variate of `mpfr::mpreal` drawn from an `aux::Stream` (Philox4x32-10)
+and from the global GMP state of `mpfr::random` and `mpfr::grandom`, for precisions of 64, 128, 256 and 512 bits, and
+of the `double` variates of a stream. It also measures a random direction of dimension 16 and 64 (`aux::unitaryVector`,
+drawn in `double` and converted), against one drawn from normal variates of `mpfr::mpreal` normalized in `mpfr::mpreal`.
+*/
+#include <chrono>
+
+#include "auxiliar.h"
+#include "io.h"
+
+
+//! returns the time in nanoseconds of one call of `draw`, averaged over `samples` calls.
+template <typename Draw>
+double time_draw(Draw draw, unsigned int samples) {
+    double sum = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < samples; i++)
+        sum += aux::to_double(draw());
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    if (sum == 0.123)  // so that the draws are not optimized away.
+        std::cout << sum;
+    return elapsed.count()/samples;
+}
+
+
+//! a direction drawn in the precision of `Float`.
+template <typename Float>
+void unitary_vector_of_precision(Eigen::Matrix<Float, Eigen::Dynamic, 1> & vector, aux::Stream & stream) {
+    Float norm = 0;
+    for (unsigned int d = 0; d < vector.size(); d++) {
+        vector[d] = aux::nrandom<Float>(stream);
+        norm += vector[d]*vector[d];
+    }
+    norm = sqrt(norm);
+    for (unsigned int d = 0; d < vector.size(); d++)
+        vector[d] /= norm;
+}
+
+
+int main() {
+    unsigned int samples = 200000;
+    aux::Stream stream(1);
+
+    std::cout << format("double: uniform %6.2f ns normal %6.2f ns",
+                        time_draw([&]() {return stream.uniform();}, samples),
+                        time_draw([&]() {return stream.normal();}, samples)) << std::endl;
+
+    for (unsigned int precision = 64; precision <= 512; precision *= 2) {
+        mpfr::mpreal::set_default_prec(precision);
+        double uniform = time_draw([&]() {return aux::urandom<mpfr::mpreal>(stream);}, samples);
+        double mpfr_uniform = time_draw([]() {return mpfr::random();}, samples);
+        double normal = time_draw([&]() {return aux::nrandom<mpfr::mpreal>(stream);}, samples);
+        double mpfr_normal = time_draw([]() {return mpfr::grandom();}, samples);
+        std::cout << format("%3d bits: uniform %7.2f ns (mpfr::random %7.2f ns) normal %7.2f ns "
+                            "(mpfr::grandom %7.2f ns)", precision, uniform, mpfr_uniform, normal, mpfr_normal)
+                  << std::endl;
+    }
+
+    mpfr::mpreal::set_default_prec(128);
+    for (unsigned int D : {16, 64}) {
+        Eigen::VectorXd direction(D);
+        Vector mp_direction(D);
+        double fast = time_draw([&]() {aux::unitaryVector(direction, stream); return direction[0];}, samples/D);
+        double mp = time_draw([&]() {aux::unitaryVector(mp_direction, stream); return mp_direction[0];}, samples/D);
+        double precise = time_draw([&]() {unitary_vector_of_precision(mp_direction, stream); return mp_direction[0];},
+                                   samples/D);
+        std::cout << format("direction of D = %2d: double %8.2f ns, 128 bits %8.2f ns (normals of 128 bits %8.2f ns)",
+                            D, fast, mp, precise) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+/*
+Measures the round trips through the range of escape times of `WangLandau` and of `ReplicaExchangeWangLandau` on
+`OpenTent(3, 5)` in `mpfr::mpreal`, for maximum escape times from 16 to 64. Both first estimate the entropy
+(`stages` stages), and then make round trips with it from the first bin to the last and back: the serial chain as
+`sample/efficiency_chm.cpp`, and the replicas of the windows (of 16 bins, overlapping by 75%, with one walker each),
+through the windows, in a stage of a fixed number of steps. The round trip times are in steps of a chain and in
+seconds, with the walkers in one thread each (so the speedup in seconds is bounded by the cores of the machine,
+`std::thread::hardware_concurrency`). The smallest proposals are of exp(-2*max_time), so that the chains can move
+among the states of the longest escape times.
+*/
+#include <chrono>
+
+#include "map.h"
+#include "sampler.h"
+
+
+template <typename Map>
+void round_trips(std::string name, Map const& map, unsigned int max_time, unsigned int stages, unsigned int samples,
+                 unsigned int trips) {
+    typedef proposal::PowerLawIsotropic<observable::EscapeTime> Proposal;
+    observable::EscapeTime observable(map, max_time);
+    Proposal proposal(map.boundary, -1, 2*max_time);
+
+    // serial
+    SamplingHistogram<observable::EscapeTime> histogram(0, max_time, max_time);
+    WangLandau<observable::EscapeTime, Proposal> serial(observable, proposal, histogram, aux::Stream(1));
+    serial.sample(stages, samples*max_time);
+    observable::EscapeTime state(observable);
+    state.observe(proposal.proposeUniform(serial.stream));
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    unsigned long steps = 0;
+    for (unsigned int trip = 0; trip < trips; trip++) {
+        histogram.reset();
+        serial.round_trip(state);
+        steps += histogram.count();
+    }
+    std::chrono::duration<double> serial_time = std::chrono::steady_clock::now() - start;
+
+    // replica exchange, with windows of 16 bins: max_time - 1 = 16*(1 + (windows - 1)/4)
+    unsigned int windows = std::max(2u, (unsigned int) (4*((max_time - 1)/16. - 1) + 1));
+    SamplingHistogram<observable::EscapeTime> stitched(0, max_time, max_time);
+    ReplicaExchangeWangLandau<observable::EscapeTime, Proposal> mc(observable, proposal, stitched, windows, 0.75, 1, 1);
+    mc.flatness = 0.8;
+    mc.sample(stages, samples*16);
+    mc.flatness = 0;
+    start = std::chrono::steady_clock::now();
+    mc.sample(1, samples*64*trips);
+    std::chrono::duration<double> exchange_time = std::chrono::steady_clock::now() - start;
+
+    std::cout << format("%s, t < %2d: serial %9.0f steps/round trip (%7.3f s); replica exchange, %2d windows: "
+                        "%9.0f steps/round trip (%7.3f s, %lu round trips)", name.c_str(), max_time,
+                        steps/(double) trips, serial_time.count()/trips, windows, mc.round_trip_steps(),
+                        mc.round_trips() > 0 ? exchange_time.count()/mc.round_trips() : 0., mc.round_trips())
+              << std::endl;
+}
+
+
+int main() {
+    mpfr::mpreal::set_default_prec(256);
+    std::cout << format("%d cores", std::thread::hardware_concurrency()) << std::endl;
+
+    for (unsigned int max_time : {16, 32, 48, 64})
+        round_trips("OpenTent(3, 5)", map::OpenTent(3, 5), max_time, 8, 500, 4);
+    return 0;
+}
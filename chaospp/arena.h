@@ -0,0 +1,242 @@
+#ifndef chaospp_arena_h
+#define chaospp_arena_h
+
+/*
+ * An opt-in pool allocator for the limbs of GMP/MPFR numbers.
+ *
+ * Every `mpfr::mpreal` temporary allocates and frees its limbs with GMP's memory functions. `aux::Arena::enable()`
+ * installs memory functions (`mp_set_memory_functions`) that serve these allocations from thread-local pools of
+ * fixed-size blocks, carved from large chunks. Freed blocks are recycled, and when no block of the pool is in use at
+ * the end of a step (`aux::Arena::Step`, used in `MetropolisHastings::markov_step` and `EscapeTime::observe`),
+ * the pool is rewound.
+ *
+ * Blocks must be freed by the thread that allocated them. Allocations that are not from the pool (e.g. done before
+ * `enable()` or larger than `Arena::max_block`) are forwarded to the previous memory functions.
+ */
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+#include <gmp.h>
+#include <mpfr.h>
+
+
+namespace aux {
+
+class Arena {
+public:
+    //! the counters of the arena of a thread.
+    struct Counters {
+        unsigned long allocations;  // allocations served by the pool, i.e. that did not call the system allocator.
+        unsigned long system_allocations;  // allocations forwarded to the system allocator, including new chunks.
+        unsigned long frees;  // blocks returned to the pool.
+        unsigned long resets;  // number of times the pool was rewound.
+
+        Counters() : allocations(0), system_allocations(0), frees(0), resets(0) {}
+    };
+
+    static const size_t granularity = 16;  // bytes
+    static const size_t max_block = 1024;  // bytes; corresponds to ~8000 bits.
+    static const size_t chunk_size = 1 << 16;  // bytes
+
+private:
+    typedef void *(*allocate_function)(size_t);
+    typedef void *(*reallocate_function)(void *, size_t, size_t);
+    typedef void (*free_function)(void *, size_t);
+
+    static allocate_function & system_allocate() {static allocate_function f = nullptr; return f;}
+    static reallocate_function & system_reallocate() {static reallocate_function f = nullptr; return f;}
+    static free_function & system_free() {static free_function f = nullptr; return f;}
+
+    struct Block {
+        Block * next;
+    };
+
+    std::vector<char *> chunks;  // in order of allocation.
+    std::vector<char *> sorted_chunks;  // sorted by address, to find if a block belongs to the pool.
+    std::vector<Block *> free_blocks;  // free list per size class.
+    size_t current;  // index of the chunk being carved.
+    size_t offset;  // bytes used of the chunk being carved.
+    unsigned long live;  // number of blocks in use.
+    bool enabled;
+
+    Arena() : free_blocks(max_block/granularity, nullptr), current(0), offset(chunk_size), live(0), enabled(false) {}
+
+    ~Arena() {
+        for (unsigned int i = 0; i < chunks.size(); i++)
+            system_free()(chunks[i], chunk_size);
+    }
+
+    //! the arena of this thread, or nullptr. It is a trivial type so it can be used after the thread's destructors.
+    static Arena *& instance() {
+        static thread_local Arena * arena = nullptr;
+        return arena;
+    }
+
+    //! destroys the arena of the thread on its exit, unless it has blocks in use (they may be freed later).
+    struct Owner {
+        ~Owner() {
+            Arena * arena = instance();
+            if (arena != nullptr and arena->live == 0) {
+                delete arena;
+                instance() = nullptr;
+            }
+        }
+    };
+
+    static size_t size_class(size_t size) {
+        return (size + granularity - 1)/granularity - 1;
+    }
+
+    bool owns(void * ptr) const {
+        char * p = static_cast<char *>(ptr);
+        std::vector<char *>::const_iterator it = std::upper_bound(sorted_chunks.begin(), sorted_chunks.end(), p);
+        if (it == sorted_chunks.begin())
+            return false;
+        --it;
+        return p < *it + chunk_size;
+    }
+
+    void * allocate_block(size_t size) {
+        size_t c = size_class(size);
+        if (free_blocks[c] != nullptr) {
+            Block * block = free_blocks[c];
+            free_blocks[c] = block->next;
+            return block;
+        }
+
+        size_t bytes = (c + 1)*granularity;
+        if (offset + bytes > chunk_size) {
+            // use the next chunk, or allocate a new one
+            if (chunks.empty() or current + 1 == chunks.size()) {
+                char * chunk = static_cast<char *>(system_allocate()(chunk_size));
+                counters.system_allocations++;
+                chunks.push_back(chunk);
+                sorted_chunks.insert(std::upper_bound(sorted_chunks.begin(), sorted_chunks.end(), chunk), chunk);
+                current = chunks.size() - 1;
+            }
+            else
+                current++;
+            offset = 0;
+        }
+        void * block = chunks[current] + offset;
+        offset += bytes;
+        return block;
+    }
+
+    void free_block(void * ptr, size_t size) {
+        Block * block = static_cast<Block *>(ptr);
+        size_t c = size_class(size);
+        block->next = free_blocks[c];
+        free_blocks[c] = block;
+    }
+
+    static void * allocate(size_t size) {
+        Arena * arena = instance();
+        if (arena == nullptr or not arena->enabled or size > max_block) {
+            if (arena != nullptr)
+                arena->counters.system_allocations++;
+            return system_allocate()(size);
+        }
+        arena->counters.allocations++;
+        arena->live++;
+        return arena->allocate_block(size);
+    }
+
+    static void free(void * ptr, size_t size) {
+        Arena * arena = instance();
+        if (arena == nullptr or not arena->owns(ptr)) {
+            system_free()(ptr, size);
+            return;
+        }
+        arena->counters.frees++;
+        arena->live--;
+        arena->free_block(ptr, size);
+    }
+
+    static void * reallocate(void * ptr, size_t old_size, size_t new_size) {
+        Arena * arena = instance();
+        bool owned = arena != nullptr and arena->owns(ptr);
+        if (not owned and (arena == nullptr or not arena->enabled or new_size > max_block)) {
+            if (arena != nullptr)
+                arena->counters.system_allocations++;
+            return system_reallocate()(ptr, old_size, new_size);
+        }
+        if (owned and size_class(old_size) == size_class(new_size))
+            return ptr;
+
+        void * new_ptr = allocate(new_size);
+        memcpy(new_ptr, ptr, std::min(old_size, new_size));
+        free(ptr, old_size);
+        return new_ptr;
+    }
+
+    static void install() {
+        if (system_allocate() != nullptr)
+            return;
+        #if MPFR_VERSION_MAJOR >= 4
+        mpfr_mp_memory_cleanup();
+        #endif
+        mp_get_memory_functions(&system_allocate(), &system_reallocate(), &system_free());
+        mp_set_memory_functions(&Arena::allocate, &Arena::reallocate, &Arena::free);
+    }
+
+    //! rewinds the pool if no block is in use.
+    void reset() {
+        if (live != 0 or (current == 0 and offset == 0) or chunks.empty())
+            return;
+        std::fill(free_blocks.begin(), free_blocks.end(), nullptr);
+        current = 0;
+        offset = 0;
+        counters.resets++;
+    }
+
+public:
+    Counters counters;
+
+    //! the arena of this thread.
+    static Arena & local() {
+        static thread_local Owner owner;
+        if (instance() == nullptr)
+            instance() = new Arena();
+        (void) owner;
+        return *instance();
+    }
+
+    //! starts serving the GMP/MPFR allocations of this thread from the pool.
+    static void enable() {
+        install();
+        local().enabled = true;
+    }
+
+    //! stops serving new allocations of this thread from the pool; blocks in use are still returned to it.
+    static void disable() {
+        if (instance() != nullptr)
+            instance()->enabled = false;
+    }
+
+    static bool is_enabled() {
+        return instance() != nullptr and instance()->enabled;
+    }
+
+    //! number of blocks of the pool in use.
+    unsigned long in_use() const {
+        return live;
+    }
+
+    //! Marks a step (a Markov step or an observation): the pool of the thread is rewound when it ends
+    //! if no block is in use.
+    class Step {
+    public:
+        ~Step() {
+            Arena * arena = instance();
+            if (arena != nullptr and arena->enabled)
+                arena->reset();
+        }
+    };
+};
+
+}
+
+#endif
@@ -1,11 +1,19 @@
 #ifndef chaospp_auxiliar_h
 #define chaospp_auxiliar_h
 
+#include <algorithm> // for std::min
 #include <utility> // for std::pair
+#include <vector>
+#include <random>  // for the distributions of long double
+#include <cstdlib> // for strtod, strtold
+#include <math.h>
+#include <type_traits>
 
 #include <mpreal.h>
 #include <Eigen/Dense>
 
+#include "random.h"
+
 typedef mpfr::mpreal Float;
 using Matrix = Eigen::Matrix<Float, Eigen::Dynamic, Eigen::Dynamic>;
 using Vector = Eigen::Matrix<Float, Eigen::Dynamic, 1>;
@@ -14,47 +22,179 @@ using Vector = Eigen::Matrix<Float, Eigen::Dynamic, 1>;
 namespace aux {
     const Float pi = atan(Float(1))*4;
 
+    //! `std::is_final` of C++14, with the intrinsic of GCC, clang and MSVC.
+    template <typename T>
+    struct is_final : std::integral_constant<bool, __is_final(T)> {};
+
     typedef std::pair<Float, Float> pair;
 
-    inline Float urandom() {
-        return mpfr::random();
+    //! The scalar policy: everything the library needs from a floating point type that is not an arithmetic operator
+    //! or a math function. The library is templated on the scalar, which is chosen at compile time by using e.g.
+    //! `map::generic::Tent<double>` instead of `map::Tent` (that uses `mpfr::mpreal`).
+    //! The random variates are drawn from a `Stream`, with as many random bits as the mantissa of the scalar.
+    //! Specialize it to use other types (see `float128.h`).
+    template <typename T>
+    struct Scalar;
+
+    template <>
+    struct Scalar<mpfr::mpreal> {
+        static mpfr::mpreal from_string(const char* value) {return mpfr::mpreal(value);}
+        static double to_double(mpfr::mpreal const& value) {return value.toDouble();}
+        //! pi in the default precision, computed again when it changes (`aux::pi` has the precision at startup).
+        static mpfr::mpreal const& pi() {
+            static thread_local mpfr::mpreal value;
+            static thread_local mpfr_prec_t precision = 0;
+            if (precision != mpfr::mpreal::get_default_prec()) {
+                precision = mpfr::mpreal::get_default_prec();
+                value = mpfr::const_pi(precision);
+            }
+            return value;
+        }
+        //! the random bits of the default precision, `precision` bits written at once into the mantissa.
+        static mpfr::mpreal urandom(Stream & stream) {
+            return urandom(stream, mpfr::mpreal::get_default_prec());
+        }
+        static mpfr::mpreal urandom(Stream & stream, mpfr_prec_t precision) {
+            static thread_local std::vector<std::uint64_t> words;
+            static thread_local struct Integer {
+                mpz_t z;
+                Integer() {mpz_init(z);}
+                ~Integer() {mpz_clear(z);}
+            } integer;
+            size_t n = (size_t) (precision + 63)/64;
+            words.resize(n);
+            for (size_t i = 0; i < n; i++)
+                words[i] = stream();
+            words[n - 1] >>= 64*n - precision;
+            // an integer of `precision` bits times 2^-precision: exact.
+            mpz_import(integer.z, n, -1, sizeof(std::uint64_t), 0, 0, words.data());
+            mpfr::mpreal value(0, precision);
+            mpfr_set_z_2exp(value.mpfr_ptr(), integer.z, -precision, MPFR_RNDN);
+            return value;
+        }
+        //! the normal variate of `double` of `stream`, widened to the default precision with uniform random bits
+        //! below its 53 bits: the density is the normal one up to a relative error of 2^-53.
+        static mpfr::mpreal nrandom(Stream & stream) {
+            mpfr_prec_t precision = mpfr::mpreal::get_default_prec();
+            double normal = stream.normal();
+            mpfr::mpreal value(normal, precision);
+            if (precision > 53 and normal != 0) {
+                int exponent;
+                frexp(normal, &exponent);
+                // a uniform offset in [-1/2, 1/2) ulps of the double.
+                mpfr::mpreal offset = urandom(stream, precision - 53);
+                mpfr_sub_d(offset.mpfr_ptr(), offset.mpfr_srcptr(), 0.5, MPFR_RNDN);
+                mpfr_mul_2si(offset.mpfr_ptr(), offset.mpfr_srcptr(), exponent - 53, MPFR_RNDN);
+                mpfr_add(value.mpfr_ptr(), value.mpfr_srcptr(), offset.mpfr_srcptr(), MPFR_RNDN);
+            }
+            return value;
+        }
+        //! number of bits of the mantissa
+        static unsigned int digits() {return (unsigned int) mpfr::mpreal::get_default_prec();}
+    };
+
+    template <>
+    struct Scalar<double> {
+        static double from_string(const char* value) {return strtod(value, nullptr);}
+        static double to_double(double value) {return value;}
+        static double pi() {return 3.14159265358979323846264338327950288;}
+        static double urandom(Stream & stream) {return stream.uniform();}
+        static double nrandom(Stream & stream) {return stream.normal();}
+        static unsigned int digits() {return std::numeric_limits<double>::digits;}
+    };
+
+    template <>
+    struct Scalar<long double> {
+        static long double from_string(const char* value) {return strtold(value, nullptr);}
+        static double to_double(long double value) {return (double) value;}
+        static long double pi() {return 3.14159265358979323846264338327950288L;}
+        static long double urandom(Stream & stream) {return std::uniform_real_distribution<long double>()(stream);}
+        static long double nrandom(Stream & stream) {return std::normal_distribution<long double>()(stream);}
+        static unsigned int digits() {return std::numeric_limits<long double>::digits;}
+    };
+
+    template <typename T>
+    inline T from_string(const char* value) {
+        return Scalar<T>::from_string(value);
     }
 
-    inline Float nrandom() {
-        return mpfr::grandom();
+    template <typename T>
+    inline double to_double(T const& value) {
+        return Scalar<T>::to_double(value);
     }
 
-    Vector unitaryVector(unsigned int D) {
-        Vector vector(D);
-        Float norm = 0;
-        for (unsigned int d = 0; d < D; d++) {
-            vector[d] = nrandom();
-            norm += vector[d]*vector[d];
-        }
-        norm = sqrt(norm);
-        for (size_t d = 0; d < D; d++) {
-            vector[d] /= norm;
-        }
+    //! a uniform variate of [0, 1) drawn from `stream`.
+    template <typename T = Float>
+    inline T urandom(Stream & stream) {
+        return Scalar<T>::urandom(stream);
+    }
+
+    //! a standard normal variate drawn from `stream`.
+    template <typename T = Float>
+    inline T nrandom(Stream & stream) {
+        return Scalar<T>::nrandom(stream);
+    }
+
+    //! `urandom` from the stream of the calling thread.
+    template <typename T = Float>
+    inline T urandom() {
+        return Scalar<T>::urandom(Stream::local());
+    }
+
+    //! `nrandom` from the stream of the calling thread.
+    template <typename T = Float>
+    inline T nrandom() {
+        return Scalar<T>::nrandom(Stream::local());
+    }
+
+    //! sets `vector` to a random vector of the unit sphere of its dimension, without allocating it.
+    //! The direction is drawn in `double` (a block of normal variates of `stream` and their norm): the components are
+    //! converted to `T` once, so a direction of any precision costs about as much as one of `double`.
+    template <typename T, int Dim>
+    void unitaryVector(Eigen::Matrix<T, Dim, 1> & vector, Stream & stream) {
+        static thread_local std::vector<double> normals;
+        normals.resize(vector.size());
+        stream.normals(normals.data(), normals.size());
+        double norm = 0;
+        for (unsigned int d = 0; d < vector.size(); d++)
+            norm += normals[d]*normals[d];
+        norm = std::sqrt(norm);
+        for (unsigned int d = 0; d < vector.size(); d++)
+            vector[d] = T(normals[d]/norm);
+    }
+
+    template <typename T, int Dim>
+    void unitaryVector(Eigen::Matrix<T, Dim, 1> & vector) {
+        unitaryVector(vector, Stream::local());
+    }
+
+    template <typename T = Float, int Dim = Eigen::Dynamic>
+    Eigen::Matrix<T, Dim, 1> unitaryVector(unsigned int D) {
+        Eigen::Matrix<T, Dim, 1> vector(D);
+        unitaryVector(vector);
         return vector;
     }
 
-    inline Float get_norm(Vector const& vector)
+    template <typename Derived>
+    inline typename Derived::Scalar get_norm(Eigen::MatrixBase<Derived> const& vector)
     {
-        Float norm = 0;
+        typename Derived::Scalar norm = 0;
         for(unsigned int i = 0; i < vector.size(); i++)
             norm += vector[i]*vector[i];
         return sqrt(norm);
     }
 
-    inline void normalize(Vector & vector, Float const& norm)
+    template <typename Derived>
+    inline void normalize(Eigen::MatrixBase<Derived> & vector, typename Derived::Scalar const& norm)
     {
         for(unsigned int i = 0; i < vector.size(); i++)
             vector[i] /= norm;
     }
 
-    inline void normalize(Vector & vector)
+    template <typename Derived>
+    inline void normalize(Eigen::MatrixBase<Derived> & vector)
     {
-        Float norm = get_norm(vector);
+        typename Derived::Scalar norm = get_norm(vector);
         normalize(vector, norm);
     }
 }
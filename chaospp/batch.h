@@ -0,0 +1,522 @@
+#ifndef chaospp_batch_h
+#define chaospp_batch_h
+
+/*
+ * Evolution of many states at once in hardware precision (`double` or `float`), for uniform sampling and
+ * phase-space scans.
+ *
+ * A `map::batch::Block` stores N states (and optionally N tangent vectors) as a structure of arrays: coordinate `d`
+ * of the state `i` is `block.state(d)[i]`. The maps of this file (`map::batch::Tent`, `OpenTent`, `Logistic`,
+ * `Manneville`, `Standard` and `NCoupledHenon`) have the same parameters and compute the same operations as the ones
+ * of `map.h`, on packs of states using GCC/clang vector extensions. The width of the packs is chosen at runtime from
+ * the CPU: 64 bytes (AVX-512), 32 bytes (AVX2) or 16 bytes (SSE2 and others). Trigonometric functions and powers are
+ * evaluated per lane with the standard library.
+ *
+ *     map::batch::OpenTent<double> map(3, 5);
+ *     map::batch::Block<double> block(1, 1000);
+ *     ...  // block.set(i, point)
+ *     std::vector<unsigned int> times;
+ *     map::batch::escape_time(map, block, 100, times);
+ */
+
+#include <vector>
+#include <cassert>
+#include <cstring>
+#include <cmath>
+#include <type_traits>
+
+#include "auxiliar.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CHAOSPP_BATCH_X86
+#endif
+
+#define CHAOSPP_BATCH_INLINE inline __attribute__((always_inline))
+
+
+namespace map {
+
+namespace batch {
+
+//! The packs of states and the selection of their width.
+namespace simd {
+
+//! `Bytes/sizeof(Float)` lanes of `Float`, and the operations used by the kernels.
+template <typename Float, int Bytes>
+struct Pack {
+    typedef Float Vector __attribute__((vector_size(Bytes)));
+    typedef decltype(Vector() < Vector()) Mask;  // integers of the size of `Float`: -1 (true) or 0 (false).
+    static const int lanes = Bytes/sizeof(Float);
+
+    static CHAOSPP_BATCH_INLINE Vector load(Float const* p) {
+        Vector v;
+        memcpy(&v, p, Bytes);
+        return v;
+    }
+
+    static CHAOSPP_BATCH_INLINE void store(Float * p, Vector const& v) {
+        memcpy(p, &v, Bytes);
+    }
+
+    //! stores `v` in the lanes of `alive`, keeping the others.
+    static CHAOSPP_BATCH_INLINE void update(Float * p, Vector const& v, Mask const& alive) {
+        store(p, alive ? v : load(p));
+    }
+
+    static CHAOSPP_BATCH_INLINE Vector broadcast(Float x) {
+        return Vector{} + x;
+    }
+
+    static CHAOSPP_BATCH_INLINE Mask all() {
+        return Mask{} == Mask{};
+    }
+
+    static CHAOSPP_BATCH_INLINE bool any(Mask const& mask) {
+        bool result = false;
+        for (int l = 0; l < lanes; l++)
+            result |= mask[l] != 0;
+        return result;
+    }
+
+    //! x - floor(x), i.e. the boundary conditions of [0, 1].
+    static CHAOSPP_BATCH_INLINE Vector wrap_unit(Vector const& x) {
+        Vector f = __builtin_convertvector(__builtin_convertvector(x, Mask), Vector);
+        return x - (f > x ? f - 1 : f);
+    }
+
+    static CHAOSPP_BATCH_INLINE Vector sin(Vector const& x) {
+        Vector r;
+        for (int l = 0; l < lanes; l++)
+            r[l] = std::sin(x[l]);
+        return r;
+    }
+
+    static CHAOSPP_BATCH_INLINE Vector cos(Vector const& x) {
+        Vector r;
+        for (int l = 0; l < lanes; l++)
+            r[l] = std::cos(x[l]);
+        return r;
+    }
+
+    static CHAOSPP_BATCH_INLINE Vector pow(Vector const& x, Float y) {
+        Vector r;
+        for (int l = 0; l < lanes; l++)
+            r[l] = std::pow(x[l], y);
+        return r;
+    }
+};
+
+inline int detect_width() {
+    #ifdef CHAOSPP_BATCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return 64;
+    if (__builtin_cpu_supports("avx2"))
+        return 32;
+    #endif
+    return 16;
+}
+
+//! the width in bytes of the packs, detected from the CPU on first use. It can be lowered (e.g. to compare widths).
+inline int & width() {
+    static int bytes = detect_width();
+    return bytes;
+}
+
+//! the largest width supported by the CPU.
+inline int max_width() {
+    static const int bytes = detect_width();
+    return bytes;
+}
+
+template <int Bytes, typename Float, typename Loop>
+CHAOSPP_BATCH_INLINE void packs(Loop & loop, size_t size) {
+    typedef Pack<Float, Bytes> P;
+    for (size_t i = 0; i < size; i += P::lanes)
+        loop.template apply<P>(i);
+}
+
+#ifdef CHAOSPP_BATCH_X86
+// AVX-512 has fused multiply-adds: contraction is disabled so that all widths round as the scalar maps.
+template <typename Float, typename Loop>
+__attribute__((target("avx512f"), optimize("fp-contract=off"))) void packs_avx512(Loop & loop, size_t size) {
+    packs<64, Float>(loop, size);
+}
+
+template <typename Float, typename Loop>
+__attribute__((target("avx2"))) void packs_avx2(Loop & loop, size_t size) {
+    packs<32, Float>(loop, size);
+}
+#endif
+
+template <typename Float, typename Loop>
+void packs_default(Loop & loop, size_t size) {
+    packs<16, Float>(loop, size);
+}
+
+//! calls `loop.apply<Pack>(i)` for the first lane `i` of every pack of `size` lanes, with the selected width.
+template <typename Float, typename Loop>
+void for_each_pack(Loop & loop, size_t size) {
+    #ifdef CHAOSPP_BATCH_X86
+    if (width() >= 64)
+        return packs_avx512<Float>(loop, size);
+    if (width() >= 32)
+        return packs_avx2<Float>(loop, size);
+    #endif
+    packs_default<Float>(loop, size);
+}
+
+} // simd
+
+
+//! N states of dimension D, and optionally their tangent vectors, as a structure of arrays.
+//! The arrays are aligned and padded to a multiple of the widest pack; the padding lanes are evolved but ignored.
+template <typename Float>
+class Block {
+    static_assert(std::is_same<Float, double>::value or std::is_same<Float, float>::value,
+                  "batches are evolved in double or float");
+public:
+    typedef Eigen::Matrix<Float, Eigen::Dynamic, 1> Vector;
+    static const size_t alignment = 64;  // bytes
+
+    const unsigned int D;
+private:
+    size_t _size;
+    size_t _capacity;  // lanes of each array
+    bool _has_tangent;
+    std::vector<Float> storage;
+    Float * data;
+public:
+    Block(unsigned int D, size_t size, bool has_tangent=false) : D(D), _size(size), _has_tangent(has_tangent) {
+        size_t lanes = alignment/sizeof(Float);
+        _capacity = (size + lanes - 1)/lanes*lanes;
+        storage.resize((has_tangent ? 2 : 1)*D*_capacity + lanes, 0);
+        size_t misalignment = reinterpret_cast<size_t>(storage.data()) % alignment;
+        data = storage.data() + (misalignment ? (alignment - misalignment)/sizeof(Float) : 0);
+    }
+
+    Block(Block const&) = delete;
+    Block & operator=(Block const&) = delete;
+
+    size_t size() const {return _size;}
+    size_t capacity() const {return _capacity;}
+    bool has_tangent() const {return _has_tangent;}
+
+    Float * state(unsigned int d) {return data + d*_capacity;}
+    Float const* state(unsigned int d) const {return data + d*_capacity;}
+    Float * tangent(unsigned int d) {return data + (D + d)*_capacity;}
+    Float const* tangent(unsigned int d) const {return data + (D + d)*_capacity;}
+
+    void set(size_t i, Vector const& point) {
+        for (unsigned int d = 0; d < D; d++)
+            state(d)[i] = point[d];
+    }
+
+    Vector get(size_t i) const {
+        Vector point(D);
+        for (unsigned int d = 0; d < D; d++)
+            point[d] = state(d)[i];
+        return point;
+    }
+
+    void set_tangent(size_t i, Vector const& vector) {
+        for (unsigned int d = 0; d < D; d++)
+            tangent(d)[i] = vector[d];
+    }
+
+    Vector get_tangent(size_t i) const {
+        Vector vector(D);
+        for (unsigned int d = 0; d < D; d++)
+            vector[d] = tangent(d)[i];
+        return vector;
+    }
+};
+
+
+/*
+ * The maps. Each implements, for the pack of states starting at lane `i`,
+ *  - `T<Pack>(block, i, alive)`: one step of the states (and tangents, if the block has them) in the lanes `alive`;
+ *  - `exited<Pack>(block, i)`: the lanes whose state has left the restraining region (as `has_exited` in `map.h`).
+ */
+
+template <typename Float>
+class Tent {
+    Float a, threshold, slope, minus_slope;
+public:
+    static const unsigned int D = 1;
+
+    Tent(Float a) : a(a), threshold(1/a), slope(a/(a - 1)), minus_slope(-slope) {}
+
+    template <typename P>
+    CHAOSPP_BATCH_INLINE void T(Block<Float> & block, size_t i, typename P::Mask const& alive) const {
+        typename P::Vector x = P::load(block.state(0) + i);
+        typename P::Mask left = x < P::broadcast(threshold);
+        if (block.has_tangent())
+            P::update(block.tangent(0) + i, P::load(block.tangent(0) + i)*(left ? P::broadcast(a) : P::broadcast(minus_slope)), alive);
+        P::update(block.state(0) + i, left ? x*a : slope*(1 - x), alive);
+    }
+
+    template <typename P>
+    CHAOSPP_BATCH_INLINE typename P::Mask exited(Block<Float> const& block, size_t i) const {
+        return P::load(block.state(0) + i) < P::broadcast(Float(0.4));
+    }
+};
+
+
+template <typename Float>
+class OpenTent {
+    Float a, b, threshold;
+public:
+    static const unsigned int D = 1;
+
+    OpenTent(Float a, Float b) : a(a), b(b), threshold(b/(a + b)) {}
+
+    template <typename P>
+    CHAOSPP_BATCH_INLINE void T(Block<Float> & block, size_t i, typename P::Mask const& alive) const {
+        typename P::Vector x = P::load(block.state(0) + i);
+        typename P::Mask left = x < P::broadcast(threshold);
+        if (block.has_tangent())
+            P::update(block.tangent(0) + i, P::load(block.tangent(0) + i)*(left ? P::broadcast(a) : P::broadcast(b)), alive);
+        P::update(block.state(0) + i, left ? x*a : b*(1 - x), alive);
+    }
+
+    template <typename P>
+    CHAOSPP_BATCH_INLINE typename P::Mask exited(Block<Float> const& block, size_t i) const {
+        typename P::Vector x = P::load(block.state(0) + i);
+        return ~((P::broadcast(0) < x) & (x < P::broadcast(1)));
+    }
+};
+
+
+template <typename Float>
+class Logistic {
+    Float r;
+public:
+    static const unsigned int D = 1;
+
+    Logistic(Float r) : r(r) {}
+
+    template <typename P>
+    CHAOSPP_BATCH_INLINE void T(Block<Float> & block, size_t i, typename P::Mask const& alive) const {
+        typename P::Vector x = P::load(block.state(0) + i);
+        if (block.has_tangent())
+            P::update(block.tangent(0) + i, P::load(block.tangent(0) + i)*(r*(1 - 2*x)), alive);
+        P::update(block.state(0) + i, r*(1 - x)*x, alive);
+    }
+
+    template <typename P>
+    CHAOSPP_BATCH_INLINE typename P::Mask exited(Block<Float> const& block, size_t i) const {
+        typename P::Vector x = P::load(block.state(0) + i);
+        return (P::broadcast(0) < x) & (x < P::broadcast(Float(0.2)));
+    }
+};
+
+
+template <typename Float>
+class Manneville {
+    Float z, z_minus_1;
+public:
+    static const unsigned int D = 1;
+
+    Manneville(Float z = 2) : z(z), z_minus_1(z - 1) {}
+
+    template <typename P>
+    CHAOSPP_BATCH_INLINE void T(Block<Float> & block, size_t i, typename P::Mask const& alive) const {
+        typename P::Vector x = P::load(block.state(0) + i);
+        // x^(z - 1) is shared by T and the jacobian, as in `map::generic::Manneville::step`.
+        typename P::Vector power = P::pow(x, z_minus_1);
+        if (block.has_tangent())
+            P::update(block.tangent(0) + i, P::load(block.tangent(0) + i)*(1 + power*z), alive);
+        x = x*power + x;
+        P::update(block.state(0) + i, x > P::broadcast(1) ? x - 1 : x, alive);
+    }
+
+    template <typename P>
+    CHAOSPP_BATCH_INLINE typename P::Mask exited(Block<Float> const& block, size_t i) const {
+        return P::load(block.state(0) + i) > P::broadcast(Float(0.8));
+    }
+};
+
+
+template <typename Float>
+class Standard {
+    Float k;  // k/(2*pi)
+    Float two_pi;
+    Float jacobian_factor;  // k*2*pi
+public:
+    static const unsigned int D = 2;
+
+    Standard(Float k) : k(k/(2*Float(aux::Scalar<double>::pi()))), two_pi(2*Float(aux::Scalar<double>::pi())),
+                        jacobian_factor(this->k*2*Float(aux::Scalar<double>::pi())) {}
+
+    template <typename P>
+    CHAOSPP_BATCH_INLINE void T(Block<Float> & block, size_t i, typename P::Mask const& alive) const {
+        typedef typename P::Vector Vector;
+        Vector p = P::load(block.state(0) + i);
+        Vector q = P::load(block.state(1) + i);
+        Vector angle = two_pi*q;
+        if (block.has_tangent()) {
+            Vector j = jacobian_factor*P::cos(angle);
+            Vector t0 = P::load(block.tangent(0) + i);
+            Vector t1 = P::load(block.tangent(1) + i);
+            P::update(block.tangent(0) + i, t0 + j*t1, alive);
+            P::update(block.tangent(1) + i, t0 + (1 + j)*t1, alive);
+        }
+        p += k*P::sin(angle);
+        q += p;
+        P::update(block.state(0) + i, P::wrap_unit(p), alive);
+        P::update(block.state(1) + i, P::wrap_unit(q), alive);
+    }
+
+    template <typename P>
+    CHAOSPP_BATCH_INLINE typename P::Mask exited(Block<Float> const& block, size_t i) const {
+        return P::load(block.state(1) + i) < P::broadcast(Float(0.1));
+    }
+};
+
+
+template <typename Float>
+class NCoupledHenon {
+    std::vector<Float> a;
+    Float b;
+    Float k;
+public:
+    const unsigned int D;
+
+    NCoupledHenon(unsigned int D, Float min_a=3, Float max_a=5, Float b=Float(0.3), Float k=Float(0.4)) :
+            a(D/2), b(b), k(k), D(D) {
+        assert(D % 2 == 0);
+        // as in `map::generic::NCoupledHenon`
+        a[0] = min_a;
+        a[D/2 - 1] = max_a;
+        for (unsigned int i = 1; i < D/2 - 1; i++)
+            a[i] = min_a + (max_a - min_a)*i/(D/2 - 1);
+    }
+
+    template <typename P>
+    CHAOSPP_BATCH_INLINE void T(Block<Float> & block, size_t i, typename P::Mask const& alive) const {
+        typedef typename P::Vector Vector;
+        unsigned int const half = D/2;
+        Vector x0 = P::load(block.state(0) + i);
+        Vector t0 = block.has_tangent() ? P::load(block.tangent(0) + i) : Vector{};
+
+        for (unsigned int j = 0; j < half; j++) {
+            unsigned int jplus1 = (j + 1)%half;
+            Vector x = P::load(block.state(j) + i);
+            Vector y = P::load(block.state(j + half) + i);
+            // avoid retrieving already modified values
+            Vector u = jplus1 == 0 ? x0 : P::load(block.state(jplus1) + i);
+
+            if (block.has_tangent()) {
+                Vector t = P::load(block.tangent(j) + i);
+                Vector v = jplus1 == 0 ? t0 : P::load(block.tangent(jplus1) + i);
+                Vector tangent = -2*x*t + b*P::load(block.tangent(j + half) + i);
+                if (D > 2)
+                    tangent += k*t - k*v;
+                P::update(block.tangent(j) + i, tangent, alive);
+                P::update(block.tangent(j + half) + i, t, alive);
+            }
+
+            Vector point = a[j] - x*x + b*y;
+            if (D > 2)
+                point += k*(x - u);
+            P::update(block.state(j) + i, point, alive);
+            P::update(block.state(j + half) + i, x, alive);
+        }
+    }
+
+    template <typename P>
+    CHAOSPP_BATCH_INLINE typename P::Mask exited(Block<Float> const& block, size_t i) const {
+        typename P::Mask result{};
+        for (unsigned int d = 0; d < D; d++) {
+            typename P::Vector x = P::load(block.state(d) + i);
+            result |= (x < P::broadcast(-4)) | (x > P::broadcast(4));
+        }
+        return result;
+    }
+};
+
+
+namespace loop {
+
+template <typename Map, typename Float>
+struct Step {
+    Map const& map;
+    Block<Float> & block;
+
+    template <typename P>
+    CHAOSPP_BATCH_INLINE void apply(size_t i) {
+        map.template T<P>(block, i, P::all());
+    }
+};
+
+template <typename Map, typename Float>
+struct Exited {
+    Map const& map;
+    Block<Float> const& block;
+    unsigned char * exited;
+
+    template <typename P>
+    CHAOSPP_BATCH_INLINE void apply(size_t i) {
+        typename P::Mask mask = map.template exited<P>(block, i);
+        for (int l = 0; l < P::lanes and i + l < block.size(); l++)
+            exited[i + l] = mask[l] != 0;
+    }
+};
+
+template <typename Map, typename Float>
+struct EscapeTime {
+    Map const& map;
+    Block<Float> & block;
+    unsigned int max_time;
+    unsigned int * times;
+
+    template <typename P>
+    CHAOSPP_BATCH_INLINE void apply(size_t i) {
+        typename P::Mask alive = P::all();
+        typename P::Mask time{};
+        for (unsigned int t = 0; t < max_time and P::any(alive); t++) {
+            time -= alive;  // +1 in the lanes alive
+            map.template T<P>(block, i, alive);
+            alive &= ~map.template exited<P>(block, i);
+        }
+        for (int l = 0; l < P::lanes and i + l < block.size(); l++)
+            times[i + l] = (unsigned int) time[l];
+    }
+};
+
+} // loop
+
+
+//! evolves every state of `block` (and its tangent vector, if the block has them) one step.
+template <typename Map, typename Float>
+void T(Map const& map, Block<Float> & block) {
+    assert(block.D == map.D);
+    loop::Step<Map, Float> loop = {map, block};
+    simd::for_each_pack<Float>(loop, block.size());
+}
+
+//! sets `exited[i]` to whether the state `i` has left the restraining region.
+template <typename Map, typename Float>
+void has_exited(Map const& map, Block<Float> const& block, std::vector<unsigned char> & exited) {
+    assert(block.D == map.D);
+    exited.resize(block.size());
+    loop::Exited<Map, Float> loop = {map, block, exited.data()};
+    simd::for_each_pack<Float>(loop, block.size());
+}
+
+//! the escape time of every state of `block`, up to `max_time` (as `observable::EscapeTime`). Each state (and tangent
+//! vector) is evolved until it exits, so the block ends with the states at their escape.
+template <typename Map, typename Float>
+void escape_time(Map const& map, Block<Float> & block, unsigned int max_time, std::vector<unsigned int> & times) {
+    assert(block.D == map.D);
+    times.resize(block.size());
+    loop::EscapeTime<Map, Float> loop = {map, block, max_time, times.data()};
+    simd::for_each_pack<Float>(loop, block.size());
+}
+
+} // batch
+
+} // map
+
+#endif
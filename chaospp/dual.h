@@ -0,0 +1,290 @@
+#ifndef chaospp_dual_h
+#define chaospp_dual_h
+
+/*
+ * Forward-mode automatic differentiation. `aux::Dual<Float, N>` is the number `value + sum_i derivative[i] e_i`, with
+ * e_i e_j = 0: its arithmetic and math functions apply the chain rule to the N derivatives along with the value. A
+ * function templated on its scalar, evaluated on duals seeded with N directions, gives its value and its derivatives
+ * along them in one pass (see `map::generic::Automatic`).
+ *
+ * With N = Eigen::Dynamic the number of directions is set at runtime and the derivatives are allocated on the heap;
+ * the constants then have no derivatives (an empty vector). The comparisons only use the values, so the branches of
+ * the function (e.g. boundary conditions) follow the values, and the derivatives are the ones of the branch taken.
+ * The math functions are found by argument dependent lookup.
+ */
+
+#include <ostream>
+#include <cmath>
+#include <type_traits>
+
+#include "auxiliar.h"
+
+namespace aux {
+
+template <typename Float, int N = 1>
+class Dual {
+    //! the types that convert to a dual with zero derivatives.
+    template <typename T>
+    struct constant : std::integral_constant<bool, std::is_arithmetic<T>::value or std::is_same<T, Float>::value> {};
+
+public:
+    typedef Eigen::Matrix<Float, N, 1, Eigen::DontAlign> Derivative;
+
+    Float value;
+    Derivative derivative;
+
+    Dual() : value(0), derivative(zero()) {}
+
+    Dual(Float const& value) : value(value), derivative(zero()) {}
+
+    template <typename T>
+    Dual(T const& value, typename std::enable_if<std::is_arithmetic<T>::value>::type* = 0) :
+            value(value), derivative(zero()) {}
+
+    template <typename Derived>
+    Dual(Float const& value, Eigen::MatrixBase<Derived> const& derivative) : value(value), derivative(derivative) {}
+
+    //! the variable `value` of the i-th of `n` directions.
+    static Dual variable(Float const& value, unsigned int i, unsigned int n = N) {
+        return Dual(value, Derivative::Unit(n, i));
+    }
+
+    Dual & operator+=(Dual const& other) {
+        value += other.value;
+        if (derivative.size() == other.derivative.size())
+            derivative += other.derivative;
+        else
+            add(derivative, 1, other.derivative);
+        return *this;
+    }
+
+    Dual & operator-=(Dual const& other) {
+        value -= other.value;
+        if (derivative.size() == other.derivative.size())
+            derivative -= other.derivative;
+        else
+            add(derivative, -1, other.derivative);
+        return *this;
+    }
+
+    Dual & operator*=(Dual const& other) {
+        if (this == &other)
+            return *this *= Dual(other);
+        derivative *= other.value;
+        add(derivative, value, other.derivative);
+        value *= other.value;
+        return *this;
+    }
+
+    Dual & operator/=(Dual const& other) {
+        if (this == &other)
+            return *this /= Dual(other);
+        value /= other.value;
+        add(derivative, -value, other.derivative);
+        derivative /= other.value;
+        return *this;
+    }
+
+    Dual operator-() const {
+        return Dual(-value, -derivative);
+    }
+
+    Dual operator+() const {
+        return *this;
+    }
+
+    friend Dual operator+(Dual a, Dual const& b) {return a += b;}
+    friend Dual operator-(Dual a, Dual const& b) {return a -= b;}
+    friend Dual operator*(Dual a, Dual const& b) {return a *= b;}
+    friend Dual operator/(Dual a, Dual const& b) {return a /= b;}
+
+    // with a constant (a `Float` or a number), whose derivatives are zero.
+    template <typename T>
+    friend typename std::enable_if<Dual::template constant<T>::value, Dual>::type operator+(Dual a, T const& c) {
+        a.value += c;
+        return a;
+    }
+    template <typename T>
+    friend typename std::enable_if<Dual::template constant<T>::value, Dual>::type operator+(T const& c, Dual a) {
+        a.value += c;
+        return a;
+    }
+    template <typename T>
+    friend typename std::enable_if<Dual::template constant<T>::value, Dual>::type operator-(Dual a, T const& c) {
+        a.value -= c;
+        return a;
+    }
+    template <typename T>
+    friend typename std::enable_if<Dual::template constant<T>::value, Dual>::type operator-(T const& c, Dual const& a) {
+        return Dual(c - a.value, -a.derivative);
+    }
+    template <typename T>
+    friend typename std::enable_if<Dual::template constant<T>::value, Dual>::type operator*(Dual a, T const& c) {
+        Float const& constant = as_float(c);
+        a.value *= constant;
+        a.derivative *= constant;
+        return a;
+    }
+    template <typename T>
+    friend typename std::enable_if<Dual::template constant<T>::value, Dual>::type operator*(T const& c, Dual a) {
+        return a*c;
+    }
+    template <typename T>
+    friend typename std::enable_if<Dual::template constant<T>::value, Dual>::type operator/(Dual a, T const& c) {
+        Float const& constant = as_float(c);
+        a.value /= constant;
+        a.derivative /= constant;
+        return a;
+    }
+    template <typename T>
+    friend typename std::enable_if<Dual::template constant<T>::value, Dual>::type operator/(T const& c, Dual const& a) {
+        Float quotient = c/a.value;
+        return Dual(quotient, a.derivative*(-quotient/a.value));
+    }
+
+    template <typename T>
+    typename std::enable_if<constant<T>::value, Dual &>::type operator+=(T const& c) {
+        value += c;
+        return *this;
+    }
+    template <typename T>
+    typename std::enable_if<constant<T>::value, Dual &>::type operator-=(T const& c) {
+        value -= c;
+        return *this;
+    }
+    template <typename T>
+    typename std::enable_if<constant<T>::value, Dual &>::type operator*=(T const& c) {
+        return *this = *this*c;
+    }
+    template <typename T>
+    typename std::enable_if<constant<T>::value, Dual &>::type operator/=(T const& c) {
+        return *this = *this/c;
+    }
+
+    // the chain rule (see `chain`)
+    friend Dual sin(Dual const& x) {using std::sin; using std::cos; return x.chain(sin(x.value), cos(x.value));}
+    friend Dual cos(Dual const& x) {using std::sin; using std::cos; return x.chain(cos(x.value), -sin(x.value));}
+    friend Dual tan(Dual const& x) {
+        using std::tan;
+        Float t = tan(x.value);
+        return x.chain(t, 1 + t*t);
+    }
+    friend Dual atan(Dual const& x) {using std::atan; return x.chain(atan(x.value), 1/(1 + x.value*x.value));}
+    friend Dual sinh(Dual const& x) {using std::sinh; using std::cosh; return x.chain(sinh(x.value), cosh(x.value));}
+    friend Dual cosh(Dual const& x) {using std::sinh; using std::cosh; return x.chain(cosh(x.value), sinh(x.value));}
+    friend Dual tanh(Dual const& x) {
+        using std::tanh;
+        Float t = tanh(x.value);
+        return x.chain(t, 1 - t*t);
+    }
+    friend Dual exp(Dual const& x) {
+        using std::exp;
+        Float e = exp(x.value);
+        return x.chain(e, e);
+    }
+    friend Dual log(Dual const& x) {using std::log; return x.chain(log(x.value), 1/x.value);}
+    friend Dual sqrt(Dual const& x) {
+        using std::sqrt;
+        Float s = sqrt(x.value);
+        return x.chain(s, 1/(2*s));
+    }
+    friend Dual abs(Dual const& x) {return x.value < 0 ? -x : x;}
+    friend Dual fabs(Dual const& x) {return abs(x);}
+    // piecewise constant
+    friend Dual floor(Dual const& x) {using std::floor; return Dual(floor(x.value));}
+    friend Dual ceil(Dual const& x) {using std::ceil; return Dual(ceil(x.value));}
+
+    template <typename T>
+    friend typename std::enable_if<Dual::template constant<T>::value, Dual>::type pow(Dual const& x, T const& y) {
+        using std::pow;
+        Float exponent(y);
+        Float power = pow(x.value, exponent - 1);
+        return x.chain(power*x.value, exponent*power);
+    }
+    friend Dual pow(Dual const& x, Dual const& y) {
+        return exp(y*log(x));
+    }
+
+    friend std::ostream & operator<<(std::ostream & os, Dual const& x) {
+        return os << x.value;
+    }
+
+private:
+    static Derivative zero() {
+        if (N == Eigen::Dynamic)
+            return Derivative();
+        return Derivative::Zero(N == Eigen::Dynamic ? 0 : N);
+    }
+
+    //! x += a*y, where an empty derivative (of a constant, with N = Eigen::Dynamic) is zero.
+    template <typename T>
+    static void add(Derivative & x, T const& a, Derivative const& y) {
+        if (y.size() == 0)
+            return;
+        if (x.size() == 0)
+            x = y*as_float(a);
+        else
+            x += y*as_float(a);
+    }
+
+    static Float const& as_float(Float const& x) {
+        return x;
+    }
+
+    template <typename T>
+    static Float as_float(T const& x) {
+        return Float(x);
+    }
+
+    //! f(x), from f(x) = `result` and f'(x) = `slope`.
+    Dual chain(Float const& result, Float const& slope) const {
+        return Dual(result, derivative*slope);
+    }
+};
+
+template <typename T>
+struct is_dual : std::false_type {};
+
+template <typename Float, int N>
+struct is_dual<Dual<Float, N> > : std::true_type {};
+
+template <typename Float, int N>
+inline Float const& dual_value(Dual<Float, N> const& x) {return x.value;}
+
+template <typename T>
+inline T const& dual_value(T const& x) {return x;}
+
+// the comparisons of the values.
+template <typename A, typename B>
+inline typename std::enable_if<is_dual<A>::value or is_dual<B>::value, bool>::type operator==(A const& a, B const& b) {
+    return dual_value(a) == dual_value(b);
+}
+
+template <typename A, typename B>
+inline typename std::enable_if<is_dual<A>::value or is_dual<B>::value, bool>::type operator!=(A const& a, B const& b) {
+    return dual_value(a) != dual_value(b);
+}
+
+template <typename A, typename B>
+inline typename std::enable_if<is_dual<A>::value or is_dual<B>::value, bool>::type operator<(A const& a, B const& b) {
+    return dual_value(a) < dual_value(b);
+}
+
+template <typename A, typename B>
+inline typename std::enable_if<is_dual<A>::value or is_dual<B>::value, bool>::type operator<=(A const& a, B const& b) {
+    return dual_value(a) <= dual_value(b);
+}
+
+template <typename A, typename B>
+inline typename std::enable_if<is_dual<A>::value or is_dual<B>::value, bool>::type operator>(A const& a, B const& b) {
+    return dual_value(a) > dual_value(b);
+}
+
+template <typename A, typename B>
+inline typename std::enable_if<is_dual<A>::value or is_dual<B>::value, bool>::type operator>=(A const& a, B const& b) {
+    return dual_value(a) >= dual_value(b);
+}
+
+}
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef chaospp_float128_h
+#define chaospp_float128_h
+
+/*
+ * Quadruple precision (113 bits) scalar for the templated library, e.g. `map::generic::Tent<aux::float128>`.
+ * It wraps gcc's `__float128` so that the math functions are found by argument dependent lookup
+ * (also inside Eigen and std::complex). Requires gcc and linking against `quadmath`.
+ */
+
+#include <ostream>
+#include <limits>
+#include <quadmath.h>
+
+#include "auxiliar.h"
+
+namespace aux {
+
+class float128 {
+    __float128 value;
+public:
+    float128() : value(0) {}
+    float128(__float128 value) : value(value) {}
+    float128(double value) : value(value) {}
+    float128(long double value) : value(value) {}
+    float128(int value) : value(value) {}
+    float128(unsigned int value) : value(value) {}
+    float128(long value) : value(value) {}
+    float128(unsigned long value) : value(value) {}
+    float128(const char* value) : value(strtoflt128(value, nullptr)) {}
+
+    __float128 const& raw() const {return value;}
+
+    explicit operator double() const {return (double) value;}
+    explicit operator long double() const {return (long double) value;}
+    explicit operator int() const {return (int) value;}
+    explicit operator unsigned int() const {return (unsigned int) value;}
+    explicit operator long() const {return (long) value;}
+
+    float128 & operator+=(float128 const& other) {value += other.value; return *this;}
+    float128 & operator-=(float128 const& other) {value -= other.value; return *this;}
+    float128 & operator*=(float128 const& other) {value *= other.value; return *this;}
+    float128 & operator/=(float128 const& other) {value /= other.value; return *this;}
+    float128 operator-() const {return -value;}
+    float128 operator+() const {return value;}
+
+    friend float128 operator+(float128 const& a, float128 const& b) {return a.value + b.value;}
+    friend float128 operator-(float128 const& a, float128 const& b) {return a.value - b.value;}
+    friend float128 operator*(float128 const& a, float128 const& b) {return a.value * b.value;}
+    friend float128 operator/(float128 const& a, float128 const& b) {return a.value / b.value;}
+
+    friend bool operator==(float128 const& a, float128 const& b) {return a.value == b.value;}
+    friend bool operator!=(float128 const& a, float128 const& b) {return a.value != b.value;}
+    friend bool operator<(float128 const& a, float128 const& b) {return a.value < b.value;}
+    friend bool operator>(float128 const& a, float128 const& b) {return a.value > b.value;}
+    friend bool operator<=(float128 const& a, float128 const& b) {return a.value <= b.value;}
+    friend bool operator>=(float128 const& a, float128 const& b) {return a.value >= b.value;}
+
+    friend float128 sin(float128 const& x) {return sinq(x.value);}
+    friend float128 cos(float128 const& x) {return cosq(x.value);}
+    friend float128 tan(float128 const& x) {return tanq(x.value);}
+    friend float128 atan(float128 const& x) {return atanq(x.value);}
+    friend float128 atan2(float128 const& y, float128 const& x) {return atan2q(y.value, x.value);}
+    friend float128 sqrt(float128 const& x) {return sqrtq(x.value);}
+    friend float128 log(float128 const& x) {return logq(x.value);}
+    friend float128 log2(float128 const& x) {return log2q(x.value);}
+    friend float128 log10(float128 const& x) {return log10q(x.value);}
+    friend float128 exp(float128 const& x) {return expq(x.value);}
+    friend float128 pow(float128 const& x, float128 const& y) {return powq(x.value, y.value);}
+    friend float128 abs(float128 const& x) {return fabsq(x.value);}
+    friend float128 fabs(float128 const& x) {return fabsq(x.value);}
+    friend float128 floor(float128 const& x) {return floorq(x.value);}
+    friend float128 ceil(float128 const& x) {return ceilq(x.value);}
+    friend float128 hypot(float128 const& x, float128 const& y) {return hypotq(x.value, y.value);}
+    friend bool isnan(float128 const& x) {return isnanq(x.value);}
+    friend bool isinf(float128 const& x) {return isinfq(x.value);}
+    friend bool isfinite(float128 const& x) {return finiteq(x.value);}
+
+    friend std::ostream & operator<<(std::ostream & os, float128 const& x) {
+        char buffer[64];
+        quadmath_snprintf(buffer, sizeof(buffer), "%.*Qg", (int) os.precision(), x.value);
+        return os << buffer;
+    }
+};
+
+
+template <>
+struct Scalar<float128> {
+    static float128 from_string(const char* value) {return float128(value);}
+    static double to_double(float128 const& value) {return (double) value;}
+    static float128 const& pi() {
+        static const float128 pi = 4*atan(float128(1));
+        return pi;
+    }
+    //! uses 2 doubles to fill the 113 bits of the mantissa.
+    static float128 urandom(Stream & stream) {
+        return (float128(stream.uniform()) + ldexpq(stream.uniform(), -53))/(1 + ldexpq(1, -53));
+    }
+    static float128 nrandom(Stream & stream) {
+        // Box-Muller transform
+        float128 u1 = 1 - urandom(stream);
+        float128 u2 = urandom(stream);
+        return sqrt(-2*log(u1))*cos(2*pi()*u2);
+    }
+    static unsigned int digits() {return 113;}
+};
+
+}
+
+
+namespace std {
+
+template <>
+class numeric_limits<aux::float128> {
+public:
+    static const bool is_specialized = true;
+    static const bool is_signed = true;
+    static const bool is_integer = false;
+    static const bool is_exact = false;
+    static const bool has_infinity = true;
+    static const bool has_quiet_NaN = true;
+    static const bool is_iec559 = true;
+    static const bool is_bounded = true;
+    static const int radix = 2;
+    static const int digits = 113;
+    static const int digits10 = 33;
+    static const int max_digits10 = 36;
+    static const int min_exponent = -16381;
+    static const int max_exponent = 16384;
+
+    static aux::float128 min() {return ldexpq(1, -16382);}
+    static aux::float128 max() {return ldexpq(2 - ldexpq(1, -112), 16383);}
+    static aux::float128 lowest() {return -max();}
+    static aux::float128 epsilon() {return ldexpq(1, -112);}
+    static aux::float128 round_error() {return 0.5;}
+    static aux::float128 infinity() {return __builtin_huge_valq();}
+    static aux::float128 quiet_NaN() {return nanq("");}
+    static aux::float128 denorm_min() {return ldexpq(1, -16494);}
+};
+
+}
+
+#endif
@@ -5,6 +5,7 @@
 #include <assert.h>
 #include <string>
 #include <math.h>
+#include <type_traits>
 
 #include "io.h"
 
@@ -46,6 +47,11 @@ public:
         return v(value) <= _lowerBound || v(value) >= _upperBound;
     }
 
+    //! the smallest value above the range: the values from it on are invalid (see `invalid_value`).
+    T upper_bound() const {
+        return iv(_upperBound);
+    }
+
     T get_invalid_value() const {
         return iv(_lowerBound) - 1;
     }
@@ -75,6 +81,15 @@ public:
         return iv(_lowerBound + (_upperBound - _lowerBound)*bin/_bins);
     }
 
+    //! the smallest value of `bin`: `value` rounds it down with integer values.
+    T first_value(unsigned int bin) const {
+        T first = value(bin);
+        if (std::is_integral<T>::value)
+            while (this->bin(first) < bin)
+                first++;
+        return first;
+    }
+
     virtual void reset() {
         for (unsigned int bin = 0; bin <= _bins; bin++)
             _histogram[bin] = 0;
@@ -86,6 +101,14 @@ public:
         _count++;
     }
 
+    //! adds the samples of `other`, a histogram with the same bins (e.g. of another chain).
+    virtual void merge(Histogram const& other) {
+        assert(other._bins == _bins);
+        for (unsigned int bin = 0; bin <= _bins; bin++)
+            _histogram[bin] += other._histogram[bin];
+        _count += other._count;
+    }
+
     void print() const {
         unsigned int sum = 0;
         for (unsigned int bin = 0; bin <= _bins; bin++) {
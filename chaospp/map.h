@@ -1,26 +1,144 @@
 #ifndef __chaospp__map__
 #define __chaospp__map__
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <vector>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include "auxiliar.h"
+#include "dual.h"
 #include "io.h"
 
 
 namespace map {
 
+//! In-place MPFR operations used by the maps in arbitrary precision. Expressions of `mpfr::mpreal` create a
+//! temporary (and round) on every operation; the maps instead write into preallocated registers and use fused
+//! operations (e.g. `mpfr_fma`), so the results can differ from the expressions in the last bits.
+//! The precisions are the ones of the expressions: a register, or a coordinate of the state that the expression
+//! assigns (e.g. `x = b*(1 - x)`), takes the maximum of the precisions of its operands (`scratch`, `widen`), and a
+//! coordinate that it updates in place (e.g. `p += k*sin(2*pi*q)`) keeps its own, as the compound assignments of
+//! `mpfr::mpreal`.
+namespace kernel {
+
+typedef mpfr::mpreal mpreal;
+
+//! whether the maps use the MPFR kernels for the scalar `Float`.
+template <typename Float>
+struct fused : std::is_same<Float, mpreal> {};
+
+inline mpfr_ptr ptr(mpreal & x) {return x.mpfr_ptr();}
+inline mpfr_srcptr src(mpreal const& x) {return x.mpfr_srcptr();}
+
+inline mpfr_prec_t precision(mpreal const& x) {
+    return mpfr_get_prec(x.mpfr_srcptr());
+}
+
+template <typename... Args>
+inline mpfr_prec_t precision(mpreal const& x, Args const&... args) {
+    return std::max(precision(x), precision(args...));
+}
+
+//! prepares the register `r` with precision `prec`. Its value is lost.
+inline mpfr_ptr scratch(mpreal & r, mpfr_prec_t prec) {
+    if (precision(r) != prec)
+        mpfr_set_prec(r.mpfr_ptr(), prec);
+    return r.mpfr_ptr();
+}
+
+//! increases the precision of `x` to `prec` (if lower), keeping its value.
+inline mpfr_ptr widen(mpreal & x, mpfr_prec_t prec) {
+    if (precision(x) < prec)
+        mpfr_prec_round(x.mpfr_ptr(), prec, MPFR_RNDN);
+    return x.mpfr_ptr();
+}
+
+//! r = 2*pi*x
+inline void angle(mpfr_ptr r, mpfr_srcptr x, mpreal const& pi) {
+    mpfr_mul(r, pi.mpfr_srcptr(), x, MPFR_RNDN);
+    mpfr_mul_2ui(r, r, 1, MPFR_RNDN);
+}
+
+//! if x is an integer that fits in an unsigned long, returns it; otherwise returns 0.
+inline unsigned long integer(mpreal const& x) {
+    if (mpfr_integer_p(x.mpfr_srcptr()) and mpfr_sgn(x.mpfr_srcptr()) > 0 and mpfr_fits_ulong_p(x.mpfr_srcptr(), MPFR_RNDN))
+        return mpfr_get_ui(x.mpfr_srcptr(), MPFR_RNDN);
+    return 0;
+}
+
+template <typename Float>
+inline unsigned long integer(Float const&) {
+    return 0;
+}
+
+//! the boundary conditions of [0, 1] of `Map::apply_boundary_conditions`, using `mpfr_frac`: as its loops, the
+//! values above 1 are wrapped to (0, 1] (an integer to 1), and the negative ones to [+0, 1) (an integer to +0).
+inline void wrap_unit(mpreal & x) {
+    mpfr_ptr p = x.mpfr_ptr();
+    if (mpfr_cmp_ui(p, 1) > 0) {
+        mpfr_frac(p, p, MPFR_RNDN);
+        if (mpfr_zero_p(p))
+            mpfr_set_ui(p, 1, MPFR_RNDN);
+    }
+    else if (mpfr_sgn(p) < 0) {
+        mpfr_frac(p, p, MPFR_RNDN);
+        if (mpfr_zero_p(p))
+            mpfr_set_zero(p, 1);
+        else
+            mpfr_add_ui(p, p, 1, MPFR_RNDN);
+    }
+}
+
+}
+
+
+//! The maps templated on the scalar type `Float` (e.g. `double`, `long double` or `mpfr::mpreal`).
+//! The arbitrary precision versions are available directly in `map`, e.g. `map::Standard`.
+namespace generic {
 
 //! A general class of a map.
+//! `Dim` is the dimension of the map at compile time (default: only known at runtime). A fixed dimension
+//! (e.g. `map::generic::Standard<double, 2>`) makes states and jacobians fixed-size Eigen types, which are not
+//! allocated on the heap.
+//! A map is an immutable set of parameters: its evaluations are `const` and write their intermediate results (e.g.
+//! the jacobian they return) into a `Workspace`, so one map can be shared by the observables of several threads, each
+//! with its own workspaces.
+template <typename Float, int Dim = Eigen::Dynamic>
 class Map {
 public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef Float Scalar;
+    static const int Dimension = Dim;
+    typedef Eigen::Matrix<Float, Dim, Dim> Matrix;
+    typedef Eigen::Matrix<Float, Dim, 1> Vector;
+    typedef std::pair<Float, Float> pair;
+    typedef std::vector<std::pair<unsigned int, unsigned int> > Pattern;
+
+    //! The scratch storage of the evaluations: the jacobian returned by `jacobian` (valid until the next evaluation
+    //! with the workspace) and the registers of the MPFR kernels. It avoids repeating allocations, and is used by one
+    //! thread at a time. Created by `new_workspace`, for the maps of the same type and dimension.
+    struct Workspace {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        Matrix jacobian;
+        Float registers[7];
+        Map const* structure;  // the map whose constant entries of `jacobian` are set (see `NCoupledHenon`).
+
+        Workspace(unsigned int D) : jacobian(D, D), structure(nullptr) {}
+        virtual ~Workspace() {}
+    };
+
     const unsigned int D;
     std::string name;
-    std::vector<aux::pair> boundary;
-protected:
-    Matrix _jacobian;  // stores the jacobian to avoid repeating allocations.
+    std::vector<pair> boundary;
 
-public:
-    //! returns the point inside the boundary conditions
-    static void apply_boundary_conditions(Vector &point, std::vector<aux::pair> const& bounding_box) {
+    //! returns the point inside the boundary conditions (also a point of duals, see `Automatic`)
+    template <typename Point>
+    static void apply_boundary_conditions(Point &point, std::vector<pair> const& bounding_box) {
         for(unsigned int i = 0; i < point.size(); i++) {
             while(point[i] > bounding_box[i].second)
                 point[i] -= bounding_box[i].second - bounding_box[i].first;
@@ -29,118 +147,643 @@ public:
         }
     }
 
-    Map(unsigned int D, std::string name) : D(D), _jacobian(D,D), name(name), boundary(D) {}
+    Map(unsigned int D, std::string name) : D(D), name(name), boundary(D), id(new_id()) {
+        assert(Dim == Eigen::Dynamic or Dim == (int) D);
+    }
+
+    Map(Map const& other) : D(other.D), name(other.name), boundary(other.boundary), id(new_id()) {}
+
+    //! the workspaces of the map in the other threads are deleted when these threads look up a new map (see
+    //! `local_workspace`) or end.
+    virtual ~Map() {
+        {
+            std::lock_guard<std::mutex> lock(live_mutex());
+            live_ids().erase(id);
+        }
+        if (Workspaces * workspaces = thread_workspaces())
+            workspaces->erase(id);
+    }
+
+    //! a new workspace for the evaluations of the map.
+    virtual Workspace * new_workspace() const {
+        return new Workspace(D);
+    }
 
     //! one time evolution of the map
-    virtual void T(Vector & point) = 0;
+    virtual void T(Vector & point, Workspace & w) const = 0;
+
+    //! the jacobian matrix of the map at a given point, stored in `w`.
+    virtual Matrix const& jacobian(Vector const& point, Workspace & w) const = 0;
+
+    //! the jacobian-vector product: `tangent` is multiplied by the jacobian at `point`.
+    //! The built-in maps compute it without filling the jacobian (O(D) instead of O(D^2) for the coupled maps).
+    virtual void jvp(Vector const& point, Vector & tangent, Workspace & w) const {
+        tangent = jacobian(point, w)*tangent;
+    }
+
+    //! one time evolution of the map and of its tangent space: `tangent` (if not null) is multiplied by the
+    //! jacobian at `point`, `jac` (if not null) is set to it, and `point` is evolved.
+    //! Without `jac`, the tangent is evolved with `jvp`. When `jac` is the jacobian of `w`, the jacobian is left there
+    //! without a copy.
+    //! Maps override it to share computations (e.g. trigonometric functions) between the jacobian and `T`, as
+    //! `Standard`, `CoupledStandard` and `Manneville`: a subclass of these maps that overrides `T`, `jacobian` or
+    //! `jvp` also overrides `step`.
+    virtual void step(Vector & point, Vector * tangent, Matrix * jac, Workspace & w) const {
+        if (jac != nullptr)
+            evolve_tangent(jacobian(point, w), tangent, jac);
+        else if (tangent != nullptr)
+            jvp(point, *tangent, w);
+        T(point, w);
+    }
+
+    //! test if point has left the restraining region.
+    //! optional method in case you don't want to even use escape time
+    virtual bool has_exited(Vector const& point) const {return true;}
+
+    //! the entries (row, column) of the jacobian that can be non-zero, or empty (the default) if it is dense.
+    //! `ComputeMatrix` uses it to multiply by the jacobian of each step in O(D*entries) instead of O(D^3).
+    virtual Pattern sparsity() const {return Pattern();}
+
+    //! The evaluations with the workspace of the map in the calling thread (`local_workspace`).
+    void T(Vector & point) const {
+        T(point, local_workspace());
+    }
+
+    Matrix const& jacobian(Vector const& point) const {
+        return jacobian(point, local_workspace());
+    }
+
+    void jvp(Vector const& point, Vector & tangent) const {
+        jvp(point, tangent, local_workspace());
+    }
+
+    void step(Vector & point, Vector * tangent, Matrix * jac) const {
+        step(point, tangent, jac, local_workspace());
+    }
 
     //! one time evolution of the map on the tangent space
-    inline void dT(Vector const& point, Vector & vector) {
-        vector = jacobian(point)*vector;
+    inline void dT(Vector const& point, Vector & vector) const {
+        jvp(point, vector);
     }
 
     //! one time evolution of the map on the tangent space
-    inline void dTmatrix(Vector const& point, Matrix & matrix) {
+    inline void dTmatrix(Vector const& point, Matrix & matrix) const {
         matrix = jacobian(point)*matrix;
     }
 
-    //! the jacobian matrix of the map at a given point.
-    virtual Matrix const& jacobian(Vector const& point) = 0;
+    //! the workspace of the map in the calling thread, created on the first call in each thread.
+    //! The observables own their workspaces instead (`OwnedWorkspace`), which avoids the lookup.
+    Workspace & local_workspace() const {
+        static thread_local ThreadWorkspaces thread;
+        Workspaces & workspaces = *thread_workspaces();
+        typename Workspaces::iterator found = workspaces.find(id);
+        if (found != workspaces.end())
+            return *found->second;
 
-    //! test if point has left the restraining region.
-    //! optional method in case you don't want to even use escape time
-    virtual bool has_exited(Vector const& point) {return true;}
+        if (workspaces.size() >= thread.next_prune)
+            thread.prune();
+        std::unique_ptr<Workspace> & workspace = workspaces[id];
+        workspace.reset(new_workspace());
+        return *workspace;
+    }
+
+    //! the number of workspaces of the maps in the calling thread (see `local_workspace`).
+    static std::size_t local_workspaces() {
+        Workspaces * workspaces = thread_workspaces();
+        return workspaces == nullptr ? 0 : workspaces->size();
+    }
+
+protected:
+    static void evolve_tangent(Matrix const& jacobian, Vector * tangent, Matrix * jac) {
+        if (tangent != nullptr)
+            *tangent = jacobian*(*tangent);
+        if (jac != nullptr and jac != &jacobian)
+            *jac = jacobian;
+    }
+
+    //! `step` from the `jacobian`, `jvp` and `T` of the final map `map`, called without virtual dispatch (see `Final`).
+    template <typename M>
+    static void compose(M const& map, Vector & point, Vector * tangent, Matrix * jac, Workspace & w) {
+        static_assert(aux::is_final<M>::value, "the calls of a map that is not final bypass the overrides");
+        if (jac != nullptr)
+            evolve_tangent(map.M::jacobian(point, w), tangent, jac);
+        else if (tangent != nullptr)
+            map.M::jvp(point, *tangent, w);
+        map.M::T(point, w);
+    }
+
+private:
+    typedef std::unordered_map<unsigned long, std::unique_ptr<Workspace> > Workspaces;
+
+    unsigned long id;  // the key of the workspaces of the map in each thread (never reused).
+
+    //! the ids of the maps that exist, to delete the workspaces of the other ones (see `ThreadWorkspaces::prune`).
+    static std::unordered_set<unsigned long> & live_ids() {
+        static std::unordered_set<unsigned long> ids;
+        return ids;
+    }
+
+    static std::mutex & live_mutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static unsigned long new_id() {
+        static std::atomic<unsigned long> next(0);
+        unsigned long id = next++;
+        std::lock_guard<std::mutex> lock(live_mutex());
+        live_ids().insert(id);
+        return id;
+    }
+
+    //! the workspaces of the maps in the calling thread; null before the first `local_workspace` and after the
+    //! thread ended (e.g. for the maps of static storage, destroyed after it).
+    static Workspaces *& thread_workspaces() {
+        static thread_local Workspaces * workspaces = nullptr;
+        return workspaces;
+    }
+
+    //! owns the workspaces of a thread, deleted when it ends.
+    struct ThreadWorkspaces {
+        std::size_t next_prune;  // the number of workspaces from which a new one first deletes the ones of dead maps.
+
+        ThreadWorkspaces() : next_prune(16) {
+            thread_workspaces() = new Workspaces();
+        }
+
+        ~ThreadWorkspaces() {
+            delete thread_workspaces();
+            thread_workspaces() = nullptr;
+        }
+
+        //! deletes the workspaces of the maps destroyed (in any thread). The next prune is when their number doubled:
+        //! it costs O(1) amortized per new workspace, and the thread keeps at most twice (or 16) the workspaces
+        //! of the live maps at the last prune.
+        void prune() {
+            Workspaces & workspaces = *thread_workspaces();
+            {
+                std::lock_guard<std::mutex> lock(live_mutex());
+                std::unordered_set<unsigned long> const& live = live_ids();
+                for (typename Workspaces::iterator it = workspaces.begin(); it != workspaces.end();) {
+                    if (live.count(it->first) == 0)
+                        it = workspaces.erase(it);
+                    else
+                        ++it;
+                }
+            }
+            next_prune = std::max<std::size_t>(16, 2*workspaces.size());
+        }
+    };
+};
+
+
+//! The workspace of one user of a map (e.g. an observable), created by the map. A copy has its own workspace, so
+//! the copies of an observable (e.g. the proposals of a Markov chain) can be evaluated in different threads; the
+//! assignment keeps the workspace.
+template <typename Float, int Dim = Eigen::Dynamic>
+class OwnedWorkspace {
+public:
+    typedef typename Map<Float, Dim>::Workspace Workspace;
+private:
+    Map<Float, Dim> const& map;
+    std::unique_ptr<Workspace> workspace;
+public:
+    explicit OwnedWorkspace(Map<Float, Dim> const& map) : map(map), workspace(map.new_workspace()) {}
+
+    OwnedWorkspace(OwnedWorkspace const& other) : map(other.map), workspace(other.map.new_workspace()) {}
+
+    OwnedWorkspace & operator=(OwnedWorkspace const&) {
+        return *this;
+    }
+
+    operator Workspace & () const {
+        return *workspace;
+    }
+};
+
+
+//! A map defined only by its evolution: `Derived` implements
+//!     template <typename Scalar> void evolve(Eigen::Matrix<Scalar, Dim, 1> & point) const
+//! with the arithmetic of `Float` (e.g. `point[0] += k*sin(point[1])`, with `using std::sin;`), and the jacobian, the
+//! jacobian-vector product and `step` are computed from it by forward-mode automatic differentiation (`aux::Dual`):
+//! one evaluation gives the new state together with its derivatives along the D directions (the jacobian) or along
+//! the tangent vector (the jvp). A step with the jvp costs about 1.5 evaluations of the state alone in double
+//! precision and 2.5 with `mpfr::mpreal` (`benchmark/map_automatic.cpp`).
+//! The branches of `evolve` (e.g. `apply_boundary_conditions`) follow the values of the state.
+//! A fixed `Dim` avoids allocating the D derivatives of each operation of the jacobian on the heap.
+template <typename Derived, typename Float, int Dim = Eigen::Dynamic>
+class Automatic : public Map<Float, Dim> {
+public:
+    typedef typename Map<Float, Dim>::Matrix Matrix;
+    typedef typename Map<Float, Dim>::Vector Vector;
+    typedef typename Map<Float, Dim>::Workspace Workspace;
+    typedef aux::Dual<Float, 1> Tangent;  // the scalar of the jvp.
+    typedef aux::Dual<Float, Dim> Jacobian;  // the scalar of the jacobian.
+    using Map<Float, Dim>::T;
+    using Map<Float, Dim>::jacobian;
+    using Map<Float, Dim>::jvp;
+    using Map<Float, Dim>::step;
+
+    //! the workspace with the points of duals, to avoid repeating allocations.
+    struct DualWorkspace : public Workspace {
+        Eigen::Matrix<Tangent, Dim, 1> tangent_point;
+        Eigen::Matrix<Jacobian, Dim, 1> jacobian_point;
+
+        DualWorkspace(unsigned int D) : Workspace(D), tangent_point(D), jacobian_point(D) {}
+    };
+private:
+    Derived const& derived() const {
+        return static_cast<Derived const&>(*this);
+    }
+
+public:
+    Automatic(unsigned int D, std::string name) : Map<Float, Dim>(D, name) {}
+
+    Workspace * new_workspace() const {
+        return new DualWorkspace(this->D);
+    }
+
+    void T(Vector & point, Workspace & w) const {
+        derived().evolve(point);
+    }
+
+    Matrix const& jacobian(Vector const& point, Workspace & w) const {
+        unsigned int const D = this->D;
+        Matrix & _jacobian = w.jacobian;
+        auto & jacobian_point = static_cast<DualWorkspace &>(w).jacobian_point;
+        for (unsigned int i = 0; i < D; i++) {
+            jacobian_point[i].value = point[i];
+            jacobian_point[i].derivative.setZero(D);
+            jacobian_point[i].derivative[i] = 1;
+        }
+        derived().evolve(jacobian_point);
+
+        for (unsigned int i = 0; i < D; i++) {
+            if (jacobian_point[i].derivative.size() == 0)  // a constant
+                _jacobian.row(i).setZero();
+            else
+                _jacobian.row(i) = jacobian_point[i].derivative.transpose();
+        }
+        return _jacobian;
+    }
+
+    void jvp(Vector const& point, Vector & tangent, Workspace & w) const {
+        dual_jvp(point, tangent, static_cast<DualWorkspace &>(w));
+    }
+
+    //! one evaluation of `evolve` for both the state and the tangent vector (or the jacobian).
+    void step(Vector & point, Vector * tangent, Matrix * jac, Workspace & w) const {
+        DualWorkspace & dual = static_cast<DualWorkspace &>(w);
+        if (jac != nullptr) {
+            this->evolve_tangent(jacobian(point, w), tangent, jac);
+            for (unsigned int i = 0; i < this->D; i++)
+                point[i] = dual.jacobian_point[i].value;
+        }
+        else if (tangent != nullptr) {
+            dual_jvp(point, *tangent, dual);
+            for (unsigned int i = 0; i < this->D; i++)
+                point[i] = dual.tangent_point[i].value;
+        }
+        else
+            derived().evolve(point);
+    }
+
+private:
+    //! the jvp, leaving the new state in `w.tangent_point`.
+    void dual_jvp(Vector const& point, Vector & tangent, DualWorkspace & w) const {
+        unsigned int const D = this->D;
+        for (unsigned int i = 0; i < D; i++) {
+            w.tangent_point[i].value = point[i];
+            w.tangent_point[i].derivative[0] = tangent[i];
+        }
+        derived().evolve(w.tangent_point);
+        for (unsigned int i = 0; i < D; i++)
+            tangent[i] = w.tangent_point[i].derivative[0];
+    }
 };
 
 
-class Manneville : public Map {
+template <typename Float, int Dim = Eigen::Dynamic>
+class Manneville : public Map<Float, Dim> {
+    static_assert(Dim == Eigen::Dynamic or Dim == 1, "the Manneville map is 1-dimensional");
+public:
+    typedef typename Map<Float, Dim>::Matrix Matrix;
+    typedef typename Map<Float, Dim>::Vector Vector;
+    typedef typename Map<Float, Dim>::Workspace Workspace;
+    using Map<Float, Dim>::T;
+    using Map<Float, Dim>::jacobian;
+    using Map<Float, Dim>::jvp;
+    using Map<Float, Dim>::step;
+    typedef typename Map<Float, Dim>::pair pair;
+private:
     Float z;
-    std::vector<aux::pair> bounding_box;
+    Float z_minus_1;
+    unsigned long z_ui;  // z, if it is an integer (for the MPFR kernel).
+    std::vector<pair> bounding_box;
 public:
-    Manneville(Float z = 2) : Map(1, format("pm%1.f", z.toDouble())), bounding_box(1), z(z) {
+    Manneville(Float z = 2) : Map<Float, Dim>(1, format("pm%1.f", aux::to_double(z))), bounding_box(1), z(z),
+                              z_minus_1(z - 1), z_ui(kernel::integer(z)) {
         assert(z >= 1); // z = 1 is the Bernoulli shift.
-        bounding_box[0] = aux::pair(0, 1);
-        boundary[0] = aux::pair(0, 1);
+        bounding_box[0] = pair(0, 1);
+        this->boundary[0] = pair(0, 1);
     }
 
-    void T(Vector & point) {
-        point[0] = pow(point[0], z) + point[0];
-        apply_boundary_conditions(point, bounding_box);
+    void T(Vector & point, Workspace & w) const {
+        T(point, w, kernel::fused<Float>());
     }
 
-    Matrix const& jacobian(Vector const& point) {
-        _jacobian(0,0) = 1 + pow(point[0], z - 1)*z;
-        return _jacobian;
+    Matrix const& jacobian(Vector const& point, Workspace & w) const {
+        return jacobian(point, w, kernel::fused<Float>());
     }
 
-    virtual bool has_exited(Vector const & point) {
-        if (point[0] > Float("0.8"))
+    void jvp(Vector const& point, Vector & tangent, Workspace & w) const {
+        tangent[0] *= jacobian(point, w, kernel::fused<Float>())(0,0);
+    }
+
+    //! x^(z - 1) is shared by `T` and the jacobian.
+    void step(Vector & point, Vector * tangent, Matrix * jac, Workspace & w) const {
+        if (tangent == nullptr and jac == nullptr)
+            T(point, w, kernel::fused<Float>());
+        else
+            step(point, tangent, jac, w, kernel::fused<Float>());
+    }
+
+    virtual bool has_exited(Vector const & point) const {
+        if (point[0] > aux::from_string<Float>("0.8"))
             return true;
         else
             return false;
     }
+
+protected:
+    void T(Vector & point, Workspace & w, std::false_type) const {
+        point[0] = pow(point[0], z) + point[0];
+        this->apply_boundary_conditions(point, bounding_box);
+    }
+
+    Matrix const& jacobian(Vector const& point, Workspace & w, std::false_type) const {
+        w.jacobian(0,0) = 1 + pow(point[0], z - 1)*z;
+        return w.jacobian;
+    }
+
+    void T(Vector & point, Workspace & w, std::true_type) const {
+        using namespace kernel;
+        mpfr_ptr power = scratch(w.registers[0], precision(point[0], z));
+        if (z_ui)
+            mpfr_pow_ui(power, src(point[0]), z_ui, MPFR_RNDN);
+        else
+            mpfr_pow(power, src(point[0]), src(z), MPFR_RNDN);
+        mpfr_add(widen(point[0], mpfr_get_prec(power)), src(point[0]), power, MPFR_RNDN);
+        wrap_unit(point[0]);
+    }
+
+    Matrix const& jacobian(Vector const& point, Workspace & w, std::true_type) const {
+        using namespace kernel;
+        mpfr_ptr j = scratch(w.jacobian(0,0), precision(point[0], z));
+        if (z_ui)
+            mpfr_pow_ui(j, src(point[0]), z_ui - 1, MPFR_RNDN);
+        else
+            mpfr_pow(j, src(point[0]), src(z_minus_1), MPFR_RNDN);
+        if (z_ui)
+            mpfr_mul_ui(j, j, z_ui, MPFR_RNDN);
+        else
+            mpfr_mul(j, j, src(z), MPFR_RNDN);
+        mpfr_add_ui(j, j, 1, MPFR_RNDN);
+        return w.jacobian;
+    }
+
+    void step(Vector & point, Vector * tangent, Matrix * jac, Workspace & w, std::false_type) const {
+        Float power = pow(point[0], z_minus_1);
+        w.jacobian(0,0) = 1 + power*z;
+        this->evolve_tangent(w.jacobian, tangent, jac);
+        point[0] = point[0]*power + point[0];
+        this->apply_boundary_conditions(point, bounding_box);
+    }
+
+    void step(Vector & point, Vector * tangent, Matrix * jac, Workspace & w, std::true_type) const {
+        using namespace kernel;
+        mpfr_ptr power = scratch(w.registers[0], precision(point[0], z));
+        if (z_ui)
+            mpfr_pow_ui(power, src(point[0]), z_ui - 1, MPFR_RNDN);
+        else
+            mpfr_pow(power, src(point[0]), src(z_minus_1), MPFR_RNDN);
+
+        mpfr_ptr j = scratch(w.jacobian(0,0), mpfr_get_prec(power));
+        if (z_ui)
+            mpfr_mul_ui(j, power, z_ui, MPFR_RNDN);
+        else
+            mpfr_mul(j, power, src(z), MPFR_RNDN);
+        mpfr_add_ui(j, j, 1, MPFR_RNDN);
+        this->evolve_tangent(w.jacobian, tangent, jac);
+
+        // x^z + x = x*x^(z - 1) + x
+        mpfr_ptr x = widen(point[0], mpfr_get_prec(power));
+        mpfr_fma(x, x, power, x, MPFR_RNDN);
+        wrap_unit(point[0]);
+    }
 };
 
 
-class Standard : public Map {
+template <typename Float, int Dim = Eigen::Dynamic>
+class Standard : public Map<Float, Dim> {
+    static_assert(Dim == Eigen::Dynamic or Dim == 2, "the standard map is 2-dimensional");
+public:
+    typedef typename Map<Float, Dim>::Matrix Matrix;
+    typedef typename Map<Float, Dim>::Vector Vector;
+    typedef typename Map<Float, Dim>::Workspace Workspace;
+    using Map<Float, Dim>::T;
+    using Map<Float, Dim>::jacobian;
+    using Map<Float, Dim>::jvp;
+    using Map<Float, Dim>::step;
+    typedef typename Map<Float, Dim>::pair pair;
+private:
     Float k;
-    std::vector<aux::pair> bounding_box;
+    std::vector<pair> bounding_box;
 public:
-    Standard(Float k) : Map(2, format("sm%1.f", k.toDouble())), bounding_box(2), k(k/(2*aux::pi)) {
-        bounding_box[0] = aux::pair(0, 1);
-        bounding_box[1] = aux::pair(0, 1);
+    Standard(Float k) : Map<Float, Dim>(2, format("sm%1.f", aux::to_double(k))), bounding_box(2), k(k/(2*aux::Scalar<Float>::pi())) {
+        bounding_box[0] = pair(0, 1);
+        bounding_box[1] = pair(0, 1);
 
-        boundary[0] = aux::pair(0, 1);
-        boundary[1] = aux::pair(0, 1);
+        this->boundary[0] = pair(0, 1);
+        this->boundary[1] = pair(0, 1);
+    }
+
+    void T(Vector & point, Workspace & w) const {
+        T(point, w, kernel::fused<Float>());
+    }
+
+    Matrix const& jacobian(Vector const& point, Workspace & w) const {
+        return jacobian(point, w, kernel::fused<Float>());
+    }
+
+    void jvp(Vector const& point, Vector & tangent, Workspace & w) const {
+        jvp(point, tangent, w, kernel::fused<Float>());
+    }
+
+    //! the sine and the cosine of 2*pi*q are computed together.
+    void step(Vector & point, Vector * tangent, Matrix * jac, Workspace & w) const {
+        if (tangent == nullptr and jac == nullptr)
+            T(point, w, kernel::fused<Float>());
+        else
+            step(point, tangent, jac, w, kernel::fused<Float>());
     }
 
-    void T(Vector & point) {
-        point[0] += k*sin(2*aux::pi*point[1]);
+    virtual bool has_exited(Vector const & point) const {
+        if (point[1] < 0.1)
+            return true;
+        else
+            return false;
+    };
+
+protected:
+    void T(Vector & point, Workspace & w, std::false_type) const {
+        Float const& pi = aux::Scalar<Float>::pi();
+        point[0] += k*sin(2*pi*point[1]);
+        point[1] += point[0];
+        this->apply_boundary_conditions(point, bounding_box);
+    }
+
+    Matrix const& jacobian(Vector const& point, Workspace & w, std::false_type) const {
+        Float const& pi = aux::Scalar<Float>::pi();
+        return fill_jacobian(w, cos(2*pi*point[1]));
+    }
+
+    void jvp(Vector const& point, Vector & tangent, Workspace & w, std::false_type) const {
+        Float const& pi = aux::Scalar<Float>::pi();
+        shear(k*2*pi*cos(2*pi*point[1]), tangent);
+    }
+
+    void step(Vector & point, Vector * tangent, Matrix * jac, Workspace & w, std::false_type) const {
+        Float const& pi = aux::Scalar<Float>::pi();
+        Float angle = 2*pi*point[1];
+        if (jac != nullptr)
+            this->evolve_tangent(fill_jacobian(w, cos(angle)), tangent, jac);
+        else
+            shear(k*2*pi*cos(angle), *tangent);
+        point[0] += k*sin(angle);
         point[1] += point[0];
-        apply_boundary_conditions(point, bounding_box);
+        this->apply_boundary_conditions(point, bounding_box);
     }
 
-    Matrix const& jacobian(Vector const& point) {
+    //! the jacobian from cos(2*pi*q).
+    Matrix const& fill_jacobian(Workspace & w, Float const& cosine) const {
+        Float const& pi = aux::Scalar<Float>::pi();
+        Matrix & _jacobian = w.jacobian;
         _jacobian(0,0) = 1;
         _jacobian(1,0) = 1;
-        _jacobian(0,1) = k*2*aux::pi*cos(2*aux::pi*point[1]);
+        _jacobian(0,1) = k*2*pi*cosine;
         _jacobian(1,1) = 1 + _jacobian(0,1);
         return _jacobian;
     }
 
-    virtual bool has_exited(Vector const & point) {
-        if (point[1] < 0.1)
-            return true;
+    //! the product of the jacobian with `tangent` from its entry (0,1), `j` = k*2*pi*cos(2*pi*q):
+    //! dp' = dp + j dq, dq' = dq + dp'.
+    static void shear(Float const& j, Vector & tangent) {
+        tangent[0] += j*tangent[1];
+        tangent[1] += tangent[0];
+    }
+
+    void T(Vector & point, Workspace & w, std::true_type) const {
+        using namespace kernel;
+        Float const& pi = aux::Scalar<Float>::pi();
+        mpfr_ptr s = scratch(w.registers[0], precision(point[1], pi));
+        angle(s, src(point[1]), pi);
+        mpfr_sin(s, s, MPFR_RNDN);
+        kick(point, s);
+    }
+
+    Matrix const& jacobian(Vector const& point, Workspace & w, std::true_type) const {
+        using namespace kernel;
+        Float const& pi = aux::Scalar<Float>::pi();
+        mpfr_ptr c = scratch(w.registers[1], precision(point[1], pi));
+        angle(c, src(point[1]), pi);
+        mpfr_cos(c, c, MPFR_RNDN);
+        return fill_jacobian(w, c, precision(k, pi, point[1]));
+    }
+
+    void jvp(Vector const& point, Vector & tangent, Workspace & w, std::true_type) const {
+        shear(jacobian(point, w, std::true_type())(0,1), tangent);
+    }
+
+    void step(Vector & point, Vector * tangent, Matrix * jac, Workspace & w, std::true_type) const {
+        using namespace kernel;
+        Float const& pi = aux::Scalar<Float>::pi();
+        mpfr_prec_t prec = precision(point[1], pi);
+        mpfr_ptr s = scratch(w.registers[0], prec);
+        mpfr_ptr c = scratch(w.registers[1], prec);
+        angle(c, src(point[1]), pi);
+        mpfr_sin_cos(s, c, c, MPFR_RNDN);
+        Matrix const& j = fill_jacobian(w, c, precision(k, pi, point[1]));
+        if (jac != nullptr)
+            this->evolve_tangent(j, tangent, jac);
         else
-            return false;
-    };
+            shear(j(0,1), *tangent);
+        kick(point, s);
+    }
+
+    //! the jacobian from cos(2*pi*q), with precision `prec`.
+    Matrix const& fill_jacobian(Workspace & w, mpfr_srcptr cosine, mpfr_prec_t prec) const {
+        using namespace kernel;
+        Float const& pi = aux::Scalar<Float>::pi();
+        Matrix & _jacobian = w.jacobian;
+        _jacobian(0,0) = 1;
+        _jacobian(1,0) = 1;
+        mpfr_ptr j = scratch(_jacobian(0,1), prec);
+        mpfr_mul_2ui(j, src(k), 1, MPFR_RNDN);
+        mpfr_mul(j, j, src(pi), MPFR_RNDN);
+        mpfr_mul(j, j, cosine, MPFR_RNDN);
+        mpfr_add_ui(scratch(_jacobian(1,1), prec), j, 1, MPFR_RNDN);
+        return _jacobian;
+    }
+
+    //! p += k*sin(2*pi*q); q += p
+    void kick(Vector & point, mpfr_srcptr sine) const {
+        using namespace kernel;
+        mpfr_fma(ptr(point[0]), src(k), sine, src(point[0]), MPFR_RNDN);
+        mpfr_add(ptr(point[1]), src(point[1]), src(point[0]), MPFR_RNDN);
+        wrap_unit(point[0]);
+        wrap_unit(point[1]);
+    }
 };
 
 
 //! Eq. (1) in http://arxiv.org/pdf/1311.7632v2.pdf
-class CoupledStandard : public Map {
+template <typename Float, int Dim = Eigen::Dynamic>
+class CoupledStandard : public Map<Float, Dim> {
+    static_assert(Dim == Eigen::Dynamic or Dim == 4, "the coupled standard map is 4-dimensional");
+public:
+    typedef typename Map<Float, Dim>::Matrix Matrix;
+    typedef typename Map<Float, Dim>::Vector Vector;
+    typedef typename Map<Float, Dim>::Workspace Workspace;
+    using Map<Float, Dim>::T;
+    using Map<Float, Dim>::jacobian;
+    using Map<Float, Dim>::jvp;
+    using Map<Float, Dim>::step;
+    typedef typename Map<Float, Dim>::pair pair;
+private:
     Float k1, k2, xi;
-    std::vector<aux::pair> bounding_box;
+    std::vector<pair> bounding_box;
+
+    static Float number(const char* value) {
+        return aux::from_string<Float>(value);
+    }
 public:
-    CoupledStandard() : Map(4, "csm"), bounding_box(4), k1("-2.25"/(2*aux::pi)), k2("-3.0"/(2*aux::pi)), xi("1.0"/(2*aux::pi)) {
+    CoupledStandard() : Map<Float, Dim>(4, "csm"), bounding_box(4),
+                        k1(number("-2.25")/(2*aux::Scalar<Float>::pi())),
+                        k2(number("-3.0")/(2*aux::Scalar<Float>::pi())),
+                        xi(number("1.0")/(2*aux::Scalar<Float>::pi())) {
         //! right after Eq. (1)
-        bounding_box[0] = aux::pair("-0.5", "0.5");
-        bounding_box[1] = aux::pair("-0.5", "0.5");
-        bounding_box[2] = aux::pair("-0.5", "0.5");
-        bounding_box[3] = aux::pair("-0.5", "0.5");
+        bounding_box[0] = pair(number("-0.5"), number("0.5"));
+        bounding_box[1] = pair(number("-0.5"), number("0.5"));
+        bounding_box[2] = pair(number("-0.5"), number("0.5"));
+        bounding_box[3] = pair(number("-0.5"), number("0.5"));
 
-        for (unsigned int i = 0; i < D; i++)
-            boundary[i] = aux::pair("-0.5","0.5");
+        for (unsigned int i = 0; i < this->D; i++)
+            this->boundary[i] = pair(number("-0.5"), number("0.5"));
     }
 
-    void T(Vector &point) {
-        point[2] += point[0];
-        point[3] += point[1];
-
-        Float coupling = xi*sin(2*aux::pi*(point[2] + point[3]));
-        point[0] += k1*sin(2*aux::pi*point[2]) + coupling;
-        point[1] += k2*sin(2*aux::pi*point[3]) + coupling;
-        apply_boundary_conditions(point, bounding_box);
+    void T(Vector & point, Workspace & w) const {
+        T(point, w, kernel::fused<Float>());
     }
 
     /*
@@ -155,17 +798,87 @@ public:
 
      D[P1[p1, p2, q1, q2], {{p1, p2, q1, q2}}] // MatrixForm
     */
-    Matrix const& jacobian(Vector const& point) {
-        _jacobian = Matrix::Zero(D,D);
+    Matrix const& jacobian(Vector const& point, Workspace & w) const {
+        return jacobian(point, w, kernel::fused<Float>());
+    }
+
+    void jvp(Vector const& point, Vector & tangent, Workspace & w) const {
+        jvp(point, tangent, w, kernel::fused<Float>());
+    }
+
+    //! the sines and the cosines of the three angles are computed together.
+    void step(Vector & point, Vector * tangent, Matrix * jac, Workspace & w) const {
+        if (tangent == nullptr and jac == nullptr)
+            T(point, w, kernel::fused<Float>());
+        else
+            step(point, tangent, jac, w, kernel::fused<Float>());
+    }
+
+    virtual bool has_exited(Vector const & point) const {
+        if (point[0] < number("-0.4") or point[1] < number("-0.4"))
+            return true;
+        else
+            return false;
+    };
+
+protected:
+    void T(Vector & point, Workspace & w, std::false_type) const {
+        Float const& pi = aux::Scalar<Float>::pi();
+        point[2] += point[0];
+        point[3] += point[1];
+
+        Float coupling = xi*sin(2*pi*(point[2] + point[3]));
+        point[0] += k1*sin(2*pi*point[2]) + coupling;
+        point[1] += k2*sin(2*pi*point[3]) + coupling;
+        this->apply_boundary_conditions(point, bounding_box);
+    }
+
+    Matrix const& jacobian(Vector const& point, Workspace & w, std::false_type) const {
         Float const& p1 = point[0];
         Float const& p2 = point[1];
         Float const& q1 = point[2];
         Float const& q2 = point[3];
 
-        Float const& pi = aux::pi;
-        Float coupling = 2*pi*xi*cos(2*pi*(p1 + q1 + p2 + q2));
-        Float bla1 = 2*pi*k1*cos(2*pi*(p1 + q1));
-        Float bla2 = 2*pi*k2*cos(2*pi*(p2 + q2));
+        Float const& pi = aux::Scalar<Float>::pi();
+        return fill_jacobian(w, cos(2*pi*(p1 + q1)), cos(2*pi*(p2 + q2)), cos(2*pi*(p1 + q1 + p2 + q2)));
+    }
+
+    void jvp(Vector const& point, Vector & tangent, Workspace & w, std::false_type) const {
+        Float const& pi = aux::Scalar<Float>::pi();
+        Float q1 = point[2] + point[0];
+        Float q2 = point[3] + point[1];
+        product(2*pi*k1*cos(2*pi*q1), 2*pi*k2*cos(2*pi*q2), 2*pi*xi*cos(2*pi*(q1 + q2)), tangent);
+    }
+
+    void step(Vector & point, Vector * tangent, Matrix * jac, Workspace & w, std::false_type) const {
+        Float const& pi = aux::Scalar<Float>::pi();
+        point[2] += point[0];
+        point[3] += point[1];
+
+        // the jacobian only depends on the new q1 and q2.
+        Float angle1 = 2*pi*point[2];
+        Float angle2 = 2*pi*point[3];
+        Float angle12 = 2*pi*(point[2] + point[3]);
+        if (jac != nullptr)
+            this->evolve_tangent(fill_jacobian(w, cos(angle1), cos(angle2), cos(angle12)), tangent, jac);
+        else
+            product(2*pi*k1*cos(angle1), 2*pi*k2*cos(angle2), 2*pi*xi*cos(angle12), *tangent);
+
+        Float coupling = xi*sin(angle12);
+        point[0] += k1*sin(angle1) + coupling;
+        point[1] += k2*sin(angle2) + coupling;
+        this->apply_boundary_conditions(point, bounding_box);
+    }
+
+    //! the jacobian from the cosines of 2*pi*(p1 + q1), 2*pi*(p2 + q2) and 2*pi*(p1 + q1 + p2 + q2).
+    Matrix const& fill_jacobian(Workspace & w, Float const& cos1, Float const& cos2, Float const& cos12) const {
+        Matrix & _jacobian = w.jacobian;
+        _jacobian.setZero();
+
+        Float const& pi = aux::Scalar<Float>::pi();
+        Float coupling = 2*pi*xi*cos12;
+        Float bla1 = 2*pi*k1*cos1;
+        Float bla2 = 2*pi*k2*cos2;
 
         _jacobian(0,0) = 1 + bla1 + coupling;
         _jacobian(0,1) = coupling;
@@ -179,113 +892,422 @@ public:
         return _jacobian;
     }
 
-    virtual bool has_exited(Vector const & point) {
-        if (point[0] < "-0.4" or point[1] < "-0.4")
-            return true;
-        else
-            return false;
-    };
+    //! the product of the jacobian with `tangent` from bla = 2*pi*k*cos(2*pi*q) and
+    //! coupling = 2*pi*xi*cos(2*pi*(q1 + q2)), without filling the jacobian.
+    static void product(Float const& bla1, Float const& bla2, Float const& coupling, Vector & tangent) {
+        Float dq1 = tangent[0] + tangent[2];
+        Float dq2 = tangent[1] + tangent[3];
+        Float coupled = coupling*(dq1 + dq2);
+        tangent[0] += bla1*dq1 + coupled;
+        tangent[1] += bla2*dq2 + coupled;
+        tangent[2] = dq1;
+        tangent[3] = dq2;
+    }
+
+    void T(Vector & point, Workspace & w, std::true_type) const {
+        using namespace kernel;
+        Float const& pi = aux::Scalar<Float>::pi();
+        mpfr_add(ptr(point[2]), src(point[2]), src(point[0]), MPFR_RNDN);
+        mpfr_add(ptr(point[3]), src(point[3]), src(point[1]), MPFR_RNDN);
+
+        mpfr_ptr q12 = scratch(w.registers[0], precision(point[2], point[3]));
+        mpfr_add(q12, src(point[2]), src(point[3]), MPFR_RNDN);
+
+        mpfr_ptr s1 = scratch(w.registers[1], precision(point[2], pi));
+        mpfr_ptr s2 = scratch(w.registers[2], precision(point[3], pi));
+        mpfr_ptr s12 = scratch(w.registers[3], precision(w.registers[0], pi));
+        angle(s1, src(point[2]), pi);
+        mpfr_sin(s1, s1, MPFR_RNDN);
+        angle(s2, src(point[3]), pi);
+        mpfr_sin(s2, s2, MPFR_RNDN);
+        angle(s12, q12, pi);
+        mpfr_sin(s12, s12, MPFR_RNDN);
+        kick(w, point);
+    }
+
+    Matrix const& jacobian(Vector const& point, Workspace & w, std::true_type) const {
+        cosines(w, point);
+        return fill_jacobian(w);
+    }
+
+    void jvp(Vector const& point, Vector & tangent, Workspace & w, std::true_type) const {
+        cosines(w, point);
+        coefficients(w);
+        product(w.registers[4], w.registers[5], w.registers[6], tangent);
+    }
+
+    //! the cosines of the jacobian at `point` in `w.registers[4]`, `w.registers[5]` and `w.registers[6]`.
+    void cosines(Workspace & w, Vector const& point) const {
+        using namespace kernel;
+        Float const& pi = aux::Scalar<Float>::pi();
+
+        // the arguments are computed as in `T`.
+        mpfr_ptr q1 = scratch(w.registers[0], precision(point[0], point[2]));
+        mpfr_ptr q2 = scratch(w.registers[1], precision(point[1], point[3]));
+        mpfr_ptr q12 = scratch(w.registers[2], std::max(mpfr_get_prec(q1), mpfr_get_prec(q2)));
+        mpfr_add(q1, src(point[2]), src(point[0]), MPFR_RNDN);
+        mpfr_add(q2, src(point[3]), src(point[1]), MPFR_RNDN);
+        mpfr_add(q12, q1, q2, MPFR_RNDN);
+
+        mpfr_ptr c1 = scratch(w.registers[4], precision(w.registers[0], pi, k1));
+        mpfr_ptr c2 = scratch(w.registers[5], precision(w.registers[1], pi, k2));
+        mpfr_ptr c12 = scratch(w.registers[6], precision(w.registers[2], pi, xi));
+        angle(c1, q1, pi);
+        mpfr_cos(c1, c1, MPFR_RNDN);
+        angle(c2, q2, pi);
+        mpfr_cos(c2, c2, MPFR_RNDN);
+        angle(c12, q12, pi);
+        mpfr_cos(c12, c12, MPFR_RNDN);
+    }
+
+    void step(Vector & point, Vector * tangent, Matrix * jac, Workspace & w, std::true_type) const {
+        using namespace kernel;
+        Float const& pi = aux::Scalar<Float>::pi();
+        mpfr_add(ptr(point[2]), src(point[2]), src(point[0]), MPFR_RNDN);
+        mpfr_add(ptr(point[3]), src(point[3]), src(point[1]), MPFR_RNDN);
+
+        mpfr_ptr q12 = scratch(w.registers[0], precision(point[2], point[3]));
+        mpfr_add(q12, src(point[2]), src(point[3]), MPFR_RNDN);
+
+        mpfr_ptr s1 = scratch(w.registers[1], precision(point[2], pi));
+        mpfr_ptr s2 = scratch(w.registers[2], precision(point[3], pi));
+        mpfr_ptr s12 = scratch(w.registers[3], precision(w.registers[0], pi));
+        mpfr_ptr c1 = scratch(w.registers[4], precision(point[2], pi, k1));
+        mpfr_ptr c2 = scratch(w.registers[5], precision(point[3], pi, k2));
+        mpfr_ptr c12 = scratch(w.registers[6], precision(w.registers[0], pi, xi));
+        angle(c1, src(point[2]), pi);
+        mpfr_sin_cos(s1, c1, c1, MPFR_RNDN);
+        angle(c2, src(point[3]), pi);
+        mpfr_sin_cos(s2, c2, c2, MPFR_RNDN);
+        angle(c12, q12, pi);
+        mpfr_sin_cos(s12, c12, c12, MPFR_RNDN);
+
+        // the jacobian only depends on the new q1 and q2.
+        if (jac != nullptr)
+            this->evolve_tangent(fill_jacobian(w), tangent, jac);
+        else {
+            coefficients(w);
+            product(w.registers[4], w.registers[5], w.registers[6], *tangent);
+        }
+        kick(w, point);
+    }
+
+    //! the jacobian from the cosines in `w.registers[4]`, `w.registers[5]` and `w.registers[6]` (which are overwritten).
+    Matrix const& fill_jacobian(Workspace & w) const {
+        using namespace kernel;
+        Matrix & _jacobian = w.jacobian;
+        coefficients(w);
+        mpfr_srcptr bla1 = src(w.registers[4]);
+        mpfr_srcptr bla2 = src(w.registers[5]);
+        mpfr_srcptr coupling = src(w.registers[6]);
+
+        mpfr_prec_t prec = precision(w.registers[4], w.registers[5], w.registers[6]);
+        mpfr_ptr j = scratch(_jacobian(0,2), prec);
+        mpfr_add(j, bla1, coupling, MPFR_RNDN);
+        mpfr_add_ui(scratch(_jacobian(0,0), prec), j, 1, MPFR_RNDN);
+        j = scratch(_jacobian(1,3), prec);
+        mpfr_add(j, bla2, coupling, MPFR_RNDN);
+        mpfr_add_ui(scratch(_jacobian(1,1), prec), j, 1, MPFR_RNDN);
+        _jacobian(0,1) = w.registers[6];
+        _jacobian(0,3) = w.registers[6];
+        _jacobian(1,0) = w.registers[6];
+        _jacobian(1,2) = w.registers[6];
+
+        _jacobian(2,1) = _jacobian(2,3) = _jacobian(3,0) = _jacobian(3,2) = 0;
+        _jacobian(2,0) = _jacobian(2,2) = _jacobian(3,1) = _jacobian(3,3) = 1;
+        return _jacobian;
+    }
+
+    //! the cosines in `w.registers[4]`, `w.registers[5]` and `w.registers[6]` to bla = 2*pi*k*cos(2*pi*q) and
+    //! coupling = 2*pi*xi*cos(2*pi*(q1 + q2)), in place.
+    void coefficients(Workspace & w) const {
+        using namespace kernel;
+        Float const& pi = aux::Scalar<Float>::pi();
+        mpfr_ptr bla1 = ptr(w.registers[4]);
+        mpfr_mul(bla1, bla1, src(k1), MPFR_RNDN);
+        angle(bla1, bla1, pi);
+        mpfr_ptr bla2 = ptr(w.registers[5]);
+        mpfr_mul(bla2, bla2, src(k2), MPFR_RNDN);
+        angle(bla2, bla2, pi);
+        mpfr_ptr coupling = ptr(w.registers[6]);
+        mpfr_mul(coupling, coupling, src(xi), MPFR_RNDN);
+        angle(coupling, coupling, pi);
+    }
+
+    //! p += k*sin(2*pi*q) + xi*sin(2*pi*(q1 + q2)), from the sines in `w.registers[1]`, `w.registers[2]` and
+    //! `w.registers[3]`. Overwrites `w.registers[0]`.
+    void kick(Workspace & w, Vector & point) const {
+        using namespace kernel;
+        mpfr_ptr impulse = scratch(w.registers[0], precision(k1, xi, w.registers[1], w.registers[3]));
+        mpfr_fmma(impulse, src(k1), src(w.registers[1]), src(xi), src(w.registers[3]), MPFR_RNDN);
+        mpfr_add(ptr(point[0]), src(point[0]), impulse, MPFR_RNDN);
+        impulse = scratch(w.registers[0], precision(k2, xi, w.registers[2], w.registers[3]));
+        mpfr_fmma(impulse, src(k2), src(w.registers[2]), src(xi), src(w.registers[3]), MPFR_RNDN);
+        mpfr_add(ptr(point[1]), src(point[1]), impulse, MPFR_RNDN);
+
+        this->apply_boundary_conditions(point, bounding_box);
+    }
 };
 
 
-class Tent : public Map {
+template <typename Float, int Dim = Eigen::Dynamic>
+class Tent : public Map<Float, Dim> {
+    static_assert(Dim == Eigen::Dynamic or Dim == 1, "the tent map is 1-dimensional");
+public:
+    typedef typename Map<Float, Dim>::Matrix Matrix;
+    typedef typename Map<Float, Dim>::Vector Vector;
+    typedef typename Map<Float, Dim>::Workspace Workspace;
+    using Map<Float, Dim>::T;
+    using Map<Float, Dim>::jacobian;
+    using Map<Float, Dim>::jvp;
+    using Map<Float, Dim>::step;
+    typedef typename Map<Float, Dim>::pair pair;
 protected:
     Float a;
+    Float threshold;  // 1/a
+    Float slope;  // a/(a - 1)
+    Float minus_slope;
+    unsigned long a_ui;  // a, if it is an integer (for the MPFR kernel).
 public:
-    Tent(Float a) : Map(1, format("tent%.1f", a.toDouble())), a(a) {
-        boundary[0] = aux::pair(0, 1);
+    Tent(Float a) : Map<Float, Dim>(1, format("tent%.1f", aux::to_double(a))), a(a), threshold(1/a),
+                    slope(a/(a - 1)), minus_slope(-slope), a_ui(kernel::integer(a)) {
+        this->boundary[0] = pair(0, 1);
     }
 
-    void T(Vector & point) {
-        if (point[0] < 1/a)
-            point[0] *= a;
+    //! the slope of the left branch.
+    Float const& get_a() const {return a;}
+
+    void T(Vector & point, Workspace & w) const {
+        T(point, w, kernel::fused<Float>());
+    }
+
+    Matrix const& jacobian(Vector const& point, Workspace & w) const {
+        if (point[0] < threshold)
+            w.jacobian(0,0) = a;
         else
-            point[0] = a/(a - 1)*(1 - point[0]);
+            w.jacobian(0,0) = minus_slope;
+        return w.jacobian;
     }
 
-    Matrix const& jacobian(Vector const& point) {
-        if (point[0] < 1/a)
-            _jacobian(0,0) = a;
+    void jvp(Vector const& point, Vector & tangent, Workspace & w) const {
+        if (point[0] < threshold)
+            tangent[0] *= a;
         else
-            _jacobian(0,0) = -a/(a - 1);
-        return _jacobian;
+            tangent[0] *= minus_slope;
     }
 
-    virtual bool has_exited(Vector const & point) {
-        if (point[0] < "0.4")
+    virtual bool has_exited(Vector const & point) const {
+        if (point[0] < aux::from_string<Float>("0.4"))
             return true;
         else
             return false;
     };
+
+protected:
+    void T(Vector & point, Workspace & w, std::false_type) const {
+        if (point[0] < threshold)
+            point[0] *= a;
+        else
+            point[0] = slope*(1 - point[0]);
+    }
+
+    void T(Vector & point, Workspace & w, std::true_type) const {
+        using namespace kernel;
+        mpfr_ptr x = ptr(point[0]);
+        if (point[0] < threshold) {
+            if (a_ui)
+                mpfr_mul_ui(x, x, a_ui, MPFR_RNDN);
+            else
+                mpfr_mul(x, x, src(a), MPFR_RNDN);
+        }
+        else {
+            mpfr_ui_sub(x, 1, x, MPFR_RNDN);
+            mpfr_mul(widen(point[0], precision(point[0], slope)), src(slope), x, MPFR_RNDN);
+        }
+    }
 };
 
 
 //! Defined in Transient chaos: Complex dynamics in finite time scales (Lai + Tel)
-class OpenTent : public Map {
+template <typename Float, int Dim = Eigen::Dynamic>
+class OpenTent : public Map<Float, Dim> {
+    static_assert(Dim == Eigen::Dynamic or Dim == 1, "the tent map is 1-dimensional");
+public:
+    typedef typename Map<Float, Dim>::Matrix Matrix;
+    typedef typename Map<Float, Dim>::Vector Vector;
+    typedef typename Map<Float, Dim>::Workspace Workspace;
+    using Map<Float, Dim>::T;
+    using Map<Float, Dim>::jacobian;
+    using Map<Float, Dim>::jvp;
+    using Map<Float, Dim>::step;
+    typedef typename Map<Float, Dim>::pair pair;
+private:
     Float a;
     Float b;
+    Float threshold;  // b/(a + b)
+    unsigned long a_ui, b_ui;  // a and b, if they are integers (for the MPFR kernel).
 public:
-    OpenTent(Float a, Float b) : Map(1, format("tent%.f&%.f", a.toDouble(), b.toDouble())), a(a), b(b) {
-        boundary[0] = aux::pair(0, 1);
+    OpenTent(Float a, Float b) : Map<Float, Dim>(1, format("tent%.f&%.f", aux::to_double(a), aux::to_double(b))), a(a), b(b),
+                                 threshold(b/(a + b)), a_ui(kernel::integer(a)), b_ui(kernel::integer(b)) {
+        this->boundary[0] = pair(0, 1);
     }
 
-    void T(Vector & point) {
-        if (point[0] < b/(a + b))
-            point[0] *= a;
+    //! the slope of the left branch.
+    Float const& get_a() const {return a;}
+    //! minus the slope of the right branch.
+    Float const& get_b() const {return b;}
+
+    void T(Vector & point, Workspace & w) const {
+        T(point, w, kernel::fused<Float>());
+    }
+
+    Matrix const& jacobian(Vector const& point, Workspace & w) const {
+        if (point[0] < threshold)
+            w.jacobian(0,0) = a;
         else
-            point[0] = b*(1 - point[0]);
+            w.jacobian(0,0) = b;
+        return w.jacobian;
     }
 
-    Matrix const& jacobian(Vector const& point) {
-        if (point[0] < b/(a + b))
-            _jacobian(0,0) = a;
+    void jvp(Vector const& point, Vector & tangent, Workspace & w) const {
+        if (point[0] < threshold)
+            tangent[0] *= a;
         else
-            _jacobian(0,0) = b;
-        return _jacobian;
+            tangent[0] *= b;
     }
 
-    virtual bool has_exited(Vector const & point) {
+    virtual bool has_exited(Vector const & point) const {
         if (0 < point[0] and point[0] < 1)
             return false;
         else
             return true;
     };
+
+protected:
+    void T(Vector & point, Workspace & w, std::false_type) const {
+        if (point[0] < threshold)
+            point[0] *= a;
+        else
+            point[0] = b*(1 - point[0]);
+    }
+
+    void T(Vector & point, Workspace & w, std::true_type) const {
+        using namespace kernel;
+        mpfr_ptr x = ptr(point[0]);
+        if (point[0] < threshold) {
+            if (a_ui)
+                mpfr_mul_ui(x, x, a_ui, MPFR_RNDN);
+            else
+                mpfr_mul(x, x, src(a), MPFR_RNDN);
+        }
+        else {
+            mpfr_ui_sub(x, 1, x, MPFR_RNDN);
+            x = widen(point[0], precision(point[0], b));
+            if (b_ui)
+                mpfr_mul_ui(x, x, b_ui, MPFR_RNDN);
+            else
+                mpfr_mul(x, x, src(b), MPFR_RNDN);
+        }
+    }
 };
 
 
-class Logistic : public Map {
+template <typename Float, int Dim = Eigen::Dynamic>
+class Logistic : public Map<Float, Dim> {
+    static_assert(Dim == Eigen::Dynamic or Dim == 1, "the logistic map is 1-dimensional");
+public:
+    typedef typename Map<Float, Dim>::Matrix Matrix;
+    typedef typename Map<Float, Dim>::Vector Vector;
+    typedef typename Map<Float, Dim>::Workspace Workspace;
+    using Map<Float, Dim>::T;
+    using Map<Float, Dim>::jacobian;
+    using Map<Float, Dim>::jvp;
+    using Map<Float, Dim>::step;
+    typedef typename Map<Float, Dim>::pair pair;
+private:
     Float r;
+    unsigned long r_ui;  // r, if it is an integer (for the MPFR kernel).
 public:
-    Logistic(Float r) : Map(1, format("logistic%1.f", r.toDouble())), r(r) {
-        boundary[0] = aux::pair(0, 1);
+    Logistic(Float r) : Map<Float, Dim>(1, format("logistic%1.f", aux::to_double(r))), r(r), r_ui(kernel::integer(r)) {
+        this->boundary[0] = pair(0, 1);
     }
 
-    void T(Vector & point) {
-        point[0] = r*(1 - point[0])*point[0];
+    void T(Vector & point, Workspace & w) const {
+        T(point, w, kernel::fused<Float>());
     }
 
-    Matrix const& jacobian(Vector const& point) {
-        _jacobian(0,0) = r*(1 - 2*point[0]);
-        return _jacobian;
+    Matrix const& jacobian(Vector const& point, Workspace & w) const {
+        return jacobian(point, w, kernel::fused<Float>());
+    }
+
+    void jvp(Vector const& point, Vector & tangent, Workspace & w) const {
+        tangent[0] *= jacobian(point, w, kernel::fused<Float>())(0,0);
     }
 
-    virtual bool has_exited(Vector const & point) {
-        if (0 < point[0] and point[0] < Float("0.2"))
+    virtual bool has_exited(Vector const & point) const {
+        if (0 < point[0] and point[0] < aux::from_string<Float>("0.2"))
             return true;
         else
             return false;
     };
+
+protected:
+    void T(Vector & point, Workspace & w, std::false_type) const {
+        point[0] = r*(1 - point[0])*point[0];
+    }
+
+    Matrix const& jacobian(Vector const& point, Workspace & w, std::false_type) const {
+        w.jacobian(0,0) = r*(1 - 2*point[0]);
+        return w.jacobian;
+    }
+
+    void T(Vector & point, Workspace & w, std::true_type) const {
+        using namespace kernel;
+        mpfr_ptr complement = scratch(w.registers[0], precision(point[0]));
+        mpfr_ui_sub(complement, 1, src(point[0]), MPFR_RNDN);
+        mpfr_ptr x = widen(point[0], precision(point[0], r));
+        mpfr_mul(x, x, complement, MPFR_RNDN);
+        if (r_ui)
+            mpfr_mul_ui(x, x, r_ui, MPFR_RNDN);
+        else
+            mpfr_mul(x, x, src(r), MPFR_RNDN);
+    }
+
+    Matrix const& jacobian(Vector const& point, Workspace & w, std::true_type) const {
+        using namespace kernel;
+        mpfr_ptr j = scratch(w.jacobian(0,0), precision(point[0], r));
+        mpfr_mul_2ui(j, src(point[0]), 1, MPFR_RNDN);
+        mpfr_ui_sub(j, 1, j, MPFR_RNDN);
+        if (r_ui)
+            mpfr_mul_ui(j, j, r_ui, MPFR_RNDN);
+        else
+            mpfr_mul(j, j, src(r), MPFR_RNDN);
+        return w.jacobian;
+    }
 };
 
 
-class NCoupledHenon : public Map {
+template <typename Float, int Dim = Eigen::Dynamic>
+class NCoupledHenon : public Map<Float, Dim> {
+    static_assert(Dim == Eigen::Dynamic or Dim % 2 == 0, "the dimension of the coupled Henon map must be even");
+public:
+    typedef typename Map<Float, Dim>::Matrix Matrix;
+    typedef typename Map<Float, Dim>::Vector Vector;
+    typedef typename Map<Float, Dim>::Workspace Workspace;
+    using Map<Float, Dim>::T;
+    using Map<Float, Dim>::jacobian;
+    using Map<Float, Dim>::jvp;
+    using Map<Float, Dim>::step;
+    typedef typename Map<Float, Dim>::pair pair;
 protected:
     std::vector<Float> a;
     Float b;
     Float k;
 
 public:
-    NCoupledHenon(unsigned int D, Float min_a=3, Float max_a=5, Float b="0.3", Float k="0.4") : Map(D, format("ch%d", D)), k(k), b(b), a(D/2) {
+    NCoupledHenon(unsigned int D, Float min_a=3, Float max_a=5,
+                  Float b=aux::from_string<Float>("0.3"), Float k=aux::from_string<Float>("0.4")) :
+            Map<Float, Dim>(D, format("ch%d", D)), k(k), b(b), a(D/2) {
         if(D % 2 != 0) {
             std::cout << "NCoupled dimension must be multiple of 2";
             exit(1);
@@ -297,10 +1319,46 @@ public:
             a[i] = min_a + (max_a - min_a)*i/(D/2 - 1);
 
         for (unsigned int i = 0; i < D; i++)
-            boundary[i] = aux::pair(-4, 4);
+            this->boundary[i] = pair(-4, 4);
     }
 
-    void T(Vector & point) {
+    void T(Vector & point, Workspace & w) const {
+        T(point, w, kernel::fused<Float>());
+    }
+
+    Matrix const& jacobian(Vector const& point, Workspace & w) const {
+        return jacobian(point, w, kernel::fused<Float>());
+    }
+
+    //! O(D): each row of the jacobian has at most three non-zero entries.
+    void jvp(Vector const& point, Vector & tangent, Workspace & w) const {
+        jvp(point, tangent, w, kernel::fused<Float>());
+    }
+
+    bool has_exited(Vector const& point) const {
+        for(unsigned int i = 0; i < this->D; i++)
+            if (point[i] < -4 || point[i] > 4)
+                return true;
+        return false;
+    }
+
+    //! at most 3 entries per row: (i, i), (i, i + 1) and (i, i + D/2) for the x's, and (i + D/2, i) for the y's.
+    typename Map<Float, Dim>::Pattern sparsity() const {
+        unsigned int const D = this->D;
+        typename Map<Float, Dim>::Pattern pattern;
+        for (unsigned int i = 0; i < D/2; i++) {
+            pattern.push_back(std::make_pair(i, i));
+            if (D > 2)
+                pattern.push_back(std::make_pair(i, (i + 1)%(D/2)));
+            pattern.push_back(std::make_pair(i, i + D/2));
+            pattern.push_back(std::make_pair(i + D/2, i));
+        }
+        return pattern;
+    }
+
+protected:
+    void T(Vector & point, Workspace & w, std::false_type) const {
+        unsigned int const D = this->D;
         Float x0 = point[0];
 
         for (unsigned int i = 0; i < D/2; i++) {
@@ -318,32 +1376,246 @@ public:
         }
     }
 
-    Matrix const& jacobian(Vector const& point) {
+    Matrix const& jacobian(Vector const& point, Workspace & w, std::false_type) const {
+        unsigned int const D = this->D;
+        Matrix & _jacobian = w.jacobian;
+        set_jacobian_structure(w);
+
+        for (unsigned int i = 0; i < D/2; i++) {
+            _jacobian(i, i) = -2*point[i];
+            if (D > 2)
+                _jacobian(i, i) += k;
+        }
+        return _jacobian;
+    }
+
+    //! sets the entries of the jacobian of `w` that do not depend on the point (once per workspace).
+    void set_jacobian_structure(Workspace & w) const {
+        unsigned int const D = this->D;
+        Matrix & _jacobian = w.jacobian;
+        if (w.structure == this)
+            return;
         _jacobian.setZero();
+        for (unsigned int i = 0; i < D/2; i++) {
+            unsigned int iplus1 = (i + 1 + D/2)%(D/2);
+            _jacobian(i, i + D/2) = b;
+            if (D > 2)
+                _jacobian(i, iplus1) = -k;
+            _jacobian(i + D/2, i) = 1;
+        }
+        w.structure = this;
+    }
+
+    void jvp(Vector const& point, Vector & tangent, Workspace & w, std::false_type) const {
+        unsigned int const D = this->D;
+        Float v0 = tangent[0];
 
         for (unsigned int i = 0; i < D/2; i++) {
             unsigned int iplus1 = (i + 1 + D/2)%(D/2);
+            Float v = tangent[i];
+            Float const& u = (iplus1 == 0) ? v0 : tangent[iplus1];  // avoid retrieving already modified value
 
-            _jacobian(i, i) = -2*point[i];
-            _jacobian(i, i + D/2) = b;
+            tangent[i] = -2*point[i]*v + b*tangent[i + D/2];
+            if (D > 2)
+                tangent[i] += k*(v - u);
+            tangent[i + D/2] = v;
+        }
+    }
+
+    void T(Vector & point, Workspace & w, std::true_type) const {
+        using namespace kernel;
+        unsigned int const D = this->D;
+        Float & x0 = w.registers[0];
+        Float & x = w.registers[1];
+        mpfr_set(scratch(x0, precision(point[0])), src(point[0]), MPFR_RNDN);
+
+        for (unsigned int i = 0; i < D/2; i++) {
+            unsigned int iplus1 = (i + 1 + D/2)%(D/2);
+            Float const& y = point[i + D/2];
+            Float const& u = (iplus1 == 0) ? x0 : point[iplus1];  // avoid retrieving already modified value
+            mpfr_set(scratch(x, precision(point[i])), src(point[i]), MPFR_RNDN);
+
+            // point[i] = a[i] - x*x + b*y + k*(x - u)
+            mpfr_ptr t = scratch(w.registers[2], precision(x));
+            mpfr_sqr(t, src(x), MPFR_RNDN);
+            mpfr_ptr p = widen(point[i], (D > 2) ? precision(a[i], x, b, y, k, u) : precision(a[i], x, b, y));
+            mpfr_sub(p, src(a[i]), t, MPFR_RNDN);
+            mpfr_fma(p, src(b), src(y), p, MPFR_RNDN);
             if (D > 2) {
-                _jacobian(i, i) += k;
-                _jacobian(i, iplus1) += -k;
+                t = scratch(w.registers[2], precision(x, u));
+                mpfr_sub(t, src(x), src(u), MPFR_RNDN);
+                mpfr_fma(p, src(k), t, p, MPFR_RNDN);
             }
-            _jacobian(i + D/2, i) = 1;
+            point[i + D/2] = x;
+        }
+    }
+
+    Matrix const& jacobian(Vector const& point, Workspace & w, std::true_type) const {
+        using namespace kernel;
+        unsigned int const D = this->D;
+        Matrix & _jacobian = w.jacobian;
+        set_jacobian_structure(w);
+
+        for (unsigned int i = 0; i < D/2; i++) {
+            // -2*x + k
+            mpfr_ptr j = scratch(_jacobian(i, i), (D > 2) ? precision(point[i], k) : precision(point[i]));
+            mpfr_mul_2ui(j, src(point[i]), 1, MPFR_RNDN);
+            if (D > 2)
+                mpfr_sub(j, src(k), j, MPFR_RNDN);
+            else
+                mpfr_neg(j, j, MPFR_RNDN);
         }
         return _jacobian;
     }
 
-    bool has_exited(Vector const& point) {
-        for(unsigned int i = 0; i < D; i++)
-            if (point[i] < -4 || point[i] > 4)
-                return true;
-        return false;
+    void jvp(Vector const& point, Vector & tangent, Workspace & w, std::true_type) const {
+        using namespace kernel;
+        unsigned int const D = this->D;
+        Float & v0 = w.registers[0];
+        Float & v = w.registers[1];
+        mpfr_set(scratch(v0, precision(tangent[0])), src(tangent[0]), MPFR_RNDN);
+
+        for (unsigned int i = 0; i < D/2; i++) {
+            unsigned int iplus1 = (i + 1 + D/2)%(D/2);
+            Float const& y = tangent[i + D/2];
+            Float const& u = (iplus1 == 0) ? v0 : tangent[iplus1];  // avoid retrieving already modified value
+            mpfr_set(scratch(v, precision(tangent[i])), src(tangent[i]), MPFR_RNDN);
+
+            // tangent[i] = b*y - 2*x*v + k*(v - u)
+            mpfr_ptr t = scratch(w.registers[2], precision(point[i], v));
+            mpfr_mul(t, src(point[i]), src(v), MPFR_RNDN);
+            mpfr_mul_2ui(t, t, 1, MPFR_RNDN);
+            mpfr_ptr p = scratch(tangent[i], (D > 2) ? precision(b, y, point[i], v, k, u)
+                                                     : precision(b, y, point[i], v));
+            mpfr_fms(p, src(b), src(y), t, MPFR_RNDN);
+            if (D > 2) {
+                t = scratch(w.registers[2], precision(v, u));
+                mpfr_sub(t, src(v), src(u), MPFR_RNDN);
+                mpfr_fma(p, src(k), t, p, MPFR_RNDN);
+            }
+            tangent[i + D/2] = v;
+        }
+    }
+};
+
+
+//! The map `M` that cannot be subclassed, e.g. `map::generic::Final<map::generic::Tent<double> >` or
+//! `map::Final<map::Tent>`, with the constructors of `M`. `map::Static` calls it without virtual dispatch, and its
+//! `step` is the one of `M` if `M` overrides it, or else the `jacobian`, `jvp` and `T` of `M` called directly.
+template <typename M>
+class Final final : public M {
+public:
+    typedef typename M::Matrix Matrix;
+    typedef typename M::Vector Vector;
+    typedef typename M::Workspace Workspace;
+    using M::M;
+    using M::T;
+    using M::jacobian;
+    using M::jvp;
+    using M::step;
+
+    void step(Vector & point, Vector * tangent, Matrix * jac, Workspace & w) const {
+        step(point, tangent, jac, w, composed());
+    }
+
+private:
+    //! the class that declares the `step` of `M`.
+    template <typename C>
+    static C * declaring(void (C::*)(Vector &, Vector *, Matrix *, Workspace &) const);
+
+    //! whether `M` keeps the `step` of `Map`.
+    typedef std::is_same<decltype(declaring(&M::step)), Map<typename M::Scalar, M::Dimension> *> composed;
+
+    void step(Vector & point, Vector * tangent, Matrix * jac, Workspace & w, std::true_type) const {
+        this->compose(*this, point, tangent, jac, w);
+    }
+
+    void step(Vector & point, Vector * tangent, Matrix * jac, Workspace & w, std::false_type) const {
+        M::step(point, tangent, jac, w);
+    }
+};
+
+} // generic
+
+
+//! Calls the methods of a map of type `M` known at compile time. For a `final` map (e.g. `map::Final<map::Tent>`),
+//! the calls are not virtual and can be inlined. For any other map, including the abstract `map::Map` and the
+//! built-in maps, which can be subclassed, they are virtual, so that the overrides of a subclass are called. The
+//! observables call their map through it, with their own workspace.
+template <typename M, bool Erased = not aux::is_final<M>::value>
+struct Static {
+    static_assert(aux::is_final<M>::value, "the calls are only devirtualized for final maps");
+
+    typedef std::true_type devirtualized;
+
+    typedef typename M::Vector Vector;
+    typedef typename M::Matrix Matrix;
+    typedef typename M::Workspace Workspace;
+
+    static void T(M const& map, Vector & point, Workspace & w) {
+        map.M::T(point, w);
+    }
+
+    static Matrix const& jacobian(M const& map, Vector const& point, Workspace & w) {
+        return map.M::jacobian(point, w);
+    }
+
+    static void jvp(M const& map, Vector const& point, Vector & tangent, Workspace & w) {
+        map.M::jvp(point, tangent, w);
+    }
+
+    static void step(M const& map, Vector & point, Vector * tangent, Matrix * jac, Workspace & w) {
+        map.M::step(point, tangent, jac, w);
+    }
+
+    static bool has_exited(M const& map, Vector const& point) {
+        return map.M::has_exited(point);
+    }
+};
+
+template <typename M>
+struct Static<M, true> {
+    typedef std::false_type devirtualized;
+
+    typedef typename M::Vector Vector;
+    typedef typename M::Matrix Matrix;
+    typedef typename M::Workspace Workspace;
+
+    static void T(M const& map, Vector & point, Workspace & w) {
+        map.T(point, w);
+    }
+
+    static Matrix const& jacobian(M const& map, Vector const& point, Workspace & w) {
+        return map.jacobian(point, w);
+    }
+
+    static void jvp(M const& map, Vector const& point, Vector & tangent, Workspace & w) {
+        map.jvp(point, tangent, w);
+    }
+
+    static void step(M const& map, Vector & point, Vector * tangent, Matrix * jac, Workspace & w) {
+        map.step(point, tangent, jac, w);
+    }
+
+    static bool has_exited(M const& map, Vector const& point) {
+        return map.has_exited(point);
     }
 };
 
 
+typedef generic::Map<Float> Map;
+typedef generic::Manneville<Float> Manneville;
+typedef generic::Standard<Float> Standard;
+typedef generic::CoupledStandard<Float> CoupledStandard;
+typedef generic::Tent<Float> Tent;
+typedef generic::OpenTent<Float> OpenTent;
+typedef generic::Logistic<Float> Logistic;
+typedef generic::NCoupledHenon<Float> NCoupledHenon;
+template <typename Derived>
+using Automatic = generic::Automatic<Derived, Float>;
+template <typename M>
+using Final = generic::Final<M>;
+
 }; // map
 
 #endif /* defined(__chaospp__map__) */
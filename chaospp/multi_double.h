@@ -0,0 +1,623 @@
+#ifndef chaospp_multi_double_h
+#define chaospp_multi_double_h
+
+/*
+ * Double-double (106 bits) and quad-double (212 bits) scalars for the templated library, e.g.
+ * `map::generic::Standard<aux::dd_real>`. A number is the unevaluated sum of N doubles of decreasing magnitude
+ * (a floating-point expansion), and the arithmetic is built from error-free transformations of doubles: it does not
+ * allocate and is much faster than `mpfr::mpreal` at the same precision. The math functions are found by argument
+ * dependent lookup (also inside Eigen and std::complex).
+ *
+ * The results are accurate to a few units in the last place, but are not correctly rounded. They require IEEE double
+ * arithmetic rounding to nearest, without extended precision intermediates (x87) nor `-ffast-math`.
+ */
+
+#include <ostream>
+#include <limits>
+#include <cmath>
+#include <cassert>
+
+#include "auxiliar.h"
+
+namespace aux {
+
+//! error-free transformations of doubles.
+namespace eft {
+
+//! returns s = fl(a + b) and sets e such that s + e = a + b exactly.
+inline double two_sum(double a, double b, double & e) {
+    double s = a + b;
+    double bb = s - a;
+    e = (a - (s - bb)) + (b - bb);
+    return s;
+}
+
+//! the same as `two_sum`, when |a| >= |b|.
+inline double quick_two_sum(double a, double b, double & e) {
+    double s = a + b;
+    e = b - (s - a);
+    return s;
+}
+
+//! returns p = fl(a*b) and sets e such that p + e = a*b exactly.
+inline double two_prod(double a, double b, double & e) {
+    double p = a*b;
+    #ifdef FP_FAST_FMA
+    e = std::fma(a, b, -p);
+    #else
+    // Dekker's product, splitting the operands in 26 bits halves
+    const double split = 134217729.0;  // 2^27 + 1
+    double t = split*a;
+    double a_hi = t - (t - a);
+    double a_lo = a - a_hi;
+    t = split*b;
+    double b_hi = t - (t - b);
+    double b_lo = b - b_hi;
+    e = ((a_hi*b_hi - p) + a_hi*b_lo + a_lo*b_hi) + a_lo*b_lo;
+    #endif
+    return p;
+}
+
+//! sums the M terms `x`, of roughly decreasing magnitude, into the N non-overlapping terms `out`
+//! (VecSum followed by VecSumErrBranch, Joldes, Muller and Popescu 2015). Overwrites `x`.
+template <int N, int M>
+inline void renormalize(double (&x)[M], double (&out)[N]) {
+    for (int i = M - 1; i > 0; i--)
+        x[i - 1] = two_sum(x[i - 1], x[i], x[i]);
+
+    int j = 0;
+    double carry = x[0];
+    for (int i = 1; i < M; i++) {
+        if (j == N - 1) {
+            carry += x[i];
+            continue;
+        }
+        double e;
+        double s = quick_two_sum(carry, x[i], e);
+        if (e != 0) {
+            out[j++] = s;
+            carry = e;
+        }
+        else
+            carry = s;
+    }
+    out[j++] = carry;
+    for (; j < N; j++)
+        out[j] = 0;
+}
+
+}
+
+
+template <int N>
+class multi_double {
+    static_assert(N >= 2, "use double for a single component");
+
+    double x[N];  // non-overlapping and of decreasing magnitude.
+
+    void set(double value) {
+        x[0] = value;
+        for (int i = 1; i < N; i++)
+            x[i] = 0;
+    }
+
+    //! `high + low` normalized, when |high| >= |low| (the fast paths of N == 2).
+    multi_double(double high, double low, bool) {
+        double e;
+        x[0] = eft::quick_two_sum(high, low, e);
+        x[1] = e;
+        for (int i = 2; i < N; i++)
+            x[i] = 0;
+    }
+
+    //! the sum of two doubles, e.g. the high and low bits of an integer.
+    void set(double high, double low) {
+        double terms[2] = {high, low};
+        eft::renormalize(terms, x);
+    }
+
+    //! the N terms of `a*b`, without the products of order N (the products of order k are about 2^(-53*k) a*b).
+    static multi_double product(multi_double const& a, multi_double const& b) {
+        if (N == 2) {
+            double e;
+            double p = eft::two_prod(a.x[0], b.x[0], e);
+            e += a.x[0]*b.x[1] + a.x[1]*b.x[0];
+            return multi_double(p, e, true);
+        }
+        // the products of order k < N - 1 with their errors, and the terms of order N - 1 summed in a double.
+        double terms[(N - 1)*(N - 1) + 1];
+        double errors[N];
+        int m = 0, n_errors = 0;
+        for (int k = 0; k < N - 1; k++) {
+            for (int i = 0; i < n_errors; i++)
+                terms[m++] = errors[i];
+            n_errors = 0;
+            for (int i = 0; i <= k; i++)
+                terms[m++] = eft::two_prod(a.x[i], b.x[k - i], errors[n_errors++]);
+        }
+        double tail = 0;
+        for (int i = 0; i < n_errors; i++)
+            tail += errors[i];
+        for (int i = 0; i < N; i++)
+            tail += a.x[i]*b.x[N - 1 - i];
+        terms[m++] = tail;
+        multi_double result;
+        eft::renormalize(terms, result.x);
+        return result;
+    }
+
+    //! the terms of `a*b` with a double `b`.
+    static multi_double product(multi_double const& a, double b) {
+        if (N == 2) {
+            double e;
+            double p = eft::two_prod(a.x[0], b, e);
+            e += a.x[1]*b;
+            return multi_double(p, e, true);
+        }
+        double terms[2*N];
+        for (int i = 0; i < N; i++)
+            terms[2*i] = eft::two_prod(a.x[i], b, terms[2*i + 1]);
+        multi_double result;
+        eft::renormalize(terms, result.x);
+        return result;
+    }
+
+    static multi_double sum(multi_double const& a, multi_double const& b) {
+        if (N == 2) {
+            // the IEEE addition of the QD library (Hida, Li and Bailey)
+            double s_error, t_error;
+            double s = eft::two_sum(a.x[0], b.x[0], s_error);
+            double t = eft::two_sum(a.x[1], b.x[1], t_error);
+            s_error += t;
+            s = eft::quick_two_sum(s, s_error, s_error);
+            s_error += t_error;
+            return multi_double(s, s_error, true);
+        }
+        // merge the terms by decreasing magnitude
+        double terms[2*N];
+        int i = 0, j = 0;
+        for (int m = 0; m < 2*N; m++) {
+            if (j == N or (i < N and std::abs(a.x[i]) >= std::abs(b.x[j])))
+                terms[m] = a.x[i++];
+            else
+                terms[m] = b.x[j++];
+        }
+        multi_double result;
+        eft::renormalize(terms, result.x);
+        return result;
+    }
+
+    //! -1, 0 or 1 as `a` is smaller, equal or larger than `b`.
+    static int compare(multi_double const& a, multi_double const& b) {
+        for (int i = 0; i < N; i++) {
+            if (a.x[i] < b.x[i])
+                return -1;
+            if (a.x[i] > b.x[i])
+                return 1;
+        }
+        return 0;
+    }
+
+    //! the precision of the mpfr numbers used for the conversions and the constants.
+    static mpfr_prec_t mpfr_precision() {
+        return 53*N + 64;
+    }
+
+    //! precomputed values for the math functions.
+    struct Constants;
+
+    static Constants const& constants() {
+        static const Constants constants;
+        return constants;
+    }
+
+    //! the relative size of the last component.
+    static double tolerance() {
+        return std::ldexp(1., -53*N);
+    }
+
+    //! `x = k*2*pi + j*pi/2 + r` with |r| <= pi/4; returns `r` and sets the quadrant `j` (mod 4).
+    static multi_double reduce(multi_double const& x, int & j) {
+        Constants const& c = constants();
+        multi_double r = x;
+        double k = std::nearbyint(x.x[0]/c.two_pi.x[0]);
+        if (k != 0)
+            r -= product(c.two_pi, k);
+        double quadrant = std::nearbyint(r.x[0]/c.half_pi.x[0]);
+        if (quadrant != 0)
+            r -= product(c.half_pi, quadrant);
+        j = ((int) quadrant + 4) % 4;
+        return r;
+    }
+
+    //! the sine and cosine of `r` = k*pi/(4*table) + t, |r| <= pi/4, from the tables and the Taylor series of t.
+    static void sin_cos_octant(multi_double const& r, multi_double & sine, multi_double & cosine) {
+        Constants const& c = constants();
+        int k = (int) std::nearbyint(r.x[0]/c.step.x[0]);
+        multi_double t = k == 0 ? r : r - product(c.step, (double) k);
+        multi_double t2 = t*t;
+
+        // Horner's scheme of sin(t)/t and cos(t)
+        int m = c.sin_cos_terms;
+        multi_double sin_t = c.inverse_factorial[2*m - 1];
+        multi_double cos_t = c.inverse_factorial[2*m - 2];
+        for (int i = m - 2; i >= 0; i--) {
+            sin_t = c.inverse_factorial[2*i + 1] - t2*sin_t;
+            cos_t = c.inverse_factorial[2*i] - t2*cos_t;
+        }
+        sin_t *= t;
+        if (k == 0) {
+            sine = sin_t;
+            cosine = cos_t;
+            return;
+        }
+
+        multi_double const& sin_k = c.sin_table[std::abs(k)];
+        multi_double const& cos_k = c.cos_table[std::abs(k)];
+        if (k > 0) {
+            sine = sin_k*cos_t + cos_k*sin_t;
+            cosine = cos_k*cos_t - sin_k*sin_t;
+        }
+        else {
+            sine = cos_k*sin_t - sin_k*cos_t;
+            cosine = cos_k*cos_t + sin_k*sin_t;
+        }
+    }
+
+    static void sin_cos(multi_double const& x, multi_double & sine, multi_double & cosine) {
+        int quadrant;
+        multi_double r = reduce(x, quadrant);
+        multi_double s, c;
+        sin_cos_octant(r, s, c);
+        switch (quadrant) {
+            case 0: sine = s; cosine = c; break;
+            case 1: sine = c; cosine = -s; break;
+            case 2: sine = -s; cosine = -c; break;
+            case 3: sine = -c; cosine = s; break;
+        }
+    }
+
+    //! the number of Newton iterations that double the 53 bits of a double to N*53 bits.
+    static int newton_iterations() {
+        int iterations = 0;
+        for (int bits = 1; bits < N; bits *= 2)
+            iterations++;
+        return iterations;
+    }
+
+public:
+    multi_double() {set(0);}
+    multi_double(double value) {set(value);}
+    multi_double(int value) {set(value);}
+    multi_double(unsigned int value) {set(value);}
+    multi_double(long value) {set(value - (value & 0xffffffffL), value & 0xffffffffL);}
+    multi_double(unsigned long value) {set(value - (value & 0xffffffffUL), value & 0xffffffffUL);}
+    multi_double(long double value) {set((double) value, (double) (value - (long double) (double) value));}
+    multi_double(const char* value) : multi_double(mpfr::mpreal(value, mpfr_precision())) {}
+    explicit multi_double(mpfr::mpreal const& value) {
+        mpfr::mpreal rest(value);
+        for (int i = 0; i < N; i++) {
+            x[i] = rest.toDouble();
+            rest -= x[i];
+        }
+    }
+
+    //! the N components, of decreasing magnitude.
+    double const* raw() const {return x;}
+
+    explicit operator double() const {return x[0] + x[1];}
+    explicit operator long double() const {
+        long double value = 0;
+        for (int i = N - 1; i >= 0; i--)
+            value += x[i];
+        return value;
+    }
+    explicit operator long() const {
+        // truncates towards zero, also when x[0] is an integer and the other components are not.
+        long value = (long) x[0];
+        if (x[0] == (double) value) {
+            multi_double rest = *this - multi_double(value);
+            if (rest.x[0] < 0 and value > 0)
+                value--;
+            else if (rest.x[0] > 0 and value < 0)
+                value++;
+            else
+                value += (long) rest.x[0];
+        }
+        return value;
+    }
+    explicit operator int() const {return (int) (long) *this;}
+    explicit operator unsigned int() const {return (unsigned int) (long) *this;}
+    //! the exact value, in a precision large enough to represent it.
+    explicit operator mpfr::mpreal() const {
+        int exponent = std::ilogb(x[0]);
+        mpfr_prec_t precision = mpfr_precision();
+        for (int i = 1; i < N; i++)
+            if (x[i] != 0 and x[0] != 0)
+                precision = std::max<mpfr_prec_t>(precision, exponent - std::ilogb(x[i]) + 54);
+        mpfr::mpreal value(x[0], precision);
+        for (int i = 1; i < N; i++)
+            value += x[i];
+        return value;
+    }
+
+    multi_double & operator+=(multi_double const& other) {*this = sum(*this, other); return *this;}
+    multi_double & operator-=(multi_double const& other) {*this = sum(*this, -other); return *this;}
+    multi_double & operator*=(multi_double const& other) {*this = product(*this, other); return *this;}
+    multi_double & operator/=(multi_double const& other) {*this = *this/other; return *this;}
+    multi_double operator-() const {
+        multi_double result;
+        for (int i = 0; i < N; i++)
+            result.x[i] = -x[i];
+        return result;
+    }
+    multi_double operator+() const {return *this;}
+
+    friend multi_double operator+(multi_double const& a, multi_double const& b) {return sum(a, b);}
+    friend multi_double operator-(multi_double const& a, multi_double const& b) {return sum(a, -b);}
+    friend multi_double operator*(multi_double const& a, multi_double const& b) {return product(a, b);}
+    //! long division: N + 1 quotients of doubles.
+    friend multi_double operator/(multi_double const& a, multi_double const& b) {
+        double quotients[N + 1];
+        multi_double rest = a;
+        for (int i = 0; i <= N; i++) {
+            quotients[i] = rest.x[0]/b.x[0];
+            if (i < N)
+                rest -= product(b, quotients[i]);
+        }
+        multi_double result;
+        eft::renormalize(quotients, result.x);
+        return result;
+    }
+
+    friend bool operator==(multi_double const& a, multi_double const& b) {return compare(a, b) == 0;}
+    friend bool operator!=(multi_double const& a, multi_double const& b) {return compare(a, b) != 0;}
+    friend bool operator<(multi_double const& a, multi_double const& b) {return compare(a, b) < 0;}
+    friend bool operator>(multi_double const& a, multi_double const& b) {return compare(a, b) > 0;}
+    friend bool operator<=(multi_double const& a, multi_double const& b) {return compare(a, b) <= 0;}
+    friend bool operator>=(multi_double const& a, multi_double const& b) {return compare(a, b) >= 0;}
+
+    friend multi_double ldexp(multi_double const& x, int exponent) {
+        multi_double result;
+        for (int i = 0; i < N; i++)
+            result.x[i] = std::ldexp(x.x[i], exponent);
+        return result;
+    }
+
+    friend multi_double abs(multi_double const& x) {return x.x[0] < 0 ? -x : x;}
+    friend multi_double fabs(multi_double const& x) {return abs(x);}
+
+    friend multi_double floor(multi_double const& x) {
+        double terms[N] = {};
+        terms[0] = std::floor(x.x[0]);
+        // the following components matter only if the leading ones are integers
+        for (int i = 1; i < N and terms[i - 1] == x.x[i - 1]; i++)
+            terms[i] = std::floor(x.x[i]);
+        multi_double result;
+        eft::renormalize(terms, result.x);
+        return result;
+    }
+    friend multi_double ceil(multi_double const& x) {return -floor(-x);}
+
+    //! Newton iterations of 1/sqrt(x) from its double value.
+    friend multi_double sqrt(multi_double const& x) {
+        if (x.x[0] <= 0)
+            return x.x[0] == 0 ? multi_double() : multi_double(std::numeric_limits<double>::quiet_NaN());
+        multi_double y = 1/std::sqrt(x.x[0]);
+        for (int i = 0; i < newton_iterations(); i++)
+            y += ldexp(y*(1 - x*y*y), -1);
+        // a last iteration for the square root itself
+        multi_double s = x*y;
+        return s + ldexp(y*(x - s*s), -1);
+    }
+    friend multi_double hypot(multi_double const& x, multi_double const& y) {return sqrt(x*x + y*y);}
+
+    //! Taylor series of exp(r) - 1 with x = k*ln(2) + r and r divided by 2^squarings, squared back.
+    friend multi_double exp(multi_double const& x) {
+        if (x.x[0] > 709.79)
+            return std::numeric_limits<double>::infinity();
+        if (x.x[0] < -745.2)
+            return 0;
+        Constants const& c = constants();
+        double k = std::nearbyint(x.x[0]/c.ln2.x[0]);
+        multi_double r = ldexp(x - product(c.ln2, k), -Constants::squarings);
+
+        // Horner's scheme of (exp(r) - 1)/r
+        multi_double series = c.inverse_factorial[c.exp_degree];
+        for (int n = c.exp_degree - 1; n >= 1; n--)
+            series = c.inverse_factorial[n] + r*series;
+        series *= r;
+        for (int i = 0; i < Constants::squarings; i++)
+            series *= series + 2;  // (1 + s)^2 - 1
+        return ldexp(series + 1, (int) k);
+    }
+
+    //! Iterations of exp from the double logarithm, y += log(1 + d) with d = x*exp(-y) - 1 to the order d^2: their error
+    //! is cubic, since the error of the double logarithm is |log(x)|*2^-53, which a Newton iteration only squares.
+    friend multi_double log(multi_double const& x) {
+        if (x.x[0] <= 0)
+            return x.x[0] == 0 ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN();
+        multi_double y = std::log(x.x[0]);
+        for (int i = 0; i < newton_iterations(); i++) {
+            multi_double d = x*exp(-y) - 1;
+            y += d - ldexp(d*d, -1);
+        }
+        return y;
+    }
+    friend multi_double log2(multi_double const& x) {return log(x)/constants().ln2;}
+    friend multi_double log10(multi_double const& x) {return log(x)/constants().ln10;}
+
+    friend multi_double pow(multi_double const& x, multi_double const& y) {
+        if (y == floor(y) and std::abs(y.x[0]) < 1024) {
+            // repeated squaring
+            long n = (long) std::abs(y.x[0]);
+            multi_double result = 1, power = x;
+            for (; n > 0; n /= 2) {
+                if (n % 2 == 1)
+                    result *= power;
+                power *= power;
+            }
+            return y.x[0] < 0 ? 1/result : result;
+        }
+        if (x.x[0] == 0)
+            return y.x[0] > 0 ? 0 : std::numeric_limits<double>::infinity();
+        return exp(y*log(x));
+    }
+
+    friend multi_double sin(multi_double const& x) {
+        multi_double sine, cosine;
+        sin_cos(x, sine, cosine);
+        return sine;
+    }
+    friend multi_double cos(multi_double const& x) {
+        multi_double sine, cosine;
+        sin_cos(x, sine, cosine);
+        return cosine;
+    }
+    friend multi_double tan(multi_double const& x) {
+        multi_double sine, cosine;
+        sin_cos(x, sine, cosine);
+        return sine/cosine;
+    }
+
+    //! Newton iterations of sin and cos from the double angle.
+    friend multi_double atan2(multi_double const& y, multi_double const& x) {
+        if (x.x[0] == 0 and y.x[0] == 0)
+            return 0;
+        multi_double z = std::atan2(y.x[0], x.x[0]);
+        multi_double r = hypot(x, y);
+        multi_double xx = x/r, yy = y/r;
+        for (int i = 0; i < newton_iterations(); i++) {
+            multi_double sine, cosine;
+            sin_cos(z, sine, cosine);
+            if (std::abs(xx.x[0]) > std::abs(yy.x[0]))
+                z += (yy - sine)/cosine;
+            else
+                z -= (xx - cosine)/sine;
+        }
+        return z;
+    }
+    friend multi_double atan(multi_double const& x) {return atan2(x, multi_double(1));}
+
+    friend bool isnan(multi_double const& x) {return std::isnan(x.x[0]);}
+    friend bool isinf(multi_double const& x) {return std::isinf(x.x[0]);}
+    friend bool isfinite(multi_double const& x) {return std::isfinite(x.x[0]);}
+
+    friend std::ostream & operator<<(std::ostream & os, multi_double const& x) {
+        return os << (mpfr::mpreal) x;
+    }
+
+    friend struct Scalar<multi_double>;
+};
+
+//! the constants from MPFR, in the precision of the expansion.
+template <int N>
+struct multi_double<N>::Constants {
+    static const int terms = 8*N + 2;  // inverse factorials
+    static const int squarings = 2*N + 4;  // of exp
+    static const int table = 256;  // the sines and cosines of k*pi/(4*table), k = 0...table
+
+    multi_double<N> pi, two_pi, half_pi, step, ln2, ln10;
+    multi_double<N> inverse_factorial[terms];
+    multi_double<N> sin_table[table + 1], cos_table[table + 1];
+    int sin_cos_terms;  // the terms of the series of sin(t)/t and cos(t), |t| <= pi/(8*table)
+    int exp_degree;  // the degree of the series of (exp(r) - 1)/r, |r| <= ln(2)/2^(squarings + 1)
+
+    Constants() {
+        mpfr::mpreal mp_pi = mpfr::const_pi(mpfr_precision());
+        pi = multi_double<N>(mp_pi);
+        two_pi = multi_double<N>(2*mp_pi);
+        half_pi = multi_double<N>(mp_pi/2);
+        step = multi_double<N>(mp_pi/(4*table));
+        ln2 = multi_double<N>(log(mpfr::mpreal(2, mpfr_precision())));
+        ln10 = multi_double<N>(log(mpfr::mpreal(10, mpfr_precision())));
+
+        mpfr::mpreal factorial(1, mpfr_precision());
+        for (int n = 0; n < terms; n++) {
+            if (n > 1)
+                factorial *= n;
+            inverse_factorial[n] = multi_double<N>(1/factorial);
+        }
+        for (int k = 0; k <= table; k++) {
+            sin_table[k] = multi_double<N>(sin(mp_pi*k/(4*table)));
+            cos_table[k] = multi_double<N>(cos(mp_pi*k/(4*table)));
+        }
+
+        // the smallest degrees whose remainders are below the last component
+        double t = 3.1415926535897932/(8*table), term = 1;
+        for (sin_cos_terms = 1; term*t*t/((2*sin_cos_terms - 1)*2*sin_cos_terms) >= tolerance(); sin_cos_terms++)
+            term *= t*t/((2*sin_cos_terms - 1)*2*sin_cos_terms);
+        double r = std::ldexp(0.6931471805599453, -squarings - 1);
+        term = 1;
+        for (exp_degree = 1; term*r/(exp_degree + 1) >= tolerance(); exp_degree++)
+            term *= r/(exp_degree + 1);
+        assert(2*sin_cos_terms - 1 < terms and exp_degree < terms);
+    }
+};
+
+//! 106 bits, about 32 decimal digits.
+typedef multi_double<2> dd_real;
+//! 212 bits, about 64 decimal digits.
+typedef multi_double<4> qd_real;
+
+
+template <int N>
+struct Scalar<multi_double<N> > {
+    static multi_double<N> from_string(const char* value) {return multi_double<N>(value);}
+    static double to_double(multi_double<N> const& value) {return (double) value;}
+    static multi_double<N> const& pi() {return multi_double<N>::constants().pi;}
+    //! uses N doubles of 53 random bits.
+    static multi_double<N> urandom(Stream & stream) {
+        double terms[N];
+        for (int i = 0; i < N; i++)
+            terms[i] = std::ldexp((double) (stream() >> 11), -53*(i + 1));
+        multi_double<N> result;
+        eft::renormalize(terms, result.x);
+        return result;
+    }
+    static multi_double<N> nrandom(Stream & stream) {
+        // Box-Muller transform
+        multi_double<N> u1 = 1 - urandom(stream);
+        multi_double<N> u2 = urandom(stream);
+        return sqrt(-2*log(u1))*cos(2*pi()*u2);
+    }
+    static unsigned int digits() {return 53*N;}
+};
+
+}
+
+
+namespace std {
+
+template <int N>
+class numeric_limits<aux::multi_double<N> > {
+public:
+    static const bool is_specialized = true;
+    static const bool is_signed = true;
+    static const bool is_integer = false;
+    static const bool is_exact = false;
+    static const bool has_infinity = true;
+    static const bool has_quiet_NaN = true;
+    static const bool is_iec559 = false;
+    static const bool is_bounded = true;
+    static const int radix = 2;
+    static const int digits = 53*N;
+    static const int digits10 = (digits - 1)*30103/100000;
+    static const int max_digits10 = digits*30103/100000 + 2;
+    // so that the last component is normal
+    static const int min_exponent = numeric_limits<double>::min_exponent + 53*(N - 1);
+    static const int max_exponent = numeric_limits<double>::max_exponent;
+
+    static aux::multi_double<N> min() {return std::ldexp(1., min_exponent - 1);}
+    static aux::multi_double<N> max() {return numeric_limits<double>::max();}
+    static aux::multi_double<N> lowest() {return -max();}
+    static aux::multi_double<N> epsilon() {return std::ldexp(1., 1 - digits);}
+    static aux::multi_double<N> round_error() {return 0.5;}
+    static aux::multi_double<N> infinity() {return numeric_limits<double>::infinity();}
+    static aux::multi_double<N> quiet_NaN() {return numeric_limits<double>::quiet_NaN();}
+    static aux::multi_double<N> denorm_min() {return min();}
+};
+
+}
+
+#endif
@@ -3,43 +3,186 @@
 
 #include "auxiliar.h"
 #include "map.h"
+#include "arena.h"
 #include <Eigen/Eigenvalues>
+#include <algorithm>
+#include <stdexcept>
 
 
+//! the rows of the non-zero entries of each column of the jacobians of `map` (`Map::sparsity`), or empty if they are
+//! dense or if at least half of their entries can be non-zero.
+template <typename Float, int Dim>
+std::vector<std::vector<unsigned int> > sparse_columns(map::generic::Map<Float, Dim> const& map) {
+    typename map::generic::Map<Float, Dim>::Pattern pattern = map.sparsity();
+    std::vector<std::vector<unsigned int> > columns;
+    if (not pattern.empty() and 2*pattern.size() < map.D*map.D) {
+        columns.resize(map.D);
+        for (unsigned int e = 0; e < pattern.size(); e++)
+            columns[pattern[e].second].push_back(pattern[e].first);
+    }
+    return columns;
+}
+
+
+template <typename Float, int Dim = Eigen::Dynamic>
 class ComputeMatrix {
 public:
+    typedef Eigen::Matrix<Float, Dim, Dim> Matrix;
+    typedef Eigen::Matrix<Float, Dim, 1> Vector;
+
     Matrix jacobian;  //! The final jacobian matrix.
 
-    ComputeMatrix(map::Map & map) : jacobian(Matrix::Identity(map.D, map.D)) {}
+    //! When `map` declares the sparsity of its jacobian (`Map::sparsity`) and less than half of its entries can be
+    //! non-zero, each step is a sparse-times-dense product.
+    ComputeMatrix(map::generic::Map<Float, Dim> const& map) : jacobian(Matrix::Identity(map.D, map.D)),
+                                                               has_stretch(false), has_eigenvector(false),
+                                                               columns(sparse_columns(map)), product(map.D, map.D) {}
+
+    template <typename Map>
+    void evolve(Map const& map, Vector & point, typename Map::Workspace & w) {
+        multiply(map::Static<Map>::jacobian(map, point, w));
+    }
 
-    void evolve(map::Map & map, Vector & point) {
-        jacobian *= map.jacobian(point);
+    //! evolves `point` one step and multiplies `jacobian` by the jacobian of the step.
+    //! `map` can be of a concrete map type, called without virtual dispatch (see `map::Static`).
+    template <typename Map>
+    void step(Map const& map, Vector & point, typename Map::Workspace & w) {
+        map::Static<Map>::step(map, point, nullptr, &w.jacobian, w);
+        multiply(w.jacobian);
     }
 
+    //! the largest absolute value of the eigenvalues of `jacobian`. It is computed when first read after `finalise`.
     Float stretch() const {
-        return abs(es.eigenvalues()[i_max]);
+        decompose(false);
+        return _stretch;
     }
 
+    //! the real part of the eigenvector of the eigenvalue of `stretch`.
     Vector eigenvector() const {
-        Vector vector(jacobian.rows());
-        for (unsigned int i = 0; i < jacobian.rows(); i++)
-            vector[i] = es.eigenvectors().col(i_max)[i];
-        return vector;
+        decompose(true);
+        return _eigenvector;
     }
 
 protected:
-    unsigned int i_max;
-    Eigen::EigenSolver<Matrix> es;
+    // the decomposition of `jacobian`, computed lazily (see `decompose`).
+    mutable bool has_stretch, has_eigenvector;
+    mutable Float _stretch;
+    mutable Vector _eigenvector;
+    mutable Eigen::EigenSolver<Matrix> es;
+    Matrix step_jacobian;  // the jacobian of the last step in another precision (see `ComputeFastMatrix`).
+    std::vector<std::vector<unsigned int> > columns;  // the rows of the non-zero entries of each column of the jacobians.
+    Matrix product;  // workspace of the products.
 
-    void finalise(map::Map & map) {
-        es.compute(jacobian);
+    //! jacobian *= `step`, column by column over the non-zero entries of `step` when they are known.
+    void multiply(Matrix const& step) {
+        if (columns.empty()) {
+            product.noalias() = jacobian*step;
+            jacobian.swap(product);
+            return;
+        }
+        for (unsigned int j = 0; j < columns.size(); j++) {
+            std::vector<unsigned int> const& rows = columns[j];
+            if (rows.empty()) {
+                product.col(j).setZero();
+                continue;
+            }
+            product.col(j) = jacobian.col(rows[0])*step(rows[0], j);
+            for (unsigned int e = 1; e < rows.size(); e++)
+                product.col(j) += jacobian.col(rows[e])*step(rows[e], j);
+        }
+        jacobian.swap(product);
+    }
+
+    //! for the jacobians of the steps of a map in another precision (see `ComputeFastMatrix`).
+    ComputeMatrix(unsigned int D, std::vector<std::vector<unsigned int> > const& columns) :
+            jacobian(Matrix::Identity(D, D)), has_stretch(false), has_eigenvector(false),
+            step_jacobian(Matrix::Zero(D, D)), columns(columns), product(D, D) {}
+
+    void finalise(map::generic::Map<Float, Dim> const&) {
+        finalise();
+    }
+
+    //! marks `jacobian` as final: the decomposition is computed when `stretch` or `eigenvector` are read.
+    void finalise() {
+        has_stretch = has_eigenvector = false;
+    }
 
-        Float maximum(-1000);
-        for (unsigned int i = 0; i < map.D; i++)
-            if (abs(es.eigenvalues()[i]) > maximum) {
+    //! the eigenvalue of largest absolute value (and its eigenvector, if `vector`): in closed form for D = 1 and
+    //! D = 2 (except the eigenvector of a pair of complex eigenvalues), and with `Eigen::EigenSolver` otherwise.
+    void decompose(bool vector) const {
+        using std::abs;
+        if (has_stretch and (has_eigenvector or not vector))
+            return;
+        unsigned int const D = jacobian.rows();
+        if (D == 1) {
+            _stretch = abs(jacobian(0, 0));
+            _eigenvector.setOnes(1);
+            has_stretch = has_eigenvector = true;
+            return;
+        }
+        if (D == 2 and decompose2x2())
+            return;
+        if (D == 2 and not vector)
+            return;
+
+        es.compute(jacobian);
+        unsigned int i_max = 0;
+        for (unsigned int i = 1; i < D; i++)
+            if (abs(es.eigenvalues()[i]) > abs(es.eigenvalues()[i_max]))
                 i_max = i;
-                maximum = abs(es.eigenvalues()[i]);
-            }
+        _stretch = abs(es.eigenvalues()[i_max]);
+        _eigenvector.resize(D);
+        for (unsigned int i = 0; i < D; i++)
+            _eigenvector[i] = es.eigenvectors().col(i_max)[i].real();
+        has_stretch = has_eigenvector = true;
+    }
+
+    //! the roots of the characteristic polynomial of the 2x2 `jacobian`, scaled by its largest entry so that they do
+    //! not overflow. Returns false (with the stretch only) if the eigenvalues are a complex pair.
+    bool decompose2x2() const {
+        using std::abs;
+        using std::sqrt;
+        Float scale = jacobian.cwiseAbs().maxCoeff();
+        if (scale == 0) {
+            _stretch = 0;
+            _eigenvector.setZero(2);
+            _eigenvector[0] = 1;
+            has_stretch = has_eigenvector = true;
+            return true;
+        }
+        Float a = jacobian(0, 0)/scale, b = jacobian(0, 1)/scale, c = jacobian(1, 0)/scale, d = jacobian(1, 1)/scale;
+        Float half_trace = (a + d)/2;
+        Float determinant = a*d - b*c;
+        Float discriminant = half_trace*half_trace - determinant;
+        has_stretch = true;
+        if (discriminant < 0) {
+            _stretch = sqrt(determinant)*scale;
+            return false;
+        }
+        // the root of largest absolute value, without cancellation.
+        Float lambda = half_trace >= 0 ? half_trace + sqrt(discriminant) : half_trace - sqrt(discriminant);
+        _stretch = abs(lambda)*scale;
+
+        // the largest of the two solutions of (J - lambda) v = 0.
+        _eigenvector.resize(2);
+        Float x1 = b, y1 = lambda - a, x2 = lambda - d, y2 = c;
+        if (x1*x1 + y1*y1 >= x2*x2 + y2*y2) {
+            _eigenvector[0] = x1;
+            _eigenvector[1] = y1;
+        }
+        else {
+            _eigenvector[0] = x2;
+            _eigenvector[1] = y2;
+        }
+        Float norm = sqrt(_eigenvector[0]*_eigenvector[0] + _eigenvector[1]*_eigenvector[1]);
+        if (norm == 0) {  // a multiple of the identity
+            _eigenvector[0] = 1;
+            _eigenvector[1] = 0;
+        }
+        else
+            _eigenvector /= norm;
+        has_eigenvector = true;
+        return true;
     }
 
     void initialize() {
@@ -48,8 +191,255 @@ protected:
 
     ComputeMatrix & operator=(ComputeMatrix const& other) {
         this->jacobian = other.jacobian;
-        this->i_max = other.i_max;
-        this->es = other.es;
+        this->has_stretch = other.has_stretch;
+        this->has_eigenvector = other.has_eigenvector;
+        this->_stretch = other._stretch;
+        this->_eigenvector = other._eigenvector;
+        if (this->columns != other.columns) {
+            this->columns = other.columns;
+            this->product = other.product;
+        }
+        return *this;
+    }
+};
+
+
+//! Evolves an orthonormal basis of the tangent space, re-orthonormalised with a QR decomposition every `period` steps.
+//! The logs of the diagonal of R are accumulated in double, so the stretches never overflow and the jacobian of the
+//! trajectory is never formed: the precision of `Float` only needs to describe the state.
+//! The i-th log-stretch is the growth of the volume spanned by the first i + 1 vectors of the basis over the one of
+//! the first i; for long times they converge to the Lyapunov spectrum, in decreasing order.
+//! A longer `period` saves decompositions, but the condition number of the basis grows as exp((l_1 - l_D) period),
+//! which bounds the accuracy of the smaller exponents.
+template <typename Float, int Dim = Eigen::Dynamic>
+class ComputeSpectrum {
+public:
+    typedef Eigen::Matrix<Float, Dim, Dim> Matrix;
+    typedef Eigen::Matrix<Float, Dim, 1> Vector;
+
+    unsigned int period;  //! The number of steps between re-orthonormalisations.
+
+    ComputeSpectrum(map::generic::Map<Float, Dim> const& map, unsigned int period=1) :
+            period(period), basis(Matrix::Identity(map.D, map.D)), product(map.D, map.D), qr(map.D, map.D),
+            log_stretches(map.D, 0), steps(0) {}
+
+    //! evolves `point` one step and the basis with the jacobian of the step.
+    //! `map` can be of a concrete map type, called without virtual dispatch (see `map::Static`).
+    template <typename Map>
+    void step(Map const& map, Vector & point, typename Map::Workspace & w) {
+        map::Static<Map>::step(map, point, nullptr, &w.jacobian, w);
+        product.noalias() = w.jacobian*basis;
+        basis.swap(product);
+        if (++steps % period == 0)
+            orthonormalise();
+    }
+
+    //! the log of the stretch of the first vector of the basis (the maximal for long times).
+    double log_stretch() const {
+        return log_stretches[0];
+    }
+
+    Float stretch() const {
+        return exp(Float(log_stretch()));
+    }
+
+    //! the log-stretches divided by `time`: the finite-time Lyapunov spectrum.
+    std::vector<double> spectrum(unsigned int time) const {
+        std::vector<double> result(log_stretches);
+        for (unsigned int i = 0; i < result.size(); i++)
+            result[i] /= time;
+        return result;
+    }
+
+protected:
+    Matrix basis;  // the orthonormal basis, evolved since the last orthonormalisation.
+    Matrix product;  // workspace of the products.
+    Eigen::HouseholderQR<Matrix> qr;
+    std::vector<double> log_stretches;
+    unsigned int steps;  // number of steps since `initialize`.
+
+    void orthonormalise() {
+        using std::abs;
+        using std::log;
+        qr.compute(basis);
+        for (unsigned int i = 0; i < log_stretches.size(); i++)
+            log_stretches[i] += aux::to_double(log(abs(qr.matrixQR()(i, i))));
+        basis = qr.householderQ();
+    }
+
+    //! accounts for the steps since the last orthonormalisation.
+    void finalise() {
+        if (steps % period != 0)
+            orthonormalise();
+    }
+
+    void initialize() {
+        basis = Matrix::Identity(basis.rows(), basis.rows());
+        std::fill(log_stretches.begin(), log_stretches.end(), 0);
+        steps = 0;
+    }
+
+    ComputeSpectrum & operator=(ComputeSpectrum const& other) {
+        this->period = other.period;
+        this->basis = other.basis;
+        this->log_stretches = other.log_stretches;
+        this->steps = other.steps;
+        return *this;
+    }
+};
+
+
+//! The tangent space of a trajectory of `Float` states evolved in a hardware precision `Fast` (`ComputeFastVector`,
+//! `ComputeFastMatrix`): the jacobian of each step is computed in `Float` and converted to `Fast` once (only its
+//! non-zero entries, see `Map::sparsity`), so the tangent arithmetic does not depend on the precision of the state.
+//! The tangent is renormalised by powers of 2, so the stretch is kept in log-scale and never overflows.
+//! It only feeds the stretch (and the proposal scales that depend on it), which `Fast` describes with a relative
+//! accuracy: the tangent converges to the most expanding direction, so the rounding errors do not accumulate in it.
+namespace mixed {
+
+//! `fast` = `jacobian`, only on the non-zero entries of `columns` (see `sparse_columns`) unless it is empty.
+template <typename Float, typename Fast, int Dim>
+void convert(Eigen::Matrix<Float, Dim, Dim> const& jacobian, Eigen::Matrix<Fast, Dim, Dim> & fast,
+             std::vector<std::vector<unsigned int> > const& columns) {
+    if (columns.empty()) {
+        for (unsigned int j = 0; j < jacobian.cols(); j++)
+            for (unsigned int i = 0; i < jacobian.rows(); i++)
+                fast(i, j) = static_cast<Fast>(jacobian(i, j));
+        return;
+    }
+    for (unsigned int j = 0; j < columns.size(); j++)
+        for (unsigned int e = 0; e < columns[j].size(); e++)
+            fast(columns[j][e], j) = static_cast<Fast>(jacobian(columns[j][e], j));
+}
+
+//! `fast` = `jacobian`. When its entries overflow `Fast` (e.g. along a trajectory that diverges), they are divided
+//! by a power of 2, whose log is added to `log_scale`.
+template <typename Float, typename Fast, int Dim>
+void convert(Eigen::Matrix<Float, Dim, Dim> const& jacobian, Eigen::Matrix<Fast, Dim, Dim> & fast,
+             std::vector<std::vector<unsigned int> > const& columns, double & log_scale) {
+    using std::abs;
+    using std::log2;
+    using std::pow;
+    convert(jacobian, fast, columns);
+    if (std::isfinite(static_cast<double>(fast.cwiseAbs().maxCoeff())))
+        return;
+    int exponent = (int) std::ceil(aux::to_double(log2(jacobian.cwiseAbs().maxCoeff())));
+    Eigen::Matrix<Float, Dim, Dim> scaled = jacobian*pow(Float(2), Float(-exponent));
+    convert(scaled, fast, columns);
+    log_scale += exponent*0.6931471805599453;
+}
+
+//! divides `tangent` by a power of 2 when its largest entry leaves [2^-64, 2^64], and adds the log of the power to
+//! `log_scale`. The division is exact.
+template <typename Derived>
+void renormalise(Eigen::MatrixBase<Derived> & tangent, double & log_scale) {
+    typedef typename Derived::Scalar Fast;
+    static const Fast lower = std::ldexp(1., -64), upper = std::ldexp(1., 64);
+    Fast maximum = tangent.cwiseAbs().maxCoeff();
+    if (maximum < lower or maximum > upper) {
+        int exponent;
+        std::frexp(static_cast<double>(maximum), &exponent);
+        tangent *= std::ldexp(Fast(1), -exponent);
+        log_scale += exponent*0.6931471805599453;
+    }
+}
+
+}
+
+
+//! The tangent vector of a trajectory of `Float` states, evolved in `Fast` (see `mixed`).
+template <typename Float, int Dim = Eigen::Dynamic, typename Fast = double>
+class ComputeFastVector {
+public:
+    typedef Eigen::Matrix<Float, Dim, Dim> Matrix;
+    typedef Eigen::Matrix<Float, Dim, 1> Vector;
+    typedef Eigen::Matrix<Fast, Dim, Dim> FastMatrix;
+    typedef Eigen::Matrix<Fast, Dim, 1> FastVector;
+
+    FastVector tangent;  //! The tangent vector, divided by exp(`log_scale`).
+    double log_scale;
+
+    ComputeFastVector(map::generic::Map<Float, Dim> const& map) :
+            tangent(FastVector::Unit(map.D, 0)), log_scale(0),
+            fast_jacobian(FastMatrix::Zero(map.D, map.D)), product(map.D), columns(sparse_columns(map)) {}
+
+    //! evolves `point` one step and `tangent` with the jacobian of the step.
+    //! `map` can be of a concrete map type, called without virtual dispatch (see `map::Static`).
+    template <typename Map>
+    void step(Map const& map, Vector & point, typename Map::Workspace & w) {
+        map::Static<Map>::step(map, point, nullptr, &w.jacobian, w);
+        mixed::convert(w.jacobian, fast_jacobian, columns, log_scale);
+        product.noalias() = fast_jacobian*tangent;
+        tangent.swap(product);
+        mixed::renormalise(tangent, log_scale);
+    }
+
+    double log_stretch() const {
+        return log_scale + std::log(static_cast<double>(aux::get_norm(tangent)));
+    }
+
+    Float stretch() const {
+        return exp(Float(log_stretch()));
+    }
+
+protected:
+    FastMatrix fast_jacobian;  // the jacobian of the last step converted to `Fast`.
+    FastVector product;  // workspace of the products.
+    std::vector<std::vector<unsigned int> > columns;  // the non-zero entries of the jacobians (if sparse).
+
+    //! a random tangent vector drawn from `stream`.
+    void initialize(aux::Stream & stream) {
+        aux::unitaryVector(tangent, stream);
+        log_scale = 0;
+    }
+
+    ComputeFastVector & operator=(ComputeFastVector const& other) {
+        this->tangent = other.tangent;
+        this->log_scale = other.log_scale;
+        return *this;
+    }
+};
+
+
+//! The jacobian of a trajectory of `Float` states, multiplied in `Fast` (see `mixed`). `jacobian` is the jacobian
+//! divided by exp(`log_scale`).
+template <typename Float, int Dim = Eigen::Dynamic, typename Fast = double>
+class ComputeFastMatrix : public ComputeMatrix<Fast, Dim> {
+public:
+    typedef Eigen::Matrix<Float, Dim, Dim> Matrix;
+    typedef Eigen::Matrix<Float, Dim, 1> Vector;
+
+    double log_scale;
+
+    ComputeFastMatrix(map::generic::Map<Float, Dim> const& map) :
+            ComputeMatrix<Fast, Dim>(map.D, sparse_columns(map)), log_scale(0) {}
+
+    template <typename Map>
+    void step(Map const& map, Vector & point, typename Map::Workspace & w) {
+        map::Static<Map>::step(map, point, nullptr, &w.jacobian, w);
+        mixed::convert(w.jacobian, this->step_jacobian, this->columns, log_scale);
+        this->multiply(this->step_jacobian);
+        mixed::renormalise(this->jacobian, log_scale);
+    }
+
+    double log_stretch() const {
+        return log_scale + std::log(static_cast<double>(ComputeMatrix<Fast, Dim>::stretch()));
+    }
+
+    Float stretch() const {
+        return exp(Float(log_stretch()));
+    }
+
+protected:
+
+    void initialize() {
+        ComputeMatrix<Fast, Dim>::initialize();
+        log_scale = 0;
+    }
+
+    ComputeFastMatrix & operator=(ComputeFastMatrix const& other) {
+        ComputeMatrix<Fast, Dim>::operator=(other);
+        this->log_scale = other.log_scale;
         return *this;
     }
 };
@@ -59,12 +449,24 @@ namespace observable {
 
 //! The outcome of the evolution of the system. This class calls map iterations and stores relevant intermediate results.
 //! It contains a single attribute, `state`, the initial state.
-template <typename T>
+//! `Dim` is the dimension of the state at compile time (see `map::generic::Map`).
+template <typename T, typename Float = mpfr::mpreal, int Dim = Eigen::Dynamic>
 class Observable {
 public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef Float Scalar;
+    static const int Dimension = Dim;
+    typedef Eigen::Matrix<Float, Dim, Dim> Matrix;
+    typedef Eigen::Matrix<Float, Dim, 1> Vector;
+
     Vector state; // the initial state. Set in "observe".
     typedef T Type;
 
+    Observable() : _stream(nullptr) {}
+
+    Observable(Observable const& other) : state(other.state), _point(other._point), _stream(nullptr) {}
+
     //! The initial state of the map that fully characterizes the system.
     virtual void observe(Vector const& state) {
         this->state = state;
@@ -76,11 +478,50 @@ public:
     }
 
     virtual T observable() const = 0;
+
+    //! the values from `upper` on are out of the range of interest (e.g. of a `SamplingHistogram`): the observations
+    //! can stop as soon as their value is known to be at least `upper`, and then have a value of at least `upper`.
+    //! Observables whose value is not monotone along the trajectory ignore it (the default).
+    virtual void set_upper_bound(T const& upper) {}
+
+    //! an upper bound of the values of the observations (e.g. the `max_time` of an escape time), or the largest `T`
+    //! (the default).
+    virtual T max_value() const {
+        return std::numeric_limits<T>::max();
+    }
+
+    //! the observations draw their random numbers (e.g. their tangent vectors) from `stream`, the stream of the chain
+    //! or search that owns the observable, instead of the one of the calling thread. It is not copied with the
+    //! observable.
+    void set_stream(aux::Stream & stream) {
+        _stream = &stream;
+    }
+
+    //! the stream of the random numbers of the observations (see `set_stream`).
+    aux::Stream & random_stream() const {
+        return _stream == nullptr ? aux::Stream::local() : *_stream;
+    }
+
+protected:
+    Vector _point;  // stores the point along the trajectory in `observe` to avoid repeating allocations.
+    aux::Stream * _stream;
 };
 
 
+//! The observables templated on the scalar type `Float` of the map.
+//! The arbitrary precision versions are available directly in `observable`, e.g. `observable::EscapeTime`.
+namespace generic {
+
 //! the escape time of the state for open systems.
-class EscapeTime : public Observable<unsigned int> {
+//! `Map` is the type of the map: the default, `map::generic::Map`, accepts any map through virtual calls; a concrete
+//! map (e.g. `map::generic::Tent<double>`) is called without virtual dispatch (see `map::Static`).
+template <typename Float, int Dim = Eigen::Dynamic, typename Map = map::generic::Map<Float, Dim> >
+class EscapeTime : public Observable<unsigned int, Float, Dim> {
+    static_assert(std::is_base_of<map::generic::Map<Float, Dim>, Map>::value, "Map must be a map::generic::Map<Float, Dim>");
+public:
+    typedef typename Observable<unsigned int, Float, Dim>::Matrix Matrix;
+    typedef typename Observable<unsigned int, Float, Dim>::Vector Vector;
+    typedef Map MapType;
 protected:
     virtual void finalize() {}
 
@@ -88,37 +529,59 @@ protected:
         escape_time = 0;
     }
 
+    //! the escape time from which the state is out of range (see `set_upper_bound`).
+    unsigned int upper_bound;
+
+    //! the number of steps after which the observation stops if the state has not exited.
+    unsigned int horizon() const {
+        return std::min(max_time, upper_bound);
+    }
+
 public:
-    map::Map & map;
+    Map const& map;
+    map::generic::OwnedWorkspace<Float, Dim> workspace;  // the scratch storage of the evaluations of `map`.
 
     //! The escape time of `state`. It is computed on "observe"
     unsigned int escape_time;
     unsigned int max_time;
 
-    EscapeTime(map::Map & map, unsigned int max_time=std::numeric_limits<unsigned int>::max()) : map(map), max_time(max_time), escape_time(0) {}
+    EscapeTime(Map const& map, unsigned int max_time=std::numeric_limits<unsigned int>::max()) :
+            upper_bound(std::numeric_limits<unsigned int>::max()), map(map), workspace(map), escape_time(0), max_time(max_time) {}
+
+    //! the escape time is monotone along the trajectory: the observations stop after `upper` steps.
+    void set_upper_bound(unsigned int const& upper) {
+        upper_bound = upper;
+    }
+
+    unsigned int max_value() const {
+        return std::max(1u, max_time);
+    }
 
-    virtual bool has_exited(Vector const& point) const {return map.has_exited(point);}
+    virtual bool has_exited(Vector const& point) const {return map::Static<Map>::has_exited(map, point);}
 
     //! Escape time function
     void observe(Vector const& state) {
-        Observable::observe(state);
+        aux::Arena::Step step;
+        Observable<unsigned int, Float, Dim>::observe(state);
         initialize();
 
-        Vector point = state;
+        Vector & point = this->_point;
+        point = state;
+        unsigned int horizon = this->horizon();
         evolve(point);
-        while (not has_exited(point) and escape_time < max_time) {
+        while (not has_exited(point) and escape_time < horizon) {
             evolve(point);
         }
         finalize();
     }
 
     virtual void evolve(Vector & point) {
-        map.T(point);
+        map::Static<Map>::T(map, point, workspace);
         escape_time++;
     }
 
     EscapeTime & operator=(EscapeTime const& other) {
-        Observable::operator=(other);
+        Observable<unsigned int, Float, Dim>::operator=(other);
         this->escape_time = other.escape_time;
         this->max_time = other.max_time;
         return *this;
@@ -129,28 +592,31 @@ public:
     }
 };
 
-const Vector UNDEFINED_VECTOR;
 
 //! Computes the escape time of the state and its FT Lyapunov exponent
 //! It is constructed from a map, an optional max_time (default: infinite), and an optional tangent vector (default: random vector).
 //! It evolves the system and tangent vector in time until the state escapes or up to max_time.
-class EscapeWithVector : public EscapeTime {
+template <typename Float, int Dim = Eigen::Dynamic, typename Map = map::generic::Map<Float, Dim> >
+class EscapeWithVector : public EscapeTime<Float, Dim, Map> {
+public:
+    typedef typename EscapeTime<Float, Dim, Map>::Matrix Matrix;
+    typedef typename EscapeTime<Float, Dim, Map>::Vector Vector;
 protected:
     //! The tangent vector after `escape_time` steps.
     Vector tangent;
 
     virtual void initialize() {
-        EscapeTime::initialize();
-        tangent = aux::unitaryVector(map.D);
+        EscapeTime<Float, Dim, Map>::initialize();
+        aux::unitaryVector(tangent, this->random_stream());
     }
 
 public:
 
-    EscapeWithVector(map::Map & map, unsigned int max_time=std::numeric_limits<unsigned int>::max(), Vector const& tangent=UNDEFINED_VECTOR) :
-            EscapeTime(map, max_time), tangent(tangent) {
-        if (this->tangent == UNDEFINED_VECTOR)
-            this->tangent = aux::unitaryVector(map.D);
-    }
+    EscapeWithVector(Map const& map, unsigned int max_time=std::numeric_limits<unsigned int>::max()) :
+            EscapeTime<Float, Dim, Map>(map, max_time), tangent(Vector::Unit(map.D, 0)) {}
+
+    EscapeWithVector(Map const& map, unsigned int max_time, Vector const& tangent) :
+            EscapeTime<Float, Dim, Map>(map, max_time), tangent(tangent) {}
 
     virtual Float stretch() const {
         return aux::get_norm(tangent);
@@ -160,80 +626,178 @@ public:
         return ((double) log(stretch()))/this->escape_time;
     }
 
+    //! the tangent vector is evolved with the jacobian-vector product of the map (`Map::jvp`).
     virtual void evolve(Vector & point) {
-        map.dT(point, tangent);
-        EscapeTime::evolve(point);
+        map::Static<Map>::step(this->map, point, &tangent, nullptr, this->workspace);
+        this->escape_time++;
     }
 
     EscapeWithVector & operator=(EscapeWithVector const& other) {
-        EscapeTime::operator=(other);
+        EscapeTime<Float, Dim, Map>::operator=(other);
         this->tangent = other.tangent;
         return *this;
     }
 };
 
 
+//! `EscapeWithVector` with the tangent vector in the hardware precision `Fast` (see `ComputeFastVector`): the state
+//! is evolved in `Float`, but the cost of the tangent does not grow with its precision.
+template <typename Float, int Dim = Eigen::Dynamic, typename Map = map::generic::Map<Float, Dim>, typename Fast = double>
+class EscapeWithFastVector : public EscapeTime<Float, Dim, Map>, public ComputeFastVector<Float, Dim, Fast> {
+public:
+    typedef typename EscapeTime<Float, Dim, Map>::Matrix Matrix;
+    typedef typename EscapeTime<Float, Dim, Map>::Vector Vector;
+
+    EscapeWithFastVector(Map const& map, unsigned int max_time=std::numeric_limits<unsigned int>::max()) :
+            EscapeTime<Float, Dim, Map>(map, max_time), ComputeFastVector<Float, Dim, Fast>(map) {}
+
+    double lyapunov() const {
+        return this->log_stretch()/this->escape_time;
+    }
+
+    virtual void evolve(Vector & point) {
+        ComputeFastVector<Float, Dim, Fast>::step(this->map, point, this->workspace);
+        this->escape_time++;
+    }
+
+    EscapeWithFastVector & operator=(EscapeWithFastVector const& other) {
+        EscapeTime<Float, Dim, Map>::operator=(other);
+        ComputeFastVector<Float, Dim, Fast>::operator=(other);
+        return *this;
+    }
+
+protected:
+    virtual void initialize() {
+        EscapeTime<Float, Dim, Map>::initialize();
+        ComputeFastVector<Float, Dim, Fast>::initialize(this->random_stream());
+    }
+};
+
+
 //! Computes the escape time of the state and the Jacobian matrix of the trajectory.
-class EscapeWithMatrix : public EscapeTime, public ComputeMatrix {
+template <typename Float, int Dim = Eigen::Dynamic, typename Map = map::generic::Map<Float, Dim> >
+class EscapeWithMatrix : public EscapeTime<Float, Dim, Map>, public ComputeMatrix<Float, Dim> {
 public:
-    EscapeWithMatrix(map::Map & map, unsigned int max_time=std::numeric_limits<unsigned int>::max()) : EscapeTime(map, max_time), ComputeMatrix(map) {}
+    typedef typename EscapeTime<Float, Dim, Map>::Matrix Matrix;
+    typedef typename EscapeTime<Float, Dim, Map>::Vector Vector;
+
+    EscapeWithMatrix(Map const& map, unsigned int max_time=std::numeric_limits<unsigned int>::max()) : EscapeTime<Float, Dim, Map>(map, max_time), ComputeMatrix<Float, Dim>(map) {}
 
     double lyapunov() const {
-        return log(stretch()).toDouble()/this->escape_time;
+        return aux::to_double(log(this->stretch()))/this->escape_time;
     }
 
     void evolve(Vector & point) {
-        ComputeMatrix::evolve(map, point);
-        EscapeTime::evolve(point);
+        ComputeMatrix<Float, Dim>::step(this->map, point, this->workspace);
+        this->escape_time++;
+    }
+
+    void initialize() {
+        EscapeTime<Float, Dim, Map>::initialize();
+        ComputeMatrix<Float, Dim>::initialize();
     }
 
     void finalize() {
-        ComputeMatrix::finalise(map);
-        EscapeTime::finalize();
+        ComputeMatrix<Float, Dim>::finalise(this->map);
+        EscapeTime<Float, Dim, Map>::finalize();
     }
 
     EscapeWithMatrix & operator=(EscapeWithMatrix const& other) {
-        EscapeTime::operator=(other);
-        ComputeMatrix::operator=(other);
+        EscapeTime<Float, Dim, Map>::operator=(other);
+        ComputeMatrix<Float, Dim>::operator=(other);
         return *this;
     }
 };
 
 
 //! Computes the finite time Lyapunov exponent
-class Lyapunov : public Observable<double>, public ComputeMatrix {
+template <typename Float, int Dim = Eigen::Dynamic, typename Map = map::generic::Map<Float, Dim> >
+class Lyapunov : public Observable<double, Float, Dim>, public ComputeMatrix<Float, Dim> {
+    static_assert(std::is_base_of<map::generic::Map<Float, Dim>, Map>::value, "Map must be a map::generic::Map<Float, Dim>");
 public:
-    map::Map & map;
+    typedef typename Observable<double, Float, Dim>::Matrix Matrix;
+    typedef typename Observable<double, Float, Dim>::Vector Vector;
+    typedef Map MapType;
+
+    Map const& map;
+    map::generic::OwnedWorkspace<Float, Dim> workspace;  // the scratch storage of the evaluations of `map`.
     unsigned int tobs;
 
-    Lyapunov(map::Map & map, unsigned int tobs) : map(map), ComputeMatrix(map), tobs(tobs) {}
+    Lyapunov(Map const& map, unsigned int tobs) : map(map), workspace(map), ComputeMatrix<Float, Dim>(map), tobs(tobs) {}
 
     virtual void finalise(Vector const&) {
-        ComputeMatrix::finalise(map);
+        ComputeMatrix<Float, Dim>::finalise(map);
     }
 
     //! Lyapunov exponent function
     virtual void observe(Vector const& state) {
-        Observable::observe(state);
-        ComputeMatrix::initialize();
+        aux::Arena::Step step;
+        Observable<double, Float, Dim>::observe(state);
+        ComputeMatrix<Float, Dim>::initialize();
 
-        Vector point = state;
+        Vector & point = this->_point;
+        point = state;
 
-        for(unsigned int escape_time = 0; escape_time < tobs; escape_time++) {
-            ComputeMatrix::evolve(map, point);
-            map.T(point);
-        }
+        for(unsigned int escape_time = 0; escape_time < tobs; escape_time++)
+            ComputeMatrix<Float, Dim>::step(map, point, workspace);
 
         finalise(point);
     }
 
     double lyapunov() const {
-        return log(stretch()).toDouble()/tobs;
+        return aux::to_double(log(this->stretch()))/tobs;
     }
 
     Lyapunov & operator=(Lyapunov const& other) {
-        Observable::operator=(other);
-        ComputeMatrix::operator=(other);
+        Observable<double, Float, Dim>::operator=(other);
+        ComputeMatrix<Float, Dim>::operator=(other);
+        tobs = other.tobs;
+        return *this;
+    }
+
+    virtual double observable() const {
+        return lyapunov();
+    }
+};
+
+
+//! `Lyapunov` with the jacobian of the trajectory multiplied in the hardware precision `Fast` (see
+//! `ComputeFastMatrix`): the state is evolved in `Float`, but the cost of the products does not grow with its
+//! precision.
+template <typename Float, int Dim = Eigen::Dynamic, typename Map = map::generic::Map<Float, Dim>, typename Fast = double>
+class FastLyapunov : public Observable<double, Float, Dim>, public ComputeFastMatrix<Float, Dim, Fast> {
+    static_assert(std::is_base_of<map::generic::Map<Float, Dim>, Map>::value, "Map must be a map::generic::Map<Float, Dim>");
+public:
+    typedef typename Observable<double, Float, Dim>::Matrix Matrix;
+    typedef typename Observable<double, Float, Dim>::Vector Vector;
+    typedef Map MapType;
+
+    Map const& map;
+    map::generic::OwnedWorkspace<Float, Dim> workspace;  // the scratch storage of the evaluations of `map`.
+    unsigned int tobs;
+
+    FastLyapunov(Map const& map, unsigned int tobs) : ComputeFastMatrix<Float, Dim, Fast>(map), map(map), workspace(map), tobs(tobs) {}
+
+    virtual void observe(Vector const& state) {
+        aux::Arena::Step step;
+        Observable<double, Float, Dim>::observe(state);
+        ComputeFastMatrix<Float, Dim, Fast>::initialize();
+
+        Vector & point = this->_point;
+        point = state;
+        for (unsigned int t = 0; t < tobs; t++)
+            ComputeFastMatrix<Float, Dim, Fast>::step(map, point, workspace);
+
+        ComputeFastMatrix<Float, Dim, Fast>::finalise();
+    }
+
+    double lyapunov() const {
+        return this->log_stretch()/tobs;
+    }
+
+    FastLyapunov & operator=(FastLyapunov const& other) {
+        Observable<double, Float, Dim>::operator=(other);
+        ComputeFastMatrix<Float, Dim, Fast>::operator=(other);
         tobs = other.tobs;
         return *this;
     }
@@ -243,6 +807,457 @@ public:
     }
 };
 
+
+//! Computes the escape time of the state and its finite-time Lyapunov spectrum with `ComputeSpectrum`.
+//! It provides `stretch()` and `lyapunov()`, so it can be used with `proposal::LyapunovIsotropic`.
+template <typename Float, int Dim = Eigen::Dynamic, typename Map = map::generic::Map<Float, Dim> >
+class EscapeWithSpectrum : public EscapeTime<Float, Dim, Map>, public ComputeSpectrum<Float, Dim> {
+public:
+    typedef typename EscapeTime<Float, Dim, Map>::Matrix Matrix;
+    typedef typename EscapeTime<Float, Dim, Map>::Vector Vector;
+
+    EscapeWithSpectrum(Map const& map, unsigned int max_time=std::numeric_limits<unsigned int>::max(), unsigned int period=1) :
+            EscapeTime<Float, Dim, Map>(map, max_time), ComputeSpectrum<Float, Dim>(map, period) {}
+
+    double lyapunov() const {
+        return this->log_stretch()/this->escape_time;
+    }
+
+    std::vector<double> spectrum() const {
+        return ComputeSpectrum<Float, Dim>::spectrum(this->escape_time);
+    }
+
+    void evolve(Vector & point) {
+        ComputeSpectrum<Float, Dim>::step(this->map, point, this->workspace);
+        this->escape_time++;
+    }
+
+    EscapeWithSpectrum & operator=(EscapeWithSpectrum const& other) {
+        EscapeTime<Float, Dim, Map>::operator=(other);
+        ComputeSpectrum<Float, Dim>::operator=(other);
+        return *this;
+    }
+
+protected:
+    void initialize() {
+        EscapeTime<Float, Dim, Map>::initialize();
+        ComputeSpectrum<Float, Dim>::initialize();
+    }
+
+    void finalize() {
+        ComputeSpectrum<Float, Dim>::finalise();
+        EscapeTime<Float, Dim, Map>::finalize();
+    }
+};
+
+
+//! Computes the finite time Lyapunov spectrum with `ComputeSpectrum`. `lyapunov()` is the maximal exponent.
+//! Unlike `Lyapunov`, the jacobian of the trajectory is never formed, so it needs no precision to represent it.
+template <typename Float, int Dim = Eigen::Dynamic, typename Map = map::generic::Map<Float, Dim> >
+class LyapunovSpectrum : public Observable<double, Float, Dim>, public ComputeSpectrum<Float, Dim> {
+    static_assert(std::is_base_of<map::generic::Map<Float, Dim>, Map>::value, "Map must be a map::generic::Map<Float, Dim>");
+public:
+    typedef typename Observable<double, Float, Dim>::Matrix Matrix;
+    typedef typename Observable<double, Float, Dim>::Vector Vector;
+    typedef Map MapType;
+
+    Map const& map;
+    map::generic::OwnedWorkspace<Float, Dim> workspace;  // the scratch storage of the evaluations of `map`.
+    unsigned int tobs;
+
+    LyapunovSpectrum(Map const& map, unsigned int tobs, unsigned int period=1) :
+            ComputeSpectrum<Float, Dim>(map, period), map(map), workspace(map), tobs(tobs) {}
+
+    virtual void observe(Vector const& state) {
+        aux::Arena::Step step;
+        Observable<double, Float, Dim>::observe(state);
+        ComputeSpectrum<Float, Dim>::initialize();
+
+        Vector & point = this->_point;
+        point = state;
+        for (unsigned int t = 0; t < tobs; t++)
+            ComputeSpectrum<Float, Dim>::step(map, point, workspace);
+
+        ComputeSpectrum<Float, Dim>::finalise();
+    }
+
+    double lyapunov() const {
+        return this->log_stretch()/tobs;
+    }
+
+    std::vector<double> spectrum() const {
+        return ComputeSpectrum<Float, Dim>::spectrum(tobs);
+    }
+
+    LyapunovSpectrum & operator=(LyapunovSpectrum const& other) {
+        Observable<double, Float, Dim>::operator=(other);
+        ComputeSpectrum<Float, Dim>::operator=(other);
+        tobs = other.tobs;
+        return *this;
+    }
+
+    virtual double observable() const {
+        return lyapunov();
+    }
+};
+
+
+//! Computes the finite time Lyapunov exponents of several horizons and of sliding windows of one trajectory.
+//! The state is evolved once, up to the largest of the `horizons` (`tobs`), and the jacobian of each step is computed
+//! once: the FTLE of a horizon is the one of `Lyapunov(map, horizon)`, and the FTLE of the window [s, s + `window`),
+//! for s = 0, `stride`, 2 `stride`, ... up to s + `window` <= `tobs`, is the one of `Lyapunov(map, window)` at the
+//! state after s steps. Overlapping windows (`stride` < `window`) multiply window/stride products at each step.
+//! The observable is the FTLE of `tobs`; `values()` are the FTLEs of the horizons followed by the ones of the windows.
+template <typename Float, int Dim = Eigen::Dynamic, typename Map = map::generic::Map<Float, Dim> >
+class MultiLyapunov : public Observable<double, Float, Dim>, public ComputeMatrix<Float, Dim> {
+    static_assert(std::is_base_of<map::generic::Map<Float, Dim>, Map>::value, "Map must be a map::generic::Map<Float, Dim>");
+public:
+    typedef typename Observable<double, Float, Dim>::Matrix Matrix;
+    typedef typename Observable<double, Float, Dim>::Vector Vector;
+    typedef Map MapType;
+
+    Map const& map;
+    map::generic::OwnedWorkspace<Float, Dim> workspace;  // the scratch storage of the evaluations of `map`.
+    std::vector<unsigned int> horizons;  //! in increasing order.
+    unsigned int tobs;
+    unsigned int window, stride;
+
+    //! without `window`, there are no windows; without `stride`, the windows do not overlap.
+    MultiLyapunov(Map const& map, std::vector<unsigned int> const& horizons, unsigned int window=0, unsigned int stride=0) :
+            ComputeMatrix<Float, Dim>(map), map(map), workspace(map), horizons(horizons),
+            tobs(*std::max_element(horizons.begin(), horizons.end())), window(window),
+            stride(stride == 0 ? window : stride) {
+        std::sort(this->horizons.begin(), this->horizons.end());
+        unsigned int windows = 0;
+        if (window > 0 and window <= tobs)
+            windows = (tobs - window)/this->stride + 1;
+        _values.resize(this->horizons.size() + windows);
+        if (windows > 0)
+            products.resize(std::min(windows, (window + this->stride - 1)/this->stride), Window(map));
+    }
+
+    virtual void observe(Vector const& state) {
+        aux::Arena::Step step;
+        Observable<double, Float, Dim>::observe(state);
+        ComputeMatrix<Float, Dim>::initialize();
+
+        Vector & point = this->_point;
+        point = state;
+        unsigned int horizon = 0, started = 0, finished = 0;
+        unsigned int const windows = this->windows();
+        // the jacobian of each step, left in the workspace.
+        Matrix & step_jacobian = static_cast<typename map::generic::Map<Float, Dim>::Workspace &>(workspace).jacobian;
+        for (unsigned int t = 0; t < tobs; t++) {
+            map::Static<Map>::step(map, point, nullptr, &step_jacobian, workspace);
+            this->multiply(step_jacobian);
+
+            if (started < windows and started*stride == t)
+                products[started++ % products.size()].initialize();
+            for (unsigned int w = finished; w < started; w++)
+                products[w % products.size()].multiply(step_jacobian);
+            if (finished < started and finished*stride + window == t + 1) {
+                Window & product = products[finished % products.size()];
+                product.finalise();
+                _values[horizons.size() + finished++] = aux::to_double(log(product.stretch()))/window;
+            }
+
+            for (; horizon < horizons.size() and horizons[horizon] == t + 1; horizon++) {
+                ComputeMatrix<Float, Dim>::finalise();
+                _values[horizon] = aux::to_double(log(this->stretch()))/(t + 1);
+            }
+        }
+        ComputeMatrix<Float, Dim>::finalise();
+    }
+
+    double lyapunov() const {
+        return aux::to_double(log(this->stretch()))/tobs;
+    }
+
+    //! the FTLE of the i-th horizon.
+    double lyapunov(unsigned int i) const {
+        return _values[i];
+    }
+
+    //! the number of windows.
+    unsigned int windows() const {
+        return (unsigned int) (_values.size() - horizons.size());
+    }
+
+    //! the FTLE of the window starting at `i*stride`.
+    double window_lyapunov(unsigned int i) const {
+        return _values[horizons.size() + i];
+    }
+
+    std::vector<double> const& values() const {
+        return _values;
+    }
+
+    MultiLyapunov & operator=(MultiLyapunov const& other) {
+        Observable<double, Float, Dim>::operator=(other);
+        ComputeMatrix<Float, Dim>::operator=(other);
+        _values = other._values;
+        return *this;
+    }
+
+    virtual double observable() const {
+        return lyapunov();
+    }
+
+protected:
+    //! the product of the jacobians of a window.
+    struct Window : public ComputeMatrix<Float, Dim> {
+        Window(map::generic::Map<Float, Dim> const& map) : ComputeMatrix<Float, Dim>(map) {}
+
+        using ComputeMatrix<Float, Dim>::initialize;
+        using ComputeMatrix<Float, Dim>::multiply;
+        using ComputeMatrix<Float, Dim>::finalise;
+    };
+
+    std::vector<double> _values;
+    std::vector<Window, Eigen::aligned_allocator<Window> > products;  // the products of the windows in progress.
+};
+
+} // generic
+
+
+typedef generic::EscapeTime<Float> EscapeTime;
+typedef generic::EscapeWithVector<Float> EscapeWithVector;
+typedef generic::EscapeWithMatrix<Float> EscapeWithMatrix;
+typedef generic::Lyapunov<Float> Lyapunov;
+typedef generic::EscapeWithSpectrum<Float> EscapeWithSpectrum;
+typedef generic::LyapunovSpectrum<Float> LyapunovSpectrum;
+typedef generic::EscapeWithFastVector<Float> EscapeWithFastVector;
+typedef generic::FastLyapunov<Float> FastLyapunov;
+typedef generic::MultiLyapunov<Float> MultiLyapunov;
+
+
+//! The escape time computed in hardware precision (`Fast`) whenever the trajectory allows it.
+//! The stretch of a tangent vector is tracked along the trajectory (in `Fast`). When log2(stretch) exceeds the
+//! mantissa of `Fast` (minus `margin` bits), the rounding errors are no longer negligible and the same state is
+//! re-observed with `mpfr::mpreal`, with a precision computed from the observed FTLE and escape time.
+//! The precision of each step is the maximum between that precision and the one of the parameters of `map`,
+//! so `map` should be constructed with a small default precision.
+//! It also provides `stretch()` and `lyapunov()`, so it can be used with `proposal::LyapunovIsotropic`.
+template <typename Fast = double>
+class AdaptiveEscapeTime : public EscapeTime {
+    typedef Eigen::Matrix<Fast, Eigen::Dynamic, 1> FastVector;
+protected:
+    map::generic::Map<Fast> const& fast_map;
+    map::generic::OwnedWorkspace<Fast> fast_workspace;
+
+    FastVector tangent;  // the tangent vector, normalized by 2^log2_stretch.
+    FastVector fast_point;  // `point` converted to `Fast`, used to compute the tangent space.
+    double log2_stretch;
+
+    //! one step of `point` and of `tangent`.
+    void advance(map::generic::Map<Fast> const& map, FastVector & point) {
+        map.step(point, &tangent, nullptr, fast_workspace);
+    }
+
+    void advance(map::Map const& map, Vector & point) {
+        for (unsigned int i = 0; i < point.size(); i++)
+            fast_point[i] = aux::to_double(point[i]);
+        fast_map.jvp(fast_point, tangent, fast_workspace);
+        map.T(point, this->workspace);
+    }
+
+    //! evolves `point` until it exits or up to `horizon()`. Returns false if log2(stretch) exceeded `max_log2_stretch`,
+    //! with `log2_stretch` and `escape_time` at that step.
+    template <typename F>
+    bool trace(map::generic::Map<F> const& map, Eigen::Matrix<F, Eigen::Dynamic, 1> & point, double max_log2_stretch) {
+        static const Fast scale = pow(Fast(2), 64);
+        escape_time = 0;
+        log2_stretch = 0;
+        tangent = initial_tangent;
+        do {
+            advance(map, point);
+            escape_time++;
+
+            if (tangent.cwiseAbs().maxCoeff() > scale) {
+                tangent /= scale;
+                log2_stretch += 64;
+            }
+            if (log2_stretch + log2(aux::to_double(aux::get_norm(tangent))) > max_log2_stretch) {
+                log2_stretch += log2(aux::to_double(aux::get_norm(tangent)));
+                return false;
+            }
+        } while (not map.has_exited(point) and escape_time < horizon());
+        log2_stretch += log2(aux::to_double(aux::get_norm(tangent)));
+        return true;
+    }
+
+    //! the bits of the trajectory of the last `trace` at its FTLE (in bits per step), assuming that it lives at least
+    //! twice as long as traced (and at most `horizon()` steps), plus `margin`.
+    unsigned int traced_precision() const {
+        double lambda = log2_stretch/escape_time;
+        unsigned int horizon = std::min(2*escape_time, this->horizon());
+        return std::max(precision + 1, margin + (unsigned int) ceil(lambda*horizon));
+    }
+
+public:
+    FastVector initial_tangent;  // the tangent vector of the last observation, in double and in arbitrary precision.
+    unsigned int margin;  // number of bits of the mantissa that must remain unaffected by the stretch.
+    unsigned int precision;  // the number of bits used in the last observation.
+    unsigned int max_precision;  // the observation throws `std::overflow_error` when it needs more bits than this.
+
+    AdaptiveEscapeTime(map::generic::Map<Fast> const& fast_map, map::Map const& map,
+                       unsigned int max_time=std::numeric_limits<unsigned int>::max(), unsigned int margin=16,
+                       unsigned int max_precision=1u << 20) :
+            EscapeTime(map, max_time), fast_map(fast_map), fast_workspace(fast_map), fast_point(map.D), log2_stretch(0),
+            initial_tangent(FastVector::Unit(map.D, 0)), margin(margin), precision(0), max_precision(max_precision) {}
+
+    void observe(Vector const& state) {
+        Observable<unsigned int, Float>::observe(state);
+        initialize();
+        aux::unitaryVector(initial_tangent, this->random_stream());
+
+        FastVector point(state.size());
+        for (unsigned int i = 0; i < state.size(); i++)
+            point[i] = aux::to_double(state[i]);
+
+        precision = aux::Scalar<Fast>::digits();
+        if (trace(fast_map, point, precision - margin)) {
+            finalize();
+            return;
+        }
+
+        Vector precise_point(state.size());
+        while (true) {
+            precision = traced_precision();
+            if (precision > max_precision)
+                throw std::overflow_error("AdaptiveEscapeTime: the observation needs more than max_precision bits");
+            for (unsigned int i = 0; i < state.size(); i++) {
+                precise_point[i] = state[i];
+                precise_point[i].set_prec(precision);
+            }
+            if (trace(map, precise_point, precision - margin))
+                break;
+        }
+        finalize();
+    }
+
+    Float stretch() const {
+        return pow(Float(2), Float(log2_stretch));
+    }
+
+    double lyapunov() const {
+        return log2_stretch*log(2.)/this->escape_time;
+    }
+
+    AdaptiveEscapeTime & operator=(AdaptiveEscapeTime const& other) {
+        EscapeTime::operator=(other);
+        this->tangent = other.tangent;
+        this->log2_stretch = other.log2_stretch;
+        this->initial_tangent = other.initial_tangent;
+        this->margin = other.margin;
+        this->precision = other.precision;
+        this->max_precision = other.max_precision;
+        return *this;
+    }
+};
+
+
+//! The finite time Lyapunov exponent computed in hardware precision (`Fast`) whenever the trajectory allows it.
+//! When the stretch of the trajectory, log2(|J|), reaches the mantissa of `Fast` (minus `margin` bits),
+//! the same state is re-observed with `mpfr::mpreal` with log2(|J|) + `margin` bits.
+//! See `AdaptiveEscapeTime` for the precision of `map`.
+template <typename Fast = double>
+class AdaptiveLyapunov : public Observable<double, Float> {
+    typedef Eigen::Matrix<Fast, Eigen::Dynamic, 1> FastVector;
+protected:
+    generic::Lyapunov<Fast> fast;
+    Lyapunov precise;
+    bool is_precise;
+
+    //! +inf when the jacobian overflowed `Fast` (an infinite or NaN entry).
+    static double log2_stretch(generic::Lyapunov<Fast> const& result) {
+        double max = 0;
+        for (unsigned int i = 0; i < result.jacobian.size(); i++) {
+            double entry = std::abs(aux::to_double(result.jacobian(i)));
+            if (not std::isfinite(entry))
+                return std::numeric_limits<double>::infinity();
+            max = std::max(max, entry);
+        }
+        return log2(max);
+    }
+
+    static double log2_stretch(Lyapunov const& result) {
+        return aux::to_double(log2(result.jacobian.cwiseAbs().maxCoeff()));
+    }
+
+public:
+    unsigned int tobs;
+    unsigned int margin;  // number of bits of the mantissa that must remain unaffected by the stretch.
+    unsigned int precision;  // the number of bits used in the last observation.
+    unsigned int max_precision;  // the observation throws `std::overflow_error` when it needs more bits than this.
+
+    AdaptiveLyapunov(map::generic::Map<Fast> const& fast_map, map::Map const& map, unsigned int tobs, unsigned int margin=16,
+                     unsigned int max_precision=1u << 20) :
+            fast(fast_map, tobs), precise(map, tobs), is_precise(false), tobs(tobs), margin(margin), precision(0),
+            max_precision(max_precision) {}
+
+    virtual void observe(Vector const& state) {
+        Observable<double, Float>::observe(state);
+
+        FastVector point(state.size());
+        for (unsigned int i = 0; i < state.size(); i++)
+            point[i] = aux::to_double(state[i]);
+        fast.observe(point);
+
+        precision = aux::Scalar<Fast>::digits();
+        double bits = log2_stretch(fast) + margin;
+        is_precise = bits > precision;
+        if (not is_precise)
+            return;
+
+        // an overflowed stretch gives no estimate of the bits: the first precise run doubles the precision and the
+        // next ones use its stretch, which does not overflow the exponent of `mpfr::mpreal`.
+        Vector precise_point(state.size());
+        while (true) {
+            if (not std::isfinite(bits))
+                bits = 2.*precision;
+            if (bits > max_precision)
+                throw std::overflow_error("AdaptiveLyapunov: the observation needs more than max_precision bits");
+            precision = std::max(precision + 1, (unsigned int) ceil(bits));
+            for (unsigned int i = 0; i < state.size(); i++) {
+                precise_point[i] = state[i];
+                precise_point[i].set_prec(precision);
+            }
+            precise.observe(precise_point);
+
+            bits = log2_stretch(precise) + margin;
+            if (bits <= precision)
+                break;
+        }
+    }
+
+    Float stretch() const {
+        if (is_precise)
+            return precise.stretch();
+        return Float(aux::to_double(fast.stretch()));
+    }
+
+    Vector eigenvector() const {
+        if (is_precise)
+            return precise.eigenvector();
+        typename generic::Lyapunov<Fast>::Vector fast_vector = fast.eigenvector();
+        Vector vector(fast_vector.size());
+        for (unsigned int i = 0; i < fast_vector.size(); i++)
+            vector[i] = aux::to_double(fast_vector[i]);
+        return vector;
+    }
+
+    double lyapunov() const {
+        if (is_precise)
+            return precise.lyapunov();
+        return fast.lyapunov();
+    }
+
+    virtual double observable() const {
+        return lyapunov();
+    }
+};
+
 }
 
 #endif
@@ -9,8 +9,13 @@
 
 namespace optimizer {
 
+//! The optimizers templated on the scalar type `Float` of the map.
+//! The arbitrary precision versions are available directly in `optimizer`, e.g. `optimizer::Adaptive`.
+namespace generic {
+
+template <typename Float, int Dim = Eigen::Dynamic, typename Map = map::generic::Map<Float, Dim> >
 class Profiler {
-    typedef observable::EscapeTime Observable;
+    typedef observable::generic::EscapeTime<Float, Dim, Map> Observable;
 public:
     virtual void start(Observable const& result) = 0;
     virtual void measure(Observable const& result, Observable const& result_prime, Float const& delta, double acceptance) = 0;
@@ -18,9 +23,17 @@ public:
     virtual void export_all(std::string directory, std::string file_name) const = 0;
 };
 
+}
+
 
-template <typename Observable>
+//! `Proposal` is the type of the proposal: a concrete proposal is called without virtual dispatch
+//! (see `proposal::Static`).
+template <typename Observable, typename Proposal = proposal::Proposal<Observable> >
 class Optimizer {
+    static_assert(std::is_base_of<proposal::Proposal<Observable>, Proposal>::value,
+                  "Proposal must be a proposal::Proposal<Observable>");
+    typedef typename Observable::Scalar Float;
+    typedef generic::Profiler<Float, Observable::Dimension, typename Observable::MapType> Profiler;
 private:
     //! a list of profilers that store information
     std::vector<Profiler*> profilers;
@@ -38,26 +51,31 @@ private:
     }
 protected:
     unsigned int max_time;
-    proposal::Proposal<Observable> & proposal;
+    Proposal & proposal;
     Observable observable;
 public:
+    //! the random numbers of the searches.
+    aux::Stream stream;
 
-    Optimizer(Observable const& observable, proposal::Proposal<Observable> & proposal, unsigned int max_time) :
-            observable(observable), proposal(proposal), max_time(max_time) {}
+    Optimizer(Observable const& observable, Proposal & proposal, unsigned int max_time,
+              aux::Stream const& stream = aux::Stream::unique()) :
+            observable(observable), proposal(proposal), max_time(max_time), stream(stream) {}
 
     virtual Observable get_point(unsigned int max_trials = 0) {
         Observable result(this->observable);
-        result.observe(this->proposal.proposeUniform());
+        result.set_stream(stream);
+        result.observe(this->proposal.proposeUniform(stream));
         start_profilers(result);
 
         unsigned int trial = 0;
         while (result.escape_time < max_time and (max_trials == 0 or trial < max_trials)) {
             trial++;
             Observable result_prime(this->observable);
-            result_prime.observe(this->proposal.propose(result));
+            result_prime.set_stream(stream);
+            result_prime.observe(proposal::Static<Proposal>::propose(this->proposal, result, stream));
 
             this->measure(result, result_prime, proposal.get_delta());
-            proposal.update(result, result_prime);
+            proposal::Static<Proposal>::update(this->proposal, result, result_prime);
             if (result_prime.escape_time > result.escape_time)
                 trial = 0;
             if (result_prime.escape_time >= result.escape_time) {
@@ -74,37 +92,66 @@ public:
 };
 
 
+namespace generic {
+
 //! Optimization using Power-Law proposal.
-class PowerLaw : public Optimizer<observable::EscapeTime> {
+//! `Map` is the type of the map (see `observable::generic::EscapeTime`).
+template <typename Float, typename Map = map::generic::Map<Float> >
+class PowerLaw : public Optimizer<observable::generic::EscapeTime<Float, Eigen::Dynamic, Map>,
+                                  proposal::PowerLawIsotropic<observable::generic::EscapeTime<Float, Eigen::Dynamic, Map> > > {
+    typedef observable::generic::EscapeTime<Float, Eigen::Dynamic, Map> Observable;
+    typedef proposal::PowerLawIsotropic<Observable> Proposal;
 public:
-    PowerLaw(map::Map & map, unsigned int max_time, double min_s, double max_s) :
-        Optimizer<observable::EscapeTime>(observable::EscapeTime(map), *new proposal::PowerLawIsotropic<observable::EscapeTime>(map.boundary, min_s, max_s), max_time) {}
+    PowerLaw(Map const& map, unsigned int max_time, double min_s, double max_s,
+             aux::Stream const& stream = aux::Stream::unique()) :
+        Optimizer<Observable, Proposal>(Observable(map), *new Proposal(map.boundary, min_s, max_s), max_time, stream) {}
 };
 
 
 //! Optimization using adaptive proposal.
-class Adaptive : public Optimizer<observable::EscapeTime> {
+template <typename Float, typename Map = map::generic::Map<Float> >
+class Adaptive : public Optimizer<observable::generic::EscapeTime<Float, Eigen::Dynamic, Map>,
+                                  proposal::Adaptive<observable::generic::EscapeTime<Float, Eigen::Dynamic, Map> > > {
+    typedef observable::generic::EscapeTime<Float, Eigen::Dynamic, Map> Observable;
+    typedef proposal::Adaptive<Observable> Proposal;
 public:
-    Adaptive(map::Map & map, unsigned int max_time) :
-        Optimizer<observable::EscapeTime>(observable::EscapeTime(map, max_time), *new proposal::Adaptive<observable::EscapeTime>(map.boundary), max_time) {}
+    Adaptive(Map const& map, unsigned int max_time, aux::Stream const& stream = aux::Stream::unique()) :
+        Optimizer<Observable, Proposal>(Observable(map, max_time), *new Proposal(map.boundary), max_time, stream) {}
 };
 
 
 //! Optimization using Isotropic Lyapunov proposal
-class Isotropic : public Optimizer<observable::EscapeWithVector> {
+template <typename Float, typename Map = map::generic::Map<Float> >
+class Isotropic : public Optimizer<observable::generic::EscapeWithVector<Float, Eigen::Dynamic, Map>,
+                                   proposal::LyapunovIsotropic<observable::generic::EscapeWithVector<Float, Eigen::Dynamic, Map> > > {
+    typedef observable::generic::EscapeWithVector<Float, Eigen::Dynamic, Map> Observable;
+    typedef proposal::LyapunovIsotropic<Observable> Proposal;
 public:
-    Isotropic(map::Map & map, unsigned int max_time) :
-            Optimizer<observable::EscapeWithVector>(observable::EscapeWithVector(map, max_time), *new proposal::LyapunovIsotropic<observable::EscapeWithVector>(map.boundary), max_time) {}
+    Isotropic(Map const& map, unsigned int max_time, aux::Stream const& stream = aux::Stream::unique()) :
+            Optimizer<Observable, Proposal>(Observable(map, max_time), *new Proposal(map.boundary), max_time, stream) {}
 };
 
 
 //! Optimization using anisotropic proposal.
-class Anisotropic : public Optimizer<observable::EscapeWithMatrix> {
+template <typename Float, typename Map = map::generic::Map<Float> >
+class Anisotropic : public Optimizer<observable::generic::EscapeWithMatrix<Float, Eigen::Dynamic, Map>,
+                                     proposal::Anisotropic<observable::generic::EscapeWithMatrix<Float, Eigen::Dynamic, Map> > > {
+    typedef observable::generic::EscapeWithMatrix<Float, Eigen::Dynamic, Map> Observable;
+    typedef proposal::Anisotropic<Observable> Proposal;
 public:
-    Anisotropic(map::Map & map, unsigned int max_time) :
-        Optimizer<observable::EscapeWithMatrix>(observable::EscapeWithMatrix(map, max_time), *new proposal::Anisotropic<observable::EscapeWithMatrix>(map.boundary), max_time) {}
+    Anisotropic(Map const& map, unsigned int max_time, aux::Stream const& stream = aux::Stream::unique()) :
+        Optimizer<Observable, Proposal>(Observable(map, max_time), *new Proposal(map.boundary), max_time, stream) {}
 };
 
+} // generic
+
+
+typedef generic::Profiler<Float> Profiler;
+typedef generic::PowerLaw<Float> PowerLaw;
+typedef generic::Adaptive<Float> Adaptive;
+typedef generic::Isotropic<Float> Isotropic;
+typedef generic::Anisotropic<Float> Anisotropic;
+
 }
 
 #endif
@@ -2,6 +2,7 @@
 #define chaospp_proposal_h
 
 #include "assert.h"
+#include <limits>
 
 #include "auxiliar.h"
 #include "observable.h"
@@ -9,7 +10,8 @@
 namespace proposal {
 
 //! sends the point to inside the boundary
-void bound_initial_condition(Vector & point, std::vector<aux::pair> const& boundary) {
+template <typename Float, int Dim>
+void bound_initial_condition(Eigen::Matrix<Float, Dim, 1> & point, std::vector<std::pair<Float, Float> > const& boundary) {
     assert(boundary.size() == point.size());
     for(unsigned int i = 0; i < point.size(); i++) {
         while(point[i] > boundary[i].second)
@@ -19,37 +21,95 @@ void bound_initial_condition(Vector & point, std::vector<aux::pair> const& bound
     }
 }
 
-Vector proposeUniform(std::vector<aux::pair> const& boundary) {
-    Vector proposal(boundary.size());
+//! writes a uniform point of the boundary into `proposal` (allocated only if it does not have its dimension).
+template <typename Float, int Dim>
+void proposeUniform(std::vector<std::pair<Float, Float> > const& boundary, Eigen::Matrix<Float, Dim, 1> & proposal,
+                    aux::Stream & stream) {
+    proposal.resize(boundary.size());
     for(unsigned int i = 0; i < boundary.size(); i++) {
-        aux::pair const& box = boundary[i];
-        proposal[i] = box.first + (box.second - box.first)*aux::urandom();
+        std::pair<Float, Float> const& box = boundary[i];
+        proposal[i] = box.first + (box.second - box.first)*aux::urandom<Float>(stream);
     }
+}
+
+template <typename Float, int Dim>
+void proposeUniform(std::vector<std::pair<Float, Float> > const& boundary, Eigen::Matrix<Float, Dim, 1> & proposal) {
+    proposeUniform(boundary, proposal, aux::Stream::local());
+}
+
+template <typename Float, int Dim = Eigen::Dynamic>
+Eigen::Matrix<Float, Dim, 1> proposeUniform(std::vector<std::pair<Float, Float> > const& boundary, aux::Stream & stream) {
+    Eigen::Matrix<Float, Dim, 1> proposal(boundary.size());
+    proposeUniform(boundary, proposal, stream);
     return proposal;
 }
 
-Vector proposeIsotropic(Vector point, Vector const& vector, Float const& sigma, std::vector<aux::pair> const& boundary) {
+template <typename Float, int Dim = Eigen::Dynamic>
+Eigen::Matrix<Float, Dim, 1> proposeUniform(std::vector<std::pair<Float, Float> > const& boundary) {
+    return proposeUniform<Float, Dim>(boundary, aux::Stream::local());
+}
+
+//! writes `point` + `sigma`*`vector`, sent inside the boundary, into `proposal` (which can be `point`).
+template <typename Float, int Dim>
+void proposeIsotropic(Eigen::Matrix<Float, Dim, 1> const& point, Eigen::Matrix<Float, Dim, 1> const& vector,
+                      Float const& sigma, std::vector<std::pair<Float, Float> > const& boundary,
+                      Eigen::Matrix<Float, Dim, 1> & proposal) {
+    proposal.resize(point.size());
     for(unsigned d = 0; d < point.size(); d++)
-        point[d] += sigma*vector[d];
+        proposal[d] = point[d] + sigma*vector[d];
 
-    bound_initial_condition(point, boundary);
+    bound_initial_condition(proposal, boundary);
+}
+
+template <typename Float, int Dim>
+Eigen::Matrix<Float, Dim, 1> proposeIsotropic(Eigen::Matrix<Float, Dim, 1> point, Eigen::Matrix<Float, Dim, 1> const& vector,
+                                              Float const& sigma, std::vector<std::pair<Float, Float> > const& boundary) {
+    proposeIsotropic(point, vector, sigma, boundary, point);
     return point;
 }
 
+template <typename Float>
 inline double logAcceptanceIsotropic(Float const& sigma, Float const& sigmaPrime, Float delta) {
-    double ratio = Float(delta/sigma).toDouble();
-    double ratio_sigma = Float(sigma/sigmaPrime).toDouble();
+    double ratio = aux::to_double(Float(delta/sigma));
+    double ratio_sigma = aux::to_double(Float(sigma/sigmaPrime));
 
     return log(ratio_sigma) - 0.5*ratio*ratio*(ratio_sigma*ratio_sigma - 1);
 }
 
-Vector proposeAnisotropic(Vector point, Matrix const& jacobian, Float const& sigma0, std::vector<aux::pair> const& boundary) {
-    Eigen::JacobiSVD<Matrix> svd(jacobian, Eigen::ComputeFullV);
+//! the dimension from which `right_singular` uses the divide and conquer SVD.
+const unsigned int bdcsvd_dimension = 16;
+
+//! the singular values of `jacobian` in decreasing order, and its right singular vectors `v_matrix`: with the Jacobi
+//! SVD below `bdcsvd_dimension`, and with the divide and conquer SVD, much faster for large dimensions, from it on.
+template <typename Float, int Dim>
+void right_singular(Eigen::Matrix<Float, Dim, Dim> const& jacobian, Eigen::Matrix<Float, Dim, Dim> & v_matrix,
+                    Eigen::Matrix<Float, Dim, 1> & singular_values) {
+    typedef Eigen::Matrix<Float, Dim, Dim> Matrix;
+    if ((unsigned int) jacobian.cols() < bdcsvd_dimension) {
+        Eigen::JacobiSVD<Matrix> svd(jacobian, Eigen::ComputeFullV);
+        v_matrix = svd.matrixV();
+        singular_values = svd.singularValues();
+    }
+    else {
+        Eigen::BDCSVD<Matrix> svd(jacobian, Eigen::ComputeFullV);
+        v_matrix = svd.matrixV();
+        singular_values = svd.singularValues();
+    }
+}
+
+template <typename Float, int Dim>
+Eigen::Matrix<Float, Dim, 1> proposeAnisotropic(Eigen::Matrix<Float, Dim, 1> point, Eigen::Matrix<Float, Dim, Dim> const& jacobian,
+                                                Float const& sigma0, std::vector<std::pair<Float, Float> > const& boundary,
+                                                aux::Stream & stream) {
+    typedef Eigen::Matrix<Float, Dim, Dim> Matrix;
+    typedef Eigen::Matrix<Float, Dim, 1> Vector;
 
-    Matrix v_matrix = svd.matrixV();
-    Vector const& singular_values = svd.singularValues();
+    Matrix v_matrix;
+    Vector singular_values;
+    right_singular(jacobian, v_matrix, singular_values);
 
-    Vector delta = aux::unitaryVector((unsigned int)point.size());
+    Vector delta(point.size());
+    aux::unitaryVector(delta, stream);
 
     // build vector
     // build (Sigma^+)^-1*vector
@@ -69,30 +129,79 @@ Vector proposeAnisotropic(Vector point, Matrix const& jacobian, Float const& sig
     return point;
 }
 
+template <typename Float, int Dim>
+Eigen::Matrix<Float, Dim, 1> proposeAnisotropic(Eigen::Matrix<Float, Dim, 1> const& point, Eigen::Matrix<Float, Dim, Dim> const& jacobian,
+                                                Float const& sigma0, std::vector<std::pair<Float, Float> > const& boundary) {
+    return proposeAnisotropic(point, jacobian, sigma0, boundary, aux::Stream::local());
+}
+
 
 // A generic class that implements proposals.
+// The scalar type of the proposal, `Float`, is the one of the observable.
+// The random numbers are drawn from the stream given to `propose` (the one of the chain); the overloads without a
+// stream use the stream of the calling thread (`aux::Stream::local`).
 template <typename Observable>
 class Proposal {
     static_assert(
-            std::is_base_of<observable::Observable<typename Observable::Type>, Observable>::value,
+            std::is_base_of<observable::Observable<typename Observable::Type, typename Observable::Scalar, Observable::Dimension>, Observable>::value,
             "Observable must be a subclass of observable::Observable"
     );
+public:
+    typedef typename Observable::Scalar Float;
+    typedef typename Observable::Vector Vector;
+    typedef std::pair<Float, Float> pair;
 protected:
     Float delta;
-    std::vector<aux::pair> const& boundary;
+    std::vector<pair> const& boundary;
     unsigned int D;
 public:
 
-    Proposal(std::vector<aux::pair> const& boundary) : boundary(boundary), D((unsigned int) boundary.size()) {}
+    Proposal(std::vector<pair> const& boundary) : boundary(boundary), D((unsigned int) boundary.size()) {}
+
+    Vector proposeUniform(aux::Stream & stream) {
+        return proposal::proposeUniform<Float, Observable::Dimension>(boundary, stream);
+    }
+
+    void proposeUniform(Vector & proposal, aux::Stream & stream) {
+        proposal::proposeUniform(boundary, proposal, stream);
+    }
 
     Vector proposeUniform() {
-        return proposal::proposeUniform(boundary);
+        return proposeUniform(aux::Stream::local());
+    }
+
+    void proposeUniform(Vector & proposal) {
+        proposeUniform(proposal, aux::Stream::local());
+    }
+
+    virtual Vector propose(Observable const& result, aux::Stream & stream) = 0;
+
+    //! `propose` written into `proposal`, a buffer of the dimension of the state. The built-in proposals override it
+    //! to propose without allocating (it is the one used by the samplers); by default it calls `propose`.
+    virtual void propose_into(Observable const& result, Vector & proposal, aux::Stream & stream) {
+        proposal = propose(result, stream);
     }
 
-    virtual Vector propose(Observable const& result) = 0;
+    Vector propose(Observable const& result) {
+        return propose(result, aux::Stream::local());
+    }
+
+    void propose_into(Observable const& result, Vector & proposal) {
+        propose_into(result, proposal, aux::Stream::local());
+    }
 
     virtual double log_acceptance(Observable const&, Observable const&) const = 0;
 
+    //! an upper bound of `log_acceptance(result, result_prime)` over the proposals from `result`, which lets the
+    //! samplers reject a proposal before its observation ends (see `MetropolisHastings::early_rejection`).
+    //! By default there is none.
+    virtual double max_log_acceptance(Observable const& result) const {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    //! called by the samplers with the current state and a proposal from it. The observation of the proposal may
+    //! have stopped at a value above the one of `result` (see `Observable::set_upper_bound`): the update must only
+    //! depend on whether its value is above, as `Adaptive`.
     virtual void update(Observable const&, Observable const&) {}
 
     Float const& get_delta() const {
@@ -103,42 +212,77 @@ public:
 
 // Uniform proposal on the boundary region
 template <typename Observable>
-class Uniform : public Proposal<Observable> {
+class Uniform final : public Proposal<Observable> {
 public:
-    Uniform(std::vector<aux::pair> const& boundary) : Proposal<Observable>(boundary) {}
+    typedef typename Proposal<Observable>::Float Float;
+    typedef typename Proposal<Observable>::Vector Vector;
+    typedef typename Proposal<Observable>::pair pair;
 
-    Vector propose(Observable const& result) {
-        Vector newState = this->proposeUniform();
-        this->delta = aux::get_norm(newState - result.state);
+    using Proposal<Observable>::propose;
+    using Proposal<Observable>::propose_into;
+
+    Uniform(std::vector<pair> const& boundary) : Proposal<Observable>(boundary) {}
+
+    Vector propose(Observable const& result, aux::Stream & stream) {
+        Vector newState(this->D);
+        propose_into(result, newState, stream);
         return newState;
     }
 
+    void propose_into(Observable const& result, Vector & proposal, aux::Stream & stream) {
+        this->proposeUniform(proposal, stream);
+        this->delta = aux::get_norm(proposal - result.state);
+    }
+
     double log_acceptance(Observable const&, Observable const&) const {
         return 0;
     }
+
+    double max_log_acceptance(Observable const&) const {
+        return 0;
+    }
 };
 
 
 // "Power Law isotropic proposal"
 // aka "Exponential Stagger Distribution" in http://journals.aps.org/prl/abstract/10.1103/PhysRevLett.86.2261
 template <typename Observable>
-class PowerLawIsotropic : public Proposal<Observable> {
+class PowerLawIsotropic final : public Proposal<Observable> {
+public:
+    typedef typename Proposal<Observable>::Float Float;
+    typedef typename Proposal<Observable>::Vector Vector;
+    typedef typename Proposal<Observable>::pair pair;
 protected:
     Float delta;
     Float min_s, max_s;
+    Vector direction;  // workspace of `propose_into`.
 public:
 
-    PowerLawIsotropic(std::vector<aux::pair> const& boundary, Float min_s, Float max_s) :
-            Proposal<Observable>(boundary), min_s(-min_s), max_s(-max_s) {}
+    using Proposal<Observable>::propose;
+    using Proposal<Observable>::propose_into;
 
-    virtual Vector propose(Observable const& result) {
-        delta = exp(min_s + (max_s - min_s)*aux::urandom());
-        return proposeIsotropic(result.state, aux::unitaryVector(this->D), delta, this->boundary);
+    PowerLawIsotropic(std::vector<pair> const& boundary, Float min_s, Float max_s) :
+            Proposal<Observable>(boundary), min_s(-min_s), max_s(-max_s), direction(boundary.size()) {}
+
+    virtual Vector propose(Observable const& result, aux::Stream & stream) {
+        Vector proposal(this->D);
+        propose_into(result, proposal, stream);
+        return proposal;
+    }
+
+    virtual void propose_into(Observable const& result, Vector & proposal, aux::Stream & stream) {
+        delta = exp(min_s + (max_s - min_s)*aux::urandom<Float>(stream));
+        aux::unitaryVector(direction, stream);
+        proposeIsotropic(result.state, direction, delta, this->boundary, proposal);
     }
 
     virtual double log_acceptance(Observable const&, Observable const&) const {
         return 0;
     }
+
+    virtual double max_log_acceptance(Observable const&) const {
+        return 0;
+    }
 };
 
 
@@ -146,28 +290,48 @@ public:
 template <typename Observable>
 class Isotropic : public Proposal<Observable> {
 public:
-    Isotropic(std::vector<aux::pair> const& boundary) : Proposal<Observable>(boundary) {}
+    typedef typename Proposal<Observable>::Float Float;
+    typedef typename Proposal<Observable>::Vector Vector;
+    typedef typename Proposal<Observable>::pair pair;
+
+    using Proposal<Observable>::propose;
+    using Proposal<Observable>::propose_into;
+
+    Isotropic(std::vector<pair> const& boundary) : Proposal<Observable>(boundary), direction(boundary.size()) {}
 
     virtual Float sigma(Observable const& result) const = 0;
 
-    virtual Vector propose(Observable const& result) {
-        static const Float constant = sqrt(aux::pi/2);
+    virtual Vector propose(Observable const& result, aux::Stream & stream) {
+        Vector proposal(this->D);
+        propose_into(result, proposal, stream);
+        return proposal;
+    }
+
+    virtual void propose_into(Observable const& result, Vector & proposal, aux::Stream & stream) {
+        static const Float constant = sqrt(aux::Scalar<Float>::pi()/2);
         // we multiply here by constant, and divide in the acceptance respectively
-        this->delta = sigma(result)*constant*abs(aux::nrandom());
-        return proposeIsotropic(result.state, aux::unitaryVector(this->D), this->delta, this->boundary);
+        this->delta = sigma(result)*constant*abs(aux::nrandom<Float>(stream));
+        aux::unitaryVector(direction, stream);
+        proposeIsotropic(result.state, direction, this->delta, this->boundary, proposal);
     }
 
     virtual double log_acceptance(Observable const& result, Observable const& result_prime) const {
         // we divide here by constant, and multiply in propose respectively
-        static const Float constant = sqrt(aux::pi/2);
-        return logAcceptanceIsotropic(sigma(result), sigma(result_prime), this->delta/constant);
+        static const Float constant = sqrt(aux::Scalar<Float>::pi()/2);
+        return logAcceptanceIsotropic<Float>(sigma(result), sigma(result_prime), this->delta/constant);
     }
+
+protected:
+    Vector direction;  // workspace of `propose_into`.
 };
 
 
 // Lyapunov proposal of http://journals.aps.org/pre/abstract/10.1103/PhysRevE.90.052916
 template <typename Observable>
-class LyapunovIsotropic : public Isotropic<Observable> {
+class LyapunovIsotropic final : public Isotropic<Observable> {
+public:
+    typedef typename Proposal<Observable>::Float Float;
+    typedef typename Proposal<Observable>::pair pair;
 protected:
     Float sigma0;
 public:
@@ -176,25 +340,27 @@ public:
         return sigma0/result.stretch();
     }
 
-    LyapunovIsotropic(std::vector<aux::pair> const& boundary, Float const& sigma0=10) :
+    LyapunovIsotropic(std::vector<pair> const& boundary, Float const& sigma0=10) :
             Isotropic<Observable>(boundary), sigma0(sigma0) {}
 };
 
 
 //! "Adaptive proposal" of http://journals.aps.org/prl/abstract/10.1103/PhysRevLett.110.220601
 template <typename Observable=observable::EscapeTime>
-class Adaptive : public Isotropic<Observable> {
+class Adaptive final : public Isotropic<Observable> {
     static_assert(
-            std::is_base_of<observable::EscapeTime, Observable>::value,
+            std::is_base_of<observable::generic::EscapeTime<typename Observable::Scalar, Observable::Dimension, typename Observable::MapType>, Observable>::value,
             "Observable must be a subclass of EscapeTime"
     );
-
+public:
+    typedef typename Proposal<Observable>::Float Float;
+    typedef typename Proposal<Observable>::pair pair;
 protected:
     Float _sigma;
     Float factor;
     Float max_sigma;
 public:
-    Adaptive(std::vector<aux::pair> const& boundary, Float const& factor = "1.1") :
+    Adaptive(std::vector<pair> const& boundary, Float const& factor = aux::from_string<Float>("1.1")) :
         Isotropic<Observable>(boundary), _sigma(1), factor(factor), max_sigma(10) {}
 
     virtual Float sigma(Observable const& result) const {
@@ -216,12 +382,18 @@ public:
 
 // Anisotropic proposal such that the proposal is isotropic in the end of the trajectory
 template <typename Observable=observable::EscapeWithMatrix>
-class Anisotropic : public Proposal<Observable> {
+class Anisotropic final : public Proposal<Observable> {
 public:
-    Anisotropic(std::vector<aux::pair> const& boundary) : Proposal<Observable>(boundary) {}
+    typedef typename Proposal<Observable>::Float Float;
+    typedef typename Proposal<Observable>::Vector Vector;
+    typedef typename Proposal<Observable>::pair pair;
+
+    using Proposal<Observable>::propose;
 
-    virtual Vector propose(Observable const& result) {
-        return proposeAnisotropic(result.state, result.jacobian, 10, this->boundary);
+    Anisotropic(std::vector<pair> const& boundary) : Proposal<Observable>(boundary) {}
+
+    virtual Vector propose(Observable const& result, aux::Stream & stream) {
+        return proposeAnisotropic<Float>(result.state, result.jacobian, 10, this->boundary, stream);
     };
 
     // We have not done the calculation for this acceptance.
@@ -232,6 +404,72 @@ public:
     }
 };
 
+
+//! Calls the methods of a proposal of type `P` known at compile time. As `map::Static`, the calls are not virtual
+//! for a `final` proposal (e.g. `proposal::Uniform<Observable>`), and virtual for any other one (e.g.
+//! `proposal::Proposal<Observable>`, the default of the samplers and optimizers, or `proposal::Isotropic`).
+template <typename P, bool Erased = not aux::is_final<P>::value>
+struct Static {
+    static_assert(aux::is_final<P>::value, "the calls are only devirtualized for final proposals");
+
+    typedef typename P::Vector Vector;
+
+    template <typename Observable>
+    static Vector propose(P & proposal, Observable const& result, aux::Stream & stream) {
+        return proposal.P::propose(result, stream);
+    }
+
+    template <typename Observable>
+    static void propose_into(P & proposal, Observable const& result, Vector & point, aux::Stream & stream) {
+        proposal.P::propose_into(result, point, stream);
+    }
+
+    template <typename Observable>
+    static double log_acceptance(P const& proposal, Observable const& result, Observable const& result_prime) {
+        return proposal.P::log_acceptance(result, result_prime);
+    }
+
+    template <typename Observable>
+    static double max_log_acceptance(P const& proposal, Observable const& result) {
+        return proposal.P::max_log_acceptance(result);
+    }
+
+    template <typename Observable>
+    static void update(P & proposal, Observable const& result, Observable const& result_prime) {
+        proposal.P::update(result, result_prime);
+    }
+};
+
+template <typename P>
+struct Static<P, true> {
+    typedef typename P::Vector Vector;
+
+    template <typename Observable>
+    static Vector propose(P & proposal, Observable const& result, aux::Stream & stream) {
+        return proposal.propose(result, stream);
+    }
+
+    template <typename Observable>
+    static void propose_into(P & proposal, Observable const& result, Vector & point, aux::Stream & stream) {
+        proposal.propose_into(result, point, stream);
+    }
+
+    template <typename Observable>
+    static double log_acceptance(P const& proposal, Observable const& result, Observable const& result_prime) {
+        return proposal.log_acceptance(result, result_prime);
+    }
+
+    template <typename Observable>
+    static double max_log_acceptance(P const& proposal, Observable const& result) {
+        return proposal.max_log_acceptance(result);
+    }
+
+    template <typename Observable>
+    static void update(P & proposal, Observable const& result, Observable const& result_prime) {
+        proposal.update(result, result_prime);
+    }
+};
+
 }
 
 #endif
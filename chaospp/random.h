@@ -0,0 +1,281 @@
+#ifndef chaospp_random_h
+#define chaospp_random_h
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CHAOSPP_RANDOM_X86
+#include <immintrin.h>
+#endif
+
+
+namespace aux {
+
+//! A stream of random numbers of the counter-based generator Philox4x32-10 (Salmon et al., "Parallel random numbers:
+//! as easy as 1, 2, 3", SC'11). The n-th block of 128 bits of the stream is a bijection of the counter (n, `id`) keyed
+//! by `seed`: the streams of different ids are independent, and a stream jumps to any position in O(1) (`seek`).
+//! A stream has no hidden global state and is used by one chain (or thread) at a time: the samplers and optimizers
+//! take theirs explicitly, and the functions without one use the stream of the calling thread (`local`).
+//! It is a `UniformRandomBitGenerator` of 64 bits, so it can also be used with the distributions of `<random>`.
+//! The numbers are drawn from a buffer of `buffer_words`, refilled by evaluating Philox on packs of counters with GCC/clang
+//! vector extensions, of the width of the CPU (AVX-512, AVX2 or SSE2).
+class Stream {
+public:
+    typedef std::uint64_t result_type;
+
+    static const unsigned int buffer_words = 128;
+
+    //! the ids from 2^63 on are reserved for `unique`.
+    explicit Stream(std::uint64_t seed = 0, std::uint64_t id = 0) :
+            _seed(seed), _id(id), _position(0), buffer_index(std::numeric_limits<std::uint64_t>::max()) {}
+
+    //! a stream with an id that no other stream of `unique` has.
+    static Stream unique(std::uint64_t seed = 0) {
+        static std::atomic<std::uint64_t> next(0);
+        return Stream(seed, (std::uint64_t(1) << 63) | next++);
+    }
+
+    //! the stream of the calling thread, used by the functions called without a stream (e.g. `aux::urandom<T>()`).
+    static Stream & local() {
+        static thread_local Stream stream = unique();
+        return stream;
+    }
+
+    static constexpr result_type min() {return 0;}
+    static constexpr result_type max() {return std::numeric_limits<result_type>::max();}
+
+    //! the next 64 random bits: the words `2n` and `2n + 1` of the stream are the block `n` of Philox.
+    result_type operator()() {
+        std::uint64_t index = _position/buffer_words;
+        if (index != buffer_index) {
+            philox_blocks(index*(buffer_words/2), buffer_words/2);
+            buffer_index = index;
+        }
+        return buffer[_position++ % buffer_words];
+    }
+
+    //! a uniform variate of [0, 1) with 53 random bits.
+    double uniform() {
+        return (std::int64_t) ((*this)() >> 11)*(1./9007199254740992.);
+    }
+
+    //! a standard normal variate, by the ziggurat method of 256 layers (Marsaglia and Tsang, 2000): 99% of them take
+    //! one number of the stream, a multiplication and a comparison.
+    double normal() {
+        Ziggurat const& z = ziggurat();
+        for (;;) {
+            // the layer in the lowest 8 bits, the sign in the 9th and the abscissa in the highest 53.
+            std::uint64_t bits = (*this)();
+            unsigned int layer = bits & 255;
+            double sign = 1 - (double) ((bits >> 7) & 2);
+            double x = (std::int64_t) (bits >> 11)*(1./9007199254740992.)*z.x[layer];
+            if (x < z.x[layer + 1])
+                return sign*x;
+            if (layer == 0) {
+                // the tail beyond r (Marsaglia, 1964)
+                double a, b;
+                do {
+                    a = -std::log(1 - uniform())/z.x[1];
+                    b = -std::log(1 - uniform());
+                } while (2*b < a*a);
+                return sign*(z.x[1] + a);
+            }
+            if (z.f[layer + 1] + uniform()*(z.f[layer] - z.f[layer + 1]) < std::exp(-x*x/2))
+                return sign*x;
+        }
+    }
+
+    //! writes `size` uniform variates of [0, 1) into `values`.
+    void uniforms(double * values, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++)
+            values[i] = uniform();
+    }
+
+    //! writes `size` standard normal variates into `values`.
+    void normals(double * values, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++)
+            values[i] = normal();
+    }
+
+    //! the number of 64 bits numbers drawn from the stream.
+    std::uint64_t position() const {
+        return _position;
+    }
+
+    //! moves the stream to `position` (see `position`).
+    void seek(std::uint64_t position) {
+        _position = position;
+    }
+
+    std::uint64_t seed() const {
+        return _seed;
+    }
+
+    std::uint64_t id() const {
+        return _id;
+    }
+
+    //! Philox4x32-10: encrypts `counter` with `key` (10 rounds).
+    static void philox(std::uint32_t counter[4], std::uint32_t const key[2]) {
+        std::uint32_t k0 = key[0], k1 = key[1];
+        for (unsigned int round = 0; round < 10; round++) {
+            std::uint64_t product0 = (std::uint64_t) 0xD2511F53 * counter[0];
+            std::uint64_t product1 = (std::uint64_t) 0xCD9E8D57 * counter[2];
+            std::uint32_t c1 = counter[1], c3 = counter[3];
+            counter[0] = (std::uint32_t) (product1 >> 32) ^ c1 ^ k0;
+            counter[1] = (std::uint32_t) product1;
+            counter[2] = (std::uint32_t) (product0 >> 32) ^ c3 ^ k1;
+            counter[3] = (std::uint32_t) product0;
+            k0 += 0x9E3779B9;
+            k1 += 0xBB67AE85;
+        }
+    }
+
+private:
+    std::uint64_t _seed, _id;
+    std::uint64_t _position;
+    std::uint64_t buffer[buffer_words];  // the words from `buffer_index*buffer_words` on.
+    std::uint64_t buffer_index;
+
+    //! the abscissas `x` of the layers of the ziggurat of exp(-x^2/2) and the ordinates `f` at them: x[1] = r is the start
+    //! of the tail, x[0] = v/f(r) the width of the base layer (of area v, the one of every layer), and x[256] = 0.
+    struct Ziggurat {
+        double x[257], f[257];
+
+        Ziggurat() {
+            double const r = 3.654152885361009, v = 0.004928673233974658;
+            x[1] = r;
+            x[0] = v/std::exp(-r*r/2);
+            for (unsigned int i = 1; i < 255; i++)
+                x[i + 1] = std::sqrt(-2*std::log(v/x[i] + std::exp(-x[i]*x[i]/2)));
+            x[256] = 0;
+            for (unsigned int i = 0; i <= 256; i++)
+                f[i] = std::exp(-x[i]*x[i]/2);
+        }
+    };
+
+    static Ziggurat const& ziggurat() {
+        static Ziggurat const table;
+        return table;
+    }
+
+    //! `Bytes/8` blocks, with each word of 32 bits of their counters in a lane of 64 bits: the products of Philox are
+    //! then the multiplications of 32 by 32 bits of the instruction set (`pmuludq`), which GCC does not find by itself.
+    template <int Bytes>
+    struct Pack {
+        typedef std::uint64_t Lanes __attribute__((vector_size(Bytes)));
+        static const int lanes = Bytes/8;
+    };
+
+    static inline void multiply(Pack<16>::Lanes const& words, std::uint64_t factor, Pack<16>::Lanes & product) {
+        #ifdef __SSE2__
+        product = (Pack<16>::Lanes) _mm_mul_epu32((__m128i) words, _mm_set1_epi64x(factor));
+        #else
+        product = words*factor;
+        #endif
+    }
+
+    #ifdef CHAOSPP_RANDOM_X86
+    __attribute__((target("avx2")))
+    static inline void multiply(Pack<32>::Lanes const& words, std::uint64_t factor, Pack<32>::Lanes & product) {
+        product = (Pack<32>::Lanes) _mm256_mul_epu32((__m256i) words, _mm256_set1_epi64x(factor));
+    }
+
+    __attribute__((target("avx512f")))
+    static inline void multiply(Pack<64>::Lanes const& words, std::uint64_t factor, Pack<64>::Lanes & product) {
+        product = (Pack<64>::Lanes) _mm512_maskz_mul_epu32(0xFF, (__m512i) words, _mm512_set1_epi64(factor));
+    }
+    #endif
+
+    //! Philox on 4 packs of `Bytes/8` blocks at a time (independent, so that their products overlap), from the block
+    //! `first` (`blocks` is a multiple of 32).
+    template <int Bytes>
+    static inline void philox_packs(std::uint64_t first, unsigned int blocks, std::uint64_t id, std::uint64_t seed,
+                                    std::uint64_t * words) {
+        typedef typename Pack<Bytes>::Lanes Lanes;
+        int const lanes = Pack<Bytes>::lanes, packs = 4;
+        std::uint64_t const low = 0xFFFFFFFF;
+        for (unsigned int b = 0; b < blocks; b += packs*lanes) {
+            Lanes c0[packs], c1[packs], c2[packs], c3[packs];
+            for (int p = 0; p < packs; p++) {
+                for (int l = 0; l < lanes; l++) {
+                    c0[p][l] = (first + b + p*lanes + l) & low;
+                    c1[p][l] = (first + b + p*lanes + l) >> 32;
+                }
+                c2[p] = Lanes{} + (id & low);
+                c3[p] = Lanes{} + (id >> 32);
+            }
+            std::uint64_t k0 = seed & low, k1 = seed >> 32;
+            for (unsigned int round = 0; round < 10; round++) {
+                #pragma GCC unroll 4
+                for (int p = 0; p < packs; p++) {
+                    Lanes product0, product1;
+                    multiply(c0[p], 0xD2511F53, product0);
+                    multiply(c2[p], 0xCD9E8D57, product1);
+                    c0[p] = (product1 >> 32) ^ c1[p] ^ k0;
+                    c1[p] = product1 & low;
+                    c2[p] = (product0 >> 32) ^ c3[p] ^ k1;
+                    c3[p] = product0 & low;
+                }
+                k0 = (k0 + 0x9E3779B9) & low;
+                k1 = (k1 + 0xBB67AE85) & low;
+            }
+            for (int p = 0; p < packs; p++) {
+                for (int l = 0; l < lanes; l++) {
+                    words[2*(b + p*lanes + l)] = c0[p][l] | c1[p][l] << 32;
+                    words[2*(b + p*lanes + l) + 1] = c2[p][l] | c3[p][l] << 32;
+                }
+            }
+        }
+    }
+
+    // `flatten` inlines `philox_packs` and `multiply` into the functions of each instruction set.
+    #ifdef CHAOSPP_RANDOM_X86
+    __attribute__((target("avx512f"), flatten))
+    static void philox_avx512(std::uint64_t first, unsigned int blocks, std::uint64_t id, std::uint64_t seed,
+                              std::uint64_t * words) {
+        philox_packs<64>(first, blocks, id, seed, words);
+    }
+
+    __attribute__((target("avx2"), flatten))
+    static void philox_avx2(std::uint64_t first, unsigned int blocks, std::uint64_t id, std::uint64_t seed,
+                            std::uint64_t * words) {
+        philox_packs<32>(first, blocks, id, seed, words);
+    }
+
+    static int detect_width() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+            return 64;
+        if (__builtin_cpu_supports("avx2"))
+            return 32;
+        return 16;
+    }
+    #endif
+
+    __attribute__((flatten))
+    static void philox_default(std::uint64_t first, unsigned int blocks, std::uint64_t id, std::uint64_t seed,
+                               std::uint64_t * words) {
+        philox_packs<16>(first, blocks, id, seed, words);
+    }
+
+    //! fills the buffer with the `blocks` blocks of the stream from `first`.
+    void philox_blocks(std::uint64_t first, unsigned int blocks) {
+        #ifdef CHAOSPP_RANDOM_X86
+        static int const width = detect_width();
+        if (width == 64)
+            return philox_avx512(first, blocks, _id, _seed, buffer);
+        if (width == 32)
+            return philox_avx2(first, blocks, _id, _seed, buffer);
+        #endif
+        philox_default(first, blocks, _id, _seed, buffer);
+    }
+};
+
+}
+
+#endif
@@ -2,6 +2,13 @@
 #define chaospp_sampler_h
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
 
 #include "proposal.h"
 #include "map.h"
@@ -50,6 +57,7 @@ public:
     }
 
     //! exports the best estimator of the normalized entropy, S(E) : \sum(\exp(S(E))) == 1
+    //! The bins of unknown (NaN) entropy are not exported.
     void export_entropy(std::string file_name, std::string directory="") const {
         std::vector<std::vector<double> > data;
 
@@ -69,12 +77,15 @@ public:
         // compute the normalization C:
         double sum = 0;
         for (unsigned int b = 0; b <= this->bins(); b++) {
-            sum += exp(entropy(b) - a_max);
+            if (not std::isnan(entropy(b)))
+                sum += exp(entropy(b) - a_max);
         }
         double C = a_max + log(sum);
 
         // export the entropy:
         for (unsigned int b = 0; b <= this->bins(); b++) {
+            if (std::isnan(entropy(b)))
+                continue;
             std::vector<double> row(2);
             row[0] = this->value(b);
             row[1] = entropy(b) - C;
@@ -85,54 +96,172 @@ public:
 };
 
 
+//! A `SamplingHistogram` of an observable with several values per state, `values()` (e.g. the FTLEs of the horizons
+//! and windows of `observable::MultiLyapunov`). The chain samples `observable()`; each measure also adds each of the
+//! values to its own histogram, with the bins of this one. They are weighted by exp(-log_pi) of the state, so that
+//! with a fixed `log_pi` they are the distributions of the values under the uniform distribution of the states.
+template <typename Observable>
+class MultiHistogram : public SamplingHistogram<Observable> {
+    typedef typename Observable::Type T;
+protected:
+    std::vector<std::vector<double> > weights;  // of each value in each bin
+    std::vector<double> totals;  // of each value
+public:
+    MultiHistogram(T lowerBound, T upperBound, unsigned int bins, unsigned int values) :
+            SamplingHistogram<Observable>(lowerBound, upperBound, bins),
+            weights(values, std::vector<double>(bins + 1, 0)), totals(values, 0) {}
+
+    virtual void measure(Observable const& result, Observable const& result_prime, double acceptance) {
+        SamplingHistogram<Observable>::measure(result, result_prime, acceptance);
+        double weight = exp(-this->log_pi[this->bin(result.observable())]);
+        std::vector<double> const& values = result.values();
+        assert(values.size() == weights.size());
+        for (unsigned int i = 0; i < weights.size(); i++) {
+            weights[i][this->bin(values[i])] += weight;
+            totals[i] += weight;
+        }
+    }
+
+    //! the number of values per state.
+    unsigned int values() const {
+        return (unsigned int) weights.size();
+    }
+
+    //! the probability of the `i`-th value to be in `bin`.
+    double distribution(unsigned int i, unsigned int bin) const {
+        return totals[i] > 0 ? weights[i][bin]/totals[i] : 0;
+    }
+
+    virtual void reset() {
+        SamplingHistogram<Observable>::reset();
+        for (unsigned int i = 0; i < weights.size(); i++) {
+            std::fill(weights[i].begin(), weights[i].end(), 0);
+            totals[i] = 0;
+        }
+    }
+
+    //! also adds the weights of the values of `other`, if it is a `MultiHistogram`.
+    virtual void merge(histogram::Histogram<T> const& other) {
+        SamplingHistogram<Observable>::merge(other);
+        MultiHistogram const* multi = dynamic_cast<MultiHistogram const*>(&other);
+        if (multi == nullptr)
+            return;
+        assert(multi->weights.size() == weights.size());
+        for (unsigned int i = 0; i < weights.size(); i++) {
+            for (unsigned int b = 0; b <= this->bins(); b++)
+                weights[i][b] += multi->weights[i][b];
+            totals[i] += multi->totals[i];
+        }
+    }
+
+    //! exports the histogram of the observable and, for the `i`-th value, "histogram_<i>_`file_name`".
+    virtual void export_histogram(std::string file_name, std::string directory="") const {
+        SamplingHistogram<Observable>::export_histogram(file_name, directory);
+        for (unsigned int i = 0; i < weights.size(); i++) {
+            std::vector<std::vector<double> > data;
+            for (unsigned int b = 0; b <= this->bins(); b++) {
+                if (weights[i][b] > 0) {
+                    std::vector<double> row(2);
+                    row[0] = this->value(b);
+                    row[1] = distribution(i, b);
+                    data.push_back(row);
+                }
+            }
+            io::save(data, directory + format("histogram_%d_", i) + file_name);
+        }
+    }
+};
+
+
 //! This is a general class that implements Metropolis-Hastings.
 //! It requires the observable over which the algorithm is going to be used,
 //! a proposal distribution,
 //! and an histogram that discretizes the observable and defines the sampling distribution.
-template <typename Observable>
+//! `Proposal` is the type of the proposal: a concrete proposal (e.g. `proposal::Uniform<Observable>`) is called
+//! without virtual dispatch (see `proposal::Static`).
+//! The chain is double-buffered: the sampler owns two copies of `observable`, the proposals are observed in the one
+//! that is not the current state, and the two are swapped on acceptance. With the built-in observables and proposals
+//! a Markov step does not allocate memory once the copies have the dimension of the states.
+//! The random numbers of the chain (its proposals, acceptances and the random numbers of its observations, see
+//! `Observable::set_stream`) are drawn from its own `stream`, so a chain is reproducible from its stream,
+//! independently of the other chains and threads. A chain is not copyable: its observables draw from its stream.
+template <typename Observable, typename Proposal = proposal::Proposal<Observable> >
 class MetropolisHastings {
+    static_assert(std::is_base_of<proposal::Proposal<Observable>, Proposal>::value,
+                  "Proposal must be a proposal::Proposal<Observable>");
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
 protected:
     typedef SamplingHistogram<Observable> Histogram;
-    typedef proposal::Proposal<Observable> Proposal;
+    typedef typename Observable::Vector Vector;
 
     Observable const& observable;
     Proposal & proposal;
     Histogram & histogram;
 
+    Observable slots[2];  // the current state of the chain and the proposal (see `transition`).
+    Vector point;  // stores the proposed states to avoid repeating allocations.
+
     //! returns log(pi'/pi) + log(g'/g)
     double log_acceptance(Observable const& result, Observable const& result_prime) const {
         unsigned int bin = histogram.bin(result.observable());
         unsigned int bin_prime = histogram.bin(result_prime.observable());
 
         double delta = histogram.log_pi[bin_prime] - histogram.log_pi[bin];
-        return delta + this->proposal.log_acceptance(result, result_prime);
+        return delta + proposal::Static<Proposal>::log_acceptance(this->proposal, result, result_prime);
     }
 
 public:
 
-    MetropolisHastings(Observable const& observable, Proposal & proposal, Histogram & histogram) :
-            observable(observable), proposal(proposal), histogram(histogram) {}
+    //! whether the Markov steps reject a proposal as soon as its value can only be rejected (see `early_transition`).
+    //! The observation of a monotone observable (e.g. the escape time) then stops there, when its values cannot be
+    //! above the range of the histogram (`Observable::max_value`). The chain is the same, with the same random
+    //! numbers, but `measure` gets the proposals rejected before their end as observed up to there, with an
+    //! acceptance of 0: the measures that use the proposal or the acceptance (and not only the state) need it false.
+    //! False by default.
+    bool early_rejection;
+
+    //! the random numbers of the chain.
+    aux::Stream stream;
+
+    //! by default, the chain has a stream of its own (`aux::Stream::unique`).
+    MetropolisHastings(Observable const& observable, Proposal & proposal, Histogram & histogram,
+                       aux::Stream const& stream = aux::Stream::unique()) :
+            observable(observable), proposal(proposal), histogram(histogram), slots{observable, observable},
+            early_rejection(false), stream(stream) {
+        slots[0].set_stream(this->stream);
+        slots[1].set_stream(this->stream);
+    }
+
+    MetropolisHastings(MetropolisHastings const&) = delete;
+    MetropolisHastings & operator=(MetropolisHastings const&) = delete;
 
     virtual void measure(Observable const& result, Observable const& result_prime, double acceptance) {
         histogram.measure(result, result_prime, acceptance);
     }
 
-    inline Observable propose(Observable & result) {
-        // generate point x' and observables E'
-        Observable result_prime(result);
-        result_prime.observe(proposal.propose(result));
+    //! observes a proposal from `result` in `result_prime`.
+    inline void propose(Observable & result, Observable & result_prime) {
+        // the proposals above the range of the histogram are re-proposed: their observation can stop there.
+        result_prime.set_upper_bound(histogram.upper_bound());
+        this->observe_proposal(result, result_prime);
+    }
 
-        proposal.update(result, result_prime);
+    //! a Markov step from `result`, with the proposal observed in the slot that is not `result`.
+    //! Returns the state of the chain after the step: the slot of the proposal if it was accepted, else `result`.
+    Observable & transition(Observable & result, bool measure=true) {
+        if (early_rejection)
+            return this->early_transition(result, measure);
 
-        while (histogram.invalid_value(result_prime.observable())) {
-            result_prime.observe(proposal.propose(result));
-        }
-        return result_prime;
-    }
+        aux::Arena::Step step;
+        Observable & result_prime = &result == &slots[0] ? slots[1] : slots[0];
+
+        // the uniform variate is drawn first, as in `early_transition`.
+        double u = stream.uniform();
 
-    void markov_step(Observable & result, bool measure=true) {
         // generate proposal
-        Observable result_prime(this->propose(result));
+        this->propose(result, result_prime);
 
         // compute acceptance
         double log_acceptance = this->log_acceptance(result, result_prime);
@@ -143,8 +272,16 @@ public:
             this->measure(result, result_prime, acceptance);
 
         // accept/reject
-        if (aux::urandom() < acceptance)
-            result = result_prime;
+        if (u < acceptance)
+            return result_prime;
+        return result;
+    }
+
+    //! a Markov step of `result`, which is assigned the proposal if it is accepted.
+    void markov_step(Observable & result, bool measure=true) {
+        Observable & next = this->transition(result, measure);
+        if (&next != &result)
+            result = next;
     }
 
     //! performs a round-trip, from minBin to maxBin.
@@ -167,48 +304,110 @@ public:
     }
 
     virtual void sample(unsigned int total_samples, unsigned int convergence_samples=0) {
-        Observable result(observable);
-        result.observe(this->proposal.proposeUniform());
+        Observable * result = &this->initial_state();
 
         // reach assymptotic distribution
         for(unsigned int sample = 0; sample < convergence_samples; sample++)
-            this->markov_step(result, false);
+            result = &this->transition(*result, false);
 
         // sample
         for (unsigned int sample = 0; sample < total_samples; sample++) {
-            this->markov_step(result);
+            result = &this->transition(*result);
+        }
+    }
+
+protected:
+    //! observes proposals from `result` in `result_prime` until one is in the range of the histogram (the values
+    //! above it are where the observations stop, see `Observable::set_upper_bound`). `Proposal::update` gets the
+    //! first one.
+    void observe_proposal(Observable & result, Observable & result_prime) {
+        // generate point x' and observables E'
+        proposal::Static<Proposal>::propose_into(proposal, result, point, stream);
+        result_prime.observe(point);
+
+        proposal::Static<Proposal>::update(proposal, result, result_prime);
+
+        while (histogram.invalid_value(result_prime.observable())) {
+            proposal::Static<Proposal>::propose_into(proposal, result, point, stream);
+            result_prime.observe(point);
         }
     }
+
+    //! the first bin from which the proposals from `result` are rejected with the uniform variate exp(`log_u`): the
+    //! acceptance of the values from it on is below the variate (with `Proposal::max_log_acceptance`).
+    unsigned int rejected_bin(Observable const& result, double log_u) const {
+        double log_pi = histogram.log_pi[histogram.bin(result.observable())];
+        double max_log_acceptance = proposal::Static<Proposal>::max_log_acceptance(proposal, result);
+
+        unsigned int bin = histogram.bins();
+        while (bin > 0 and histogram.log_pi[bin - 1] - log_pi + max_log_acceptance <= log_u)
+            bin--;
+        return bin;
+    }
+
+    //! `transition` with `early_rejection`: the uniform variate is turned into the first value that is rejected,
+    //! where the observation of the proposal stops. As in `transition`, the proposals out of the range of the
+    //! histogram are re-proposed, so the observations stop before its end only when their values cannot be above
+    //! it: a value where an observation stopped could otherwise be out of the range.
+    Observable & early_transition(Observable & result, bool measure) {
+        aux::Arena::Step step;
+        Observable & result_prime = &result == &slots[0] ? slots[1] : slots[0];
+
+        double u = stream.uniform();
+        unsigned int rejected_bin = histogram.bins();
+        if (result_prime.max_value() < histogram.upper_bound())
+            rejected_bin = std::max(1u, this->rejected_bin(result, log(u)));  // bin 0 has the values below the range.
+        result_prime.set_upper_bound(histogram.first_value(rejected_bin));
+        this->observe_proposal(result, result_prime);
+
+        // a value from `rejected_bin` on may be where the observation stopped: it is rejected without its acceptance.
+        double acceptance = 0;
+        if (histogram.bin(result_prime.observable()) < rejected_bin)
+            acceptance = std::min(1.0, exp(this->log_acceptance(result, result_prime)));
+
+        if (measure)
+            this->measure(result, result_prime, acceptance);
+
+        if (u < acceptance)
+            return result_prime;
+        return result;
+    }
+
+    //! the first slot, observed at a uniform state.
+    Observable & initial_state() {
+        proposal.proposeUniform(point, stream);
+        slots[0].observe(point);
+        return slots[0];
+    }
 };
 
 
-template <typename Observable>
-class WangLandau : public MetropolisHastings<Observable> {
+template <typename Observable, typename Proposal = proposal::Proposal<Observable> >
+class WangLandau : public MetropolisHastings<Observable, Proposal> {
 protected:
     typedef SamplingHistogram<Observable> Histogram;
-    typedef proposal::Proposal<Observable> Proposal;
 
     double f;
 public:
 
-    WangLandau(Observable const& observable, Proposal & proposal, Histogram & histogram) :
-            MetropolisHastings<Observable>(observable, proposal, histogram), f(1) {}
+    WangLandau(Observable const& observable, Proposal & proposal, Histogram & histogram,
+               aux::Stream const& stream = aux::Stream::unique()) :
+            MetropolisHastings<Observable, Proposal>(observable, proposal, histogram, stream), f(1) {}
 
     virtual void measure(Observable const& result, Observable const& result_prime, double acceptance) {
-        MetropolisHastings<Observable>::measure(result, result_prime, acceptance);
+        MetropolisHastings<Observable, Proposal>::measure(result, result_prime, acceptance);
 
         unsigned int bin = this->histogram.bin(result.observable());
         this->histogram.log_pi[bin] -= f; // Wang-Landau step (S+=f <=> log_pi-=f)
     }
 
     void sample(unsigned int steps, unsigned int total_samples) {
-        Observable result(this->observable);
-        result.observe(this->proposal.proposeUniform());
+        Observable * result = &this->initial_state();
 
         for (unsigned int step = 0; step < steps; step++) {
             this->histogram.reset();
             for (unsigned int sample = 0; sample < total_samples; sample++) {
-                this->markov_step(result);
+                result = &this->transition(*result);
             }
             f /= 2;
         }
@@ -216,7 +415,8 @@ public:
 
     void approximate_entropy(unsigned int steps, unsigned int round_trips) {
         Observable result(this->observable);
-        result.observe(this->proposal.proposeUniform());
+        result.set_stream(this->stream);
+        result.observe(this->proposal.proposeUniform(this->stream));
 
         for (unsigned int step = 0; step < steps; step++) {
             this->histogram.reset();
@@ -229,4 +429,607 @@ public:
     }
 };
 
+
+//! Wang-Landau with several walkers, each in a thread of its own, that estimate one density of states.
+//! Each walker is a `WangLandau` chain with its own copies of the proposal and of the histogram, and its own stream
+//! (`aux::Stream(seed, first_stream + walker)`). Every `sync` steps, a walker adds its visits to counts shared by all
+//! of them, without locks (atomic additions), and sets its log_pi from them: log_pi = (log_pi at the start of the
+//! stage) - f*(visits of all the walkers in the stage). A stage ends, and f is halved, when the walkers made `samples`
+//! steps together and, if `flatness` > 0, their visits are flat. With one walker, it is `WangLandau` with the stream
+//! `aux::Stream(seed)`.
+//! The walkers start with the precision of MPFR and the arena of the thread that calls `sample`.
+template <typename Observable, typename Proposal, typename Histogram = SamplingHistogram<Observable> >
+class ParallelWangLandau {
+    static_assert(std::is_base_of<SamplingHistogram<Observable>, Histogram>::value,
+                  "Histogram must be a SamplingHistogram<Observable>");
+protected:
+    //! the state shared by the walkers during a stage.
+    struct Shared {
+        std::vector<double> log_pi;  // at the start of the stage
+        std::vector<std::atomic<unsigned long> > visits;  // of all the walkers in the stage
+        std::vector<bool> in_range;  // the bins with valid values (an initial state may be out of the range)
+        std::atomic<unsigned long> steps;  // claimed by the walkers, `sync` at a time
+        std::atomic<bool> done;
+        double f;
+        unsigned long samples;
+        unsigned int sync;
+        double flatness;
+
+        Shared(Histogram const& histogram) : log_pi(histogram.bins() + 1), visits(histogram.bins() + 1),
+                in_range(histogram.bins() + 1), steps(0), done(false) {
+            for (unsigned int bin = 0; bin <= histogram.bins(); bin++) {
+                typename Observable::Type value = histogram.value(bin);
+                in_range[bin] = not histogram.invalid_value(value + (histogram.value(bin + 1) - value)/2);
+            }
+        }
+
+        //! whether the least visited bin of the visited ones in the range has `flatness` times their mean visits.
+        bool flat() const {
+            if (flatness == 0)
+                return true;
+            unsigned long least = std::numeric_limits<unsigned long>::max(), total = 0;
+            unsigned int visited = 0;
+            for (unsigned int bin = 0; bin < visits.size(); bin++) {
+                unsigned long count = visits[bin].load(std::memory_order_relaxed);
+                if (count > 0 and in_range[bin]) {
+                    least = std::min(least, count);
+                    total += count;
+                    visited++;
+                }
+            }
+            return visited > 0 and least >= flatness*total/visited;
+        }
+    };
+
+    //! the proposal and the histogram of a walker, constructed before its chain.
+    struct Copies {
+        Proposal own_proposal;
+        Histogram own_histogram;
+
+        Copies(Proposal const& proposal, Histogram const& histogram) :
+                own_proposal(proposal), own_histogram(histogram) {}
+    };
+
+    class Walker : protected Copies, public WangLandau<Observable, Proposal> {
+        Observable * state;
+        std::vector<unsigned long> visits;  // not yet added to the shared ones
+    public:
+        Walker(Observable const& observable, Proposal const& proposal, Histogram const& histogram,
+               aux::Stream const& stream) :
+                Copies(proposal, histogram),
+                WangLandau<Observable, Proposal>(observable, this->own_proposal, this->own_histogram, stream),
+                state(nullptr), visits(histogram.bins() + 1, 0) {}
+
+        Histogram const& local_histogram() const {
+            return this->own_histogram;
+        }
+
+        virtual void measure(Observable const& result, Observable const& result_prime, double acceptance) {
+            WangLandau<Observable, Proposal>::measure(result, result_prime, acceptance);
+            visits[this->histogram.bin(result.observable())]++;
+        }
+
+        //! the state of the chain (after a first `run`, or `start_from`).
+        Observable & current() {
+            assert(state != nullptr);
+            return *state;
+        }
+
+        //! continues the chain from a copy of `start`.
+        void start_from(Observable const& start) {
+            this->slots[0] = start;
+            state = &this->slots[0];
+        }
+
+        //! starts a stage: the histogram is reset, and log_pi and f are the ones of the stage.
+        void begin(Shared const& shared) {
+            this->own_histogram.reset();
+            this->own_histogram.log_pi = shared.log_pi;
+            this->f = shared.f;
+        }
+
+        //! at most `limit` Markov steps of the walker in the stage (all of them with 0), until it ends.
+        void run(Shared & shared, unsigned long limit = 0) {
+            if (state == nullptr)
+                state = &this->initial_state();
+
+            unsigned long made = 0;
+            while (not shared.done and (limit == 0 or made < limit)) {
+                unsigned long steps = limit == 0 ? shared.sync : std::min<unsigned long>(shared.sync, limit - made);
+                unsigned long first = shared.steps.fetch_add(steps);
+                if (shared.flatness == 0) {
+                    // exactly `samples` steps
+                    if (first >= shared.samples)
+                        break;
+                    steps = std::min(steps, shared.samples - first);
+                }
+                for (unsigned long step = 0; step < steps; step++)
+                    state = &this->transition(*state);
+                made += steps;
+                publish(shared);
+                if (first + steps >= shared.samples and shared.flat())
+                    shared.done = true;
+            }
+        }
+
+    protected:
+        //! adds the visits to the shared ones, and sets log_pi from them.
+        void publish(Shared & shared) {
+            std::vector<double> & log_pi = this->own_histogram.log_pi;
+            for (unsigned int bin = 0; bin < visits.size(); bin++) {
+                if (visits[bin] > 0) {
+                    shared.visits[bin].fetch_add(visits[bin], std::memory_order_relaxed);
+                    visits[bin] = 0;
+                }
+                log_pi[bin] = shared.log_pi[bin] - shared.f*shared.visits[bin].load(std::memory_order_relaxed);
+            }
+        }
+    };
+
+    Histogram & histogram;
+    std::vector<std::unique_ptr<Walker> > _walkers;
+    Shared shared;
+    double f;
+
+public:
+    //! the steps of a walker between two additions of its visits to the shared ones.
+    unsigned int sync;
+
+    //! the ratio between the least visits and the mean visits of the visited bins for a stage to end (e.g. 0.8).
+    //! With 0 (the default), the stages end after `samples` steps, as in `WangLandau::sample`.
+    double flatness;
+
+    //! whether the walkers reject the proposals out of the range instead of re-proposing them (see
+    //! `MetropolisHastings::early_rejection`). False by default.
+    bool early_rejection;
+
+    ParallelWangLandau(Observable const& observable, Proposal const& proposal, Histogram & histogram,
+                       unsigned int walkers, std::uint64_t seed = 0, std::uint64_t first_stream = 0) :
+            histogram(histogram), shared(histogram), f(1), sync(64), flatness(0), early_rejection(false) {
+        for (unsigned int walker = 0; walker < walkers; walker++)
+            _walkers.push_back(std::unique_ptr<Walker>(
+                    new Walker(observable, proposal, histogram, aux::Stream(seed, first_stream + walker))));
+    }
+
+    unsigned int walkers() const {
+        return (unsigned int) _walkers.size();
+    }
+
+    //! the modification factor of the next stage.
+    double modification_factor() const {
+        return f;
+    }
+
+    //! `stages` stages with f halved after each, as `WangLandau::sample`. `histogram` ends with the visits of all the
+    //! walkers in the last stage, and with the log_pi they estimated.
+    void sample(unsigned int stages, unsigned long samples) {
+        mpfr_prec_t precision = mpfr::mpreal::get_default_prec();
+        bool arena = aux::Arena::is_enabled();
+
+        for (unsigned int stage = 0; stage < stages; stage++) {
+            begin_stage(samples);
+            std::vector<std::thread> threads;
+            for (unsigned int w = 0; w < _walkers.size(); w++) {
+                threads.push_back(std::thread([this, w, precision, arena]() {
+                    mpfr::mpreal::set_default_prec(precision);
+                    if (arena)
+                        aux::Arena::enable();
+                    run(w);
+                }));
+            }
+            for (unsigned int w = 0; w < threads.size(); w++)
+                threads[w].join();
+            end_stage();
+        }
+    }
+
+    // The steps of `sample`, for the samplers that schedule the walkers themselves (`ReplicaExchangeWangLandau`).
+
+    //! starts a stage of `samples` steps of all the walkers together.
+    void begin_stage(unsigned long samples) {
+        shared.log_pi = histogram.log_pi;
+        for (unsigned int bin = 0; bin < shared.visits.size(); bin++)
+            shared.visits[bin] = 0;
+        shared.steps = 0;
+        shared.done = false;
+        shared.f = f;
+        shared.samples = samples;
+        shared.sync = sync;
+        shared.flatness = flatness;
+        for (unsigned int w = 0; w < _walkers.size(); w++) {
+            _walkers[w]->early_rejection = early_rejection;
+            _walkers[w]->begin(shared);
+        }
+    }
+
+    //! at most `steps` Markov steps of `walker` in the stage (all of its steps with 0). The walkers can run in
+    //! different threads at the same time.
+    void run(unsigned int walker, unsigned long steps = 0) {
+        _walkers[walker]->run(shared, steps);
+    }
+
+    //! whether the stage ended (the walkers made its steps and, with `flatness`, their visits are flat).
+    bool stage_done() const {
+        return shared.done;
+    }
+
+    //! ends the stage: merges the walkers into `histogram` and halves f.
+    void end_stage() {
+        histogram.reset();
+        for (unsigned int w = 0; w < _walkers.size(); w++)
+            histogram.merge(_walkers[w]->local_histogram());
+        for (unsigned int bin = 0; bin < shared.visits.size(); bin++)
+            histogram.log_pi[bin] = shared.log_pi[bin] - f*shared.visits[bin];
+        f /= 2;
+    }
+
+    //! the state of `walker`, which can be changed between the calls to `run`.
+    Observable & state(unsigned int walker) {
+        return _walkers[walker]->current();
+    }
+
+    //! continues `walker` from a copy of `start` (by default, the walkers start at a uniform state).
+    void start_from(unsigned int walker, Observable const& start) {
+        _walkers[walker]->start_from(start);
+    }
+
+    //! the histogram of `walker` in the stage, with the log_pi that it samples.
+    Histogram const& walker_histogram(unsigned int walker) const {
+        return _walkers[walker]->local_histogram();
+    }
+};
+
+
+//! Replica-exchange Wang-Landau (Vogel et al., "Generic, hierarchical framework for massively parallel Wang-Landau
+//! sampling", PRL 110, 210603 (2013)). The valid bins of `histogram` are split into `windows` overlapping windows
+//! (by the fraction `overlap` of their width), each sampled by a `ParallelWangLandau` of `walkers` walkers, with
+//! stages of its own, that reject the proposals out of the window (`early_rejection`). All the walkers run together
+//! in a pool of threads, in rounds of `exchange_steps` steps; after each round, the walkers of neighboring windows try
+//! to swap their states (the pairs of even windows and of odd windows in alternate rounds). A state then diffuses
+//! through the windows instead of through the whole range, which is what makes the round trips of the long escape
+//! times short. The walkers of a window start from a state of the window below that is in its range, found by a
+//! Wang-Landau climb before the first round.
+//! `sample` ends with the entropies of the windows stitched into `histogram` (`set_entropy`, and log_pi = -entropy,
+//! see `stitch`), so that `histogram.export_entropy` exports the normalized entropy of the range of the windows.
+//! The walker `k` of the window `w` has the stream `aux::Stream(seed, w*walkers + k)`, and the swaps
+//! `aux::Stream(seed, windows*walkers)`.
+template <typename Observable, typename Proposal>
+class ReplicaExchangeWangLandau {
+protected:
+    typedef SamplingHistogram<Observable> Histogram;
+    typedef ParallelWangLandau<Observable, Proposal> Window;
+
+    //! threads that run a task each in rounds: `run` wakes them, and returns when all of them finished the task.
+    //! They have the precision of MPFR and the arena of the thread that constructs the pool.
+    class Pool {
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable wake, finished;
+        std::function<void(unsigned int)> task;
+        unsigned long round;
+        unsigned int pending;
+        bool stop;
+
+    public:
+        Pool(unsigned int size) : round(0), pending(0), stop(false) {
+            mpfr_prec_t precision = mpfr::mpreal::get_default_prec();
+            bool arena = aux::Arena::is_enabled();
+            for (unsigned int t = 0; t < size; t++)
+                threads.push_back(std::thread([this, t, precision, arena]() {
+                    mpfr::mpreal::set_default_prec(precision);
+                    if (arena)
+                        aux::Arena::enable();
+                    unsigned long seen = 0;
+                    while (true) {
+                        {
+                            std::unique_lock<std::mutex> lock(mutex);
+                            wake.wait(lock, [this, &seen]() {return stop or round != seen;});
+                            if (stop)
+                                return;
+                            seen = round;
+                        }
+                        task(t);
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (--pending == 0)
+                            finished.notify_one();
+                    }
+                }));
+        }
+
+        ~Pool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            wake.notify_all();
+            for (unsigned int t = 0; t < threads.size(); t++)
+                threads[t].join();
+        }
+
+        //! runs `task(t)` in each thread `t`.
+        void run(std::function<void(unsigned int)> const& task) {
+            std::unique_lock<std::mutex> lock(mutex);
+            this->task = task;
+            pending = (unsigned int) threads.size();
+            round++;
+            wake.notify_all();
+            finished.wait(lock, [this]() {return pending == 0;});
+        }
+    };
+
+    Observable const& observable;
+    Proposal const& proposal;
+    Histogram & histogram;
+    std::vector<unsigned int> first_bins, last_bins;  // of `histogram` in each window
+    std::vector<std::unique_ptr<Histogram> > _histograms;  // of the windows
+    std::vector<std::unique_ptr<Window> > _windows;
+    unsigned int _walkers;
+    bool started;  // whether the walkers have their initial states
+
+    std::vector<unsigned long> attempts, swaps;  // between each window and the next
+    std::vector<unsigned int> replicas;  // the replica of each walker (w*walkers + k), swapped with the states
+    std::vector<int> progress;  // of each replica: 1 after the first bin, 2 after the last bin from the first
+    unsigned long _round_trips, rounds;
+
+    //! the histogram of the bins `first` to `last` of `histogram`, with the same bins. Its bin `b - first + 1` is the
+    //! bin `b`, and its bin 0, below its range, is the bin `first - 1` (of valid values with a continuous type).
+    Histogram * window_histogram(unsigned int first, unsigned int last) const {
+        return new Histogram(histogram.value(first - 1), histogram.value(last + 1), last - first + 2);
+    }
+
+    //! whether `value` is in the range of the window `w`.
+    bool in_window(unsigned int w, typename Observable::Type value) const {
+        return not _histograms[w]->invalid_value(value);
+    }
+
+    //! the walkers of each window start from a state of the window below in its range, found by Wang-Landau.
+    //! Throws `std::runtime_error` if a window is not reached in `max_climb_steps` steps (e.g. above `max_time`).
+    void start() {
+        Proposal climbing_proposal(proposal);
+        Observable current(observable);
+        current.set_stream(stream);
+        current.observe(climbing_proposal.proposeUniform(stream));
+        for (unsigned int w = 1; w < _windows.size(); w++) {
+            Histogram climbing_histogram(*_histograms[w - 1]);
+            WangLandau<Observable, Proposal> climber(observable, climbing_proposal, climbing_histogram, stream);
+            climber.early_rejection = true;
+            Observable * state = &current;
+            for (unsigned long step = 0; not in_window(w, state->observable()); step++) {
+                if (step == max_climb_steps)
+                    throw std::runtime_error(format("ReplicaExchangeWangLandau: window %d not reached in %lu steps",
+                                                    w, max_climb_steps));
+                state = &climber.transition(*state);
+            }
+            if (state != &current)
+                current = *state;
+            stream = climber.stream;
+            for (unsigned int k = 0; k < _walkers; k++)
+                _windows[w]->start_from(k, current);
+        }
+        started = true;
+    }
+
+    //! tries to swap the states of the walker `a` of the window `w` and the walker `b` of the window `w + 1`.
+    void exchange(unsigned int w, unsigned int a, unsigned int b) {
+        Observable & x = _windows[w]->state(a);
+        Observable & y = _windows[w + 1]->state(b);
+        if (not in_window(w, y.observable()) or not in_window(w + 1, x.observable()))
+            return;
+        attempts[w]++;
+
+        // the ratio of the sampling distributions of the two windows after and before the swap
+        Histogram const& lower = _windows[w]->walker_histogram(a);
+        Histogram const& upper = _windows[w + 1]->walker_histogram(b);
+        double log_acceptance = lower.log_pi[lower.bin(y.observable())] - lower.log_pi[lower.bin(x.observable())] +
+                                upper.log_pi[upper.bin(x.observable())] - upper.log_pi[upper.bin(y.observable())];
+        if (stream.uniform() >= exp(log_acceptance))
+            return;
+
+        Observable swap(x);
+        x = y;
+        y = swap;
+        std::swap(replicas[w*_walkers + a], replicas[(w + 1)*_walkers + b]);
+        swaps[w]++;
+    }
+
+    //! counts the replicas that came back to the first bin of the range from the last one (as
+    //! `MetropolisHastings::round_trip`), with their states between the rounds.
+    void count_round_trips() {
+        for (unsigned int i = 0; i < replicas.size(); i++) {
+            unsigned int bin = histogram.bin(_windows[i/_walkers]->state(i % _walkers).observable());
+            int & replica = progress[replicas[i]];
+            if (bin == first_bins.front()) {
+                if (replica == 2)
+                    _round_trips++;
+                replica = 1;
+            }
+            else if (bin == last_bins.back() and replica == 1)
+                replica = 2;
+        }
+    }
+
+    //! the entropies of the windows, each shifted to the mean of the one below in their overlap, and joined at its
+    //! middle, into the bins `first_bin(0)` to `last_bin(windows() - 1)` of `histogram`. The bins of the range that no
+    //! window visited (or that are above a window that shares no visited bin with the one below) have a NaN entropy
+    //! and keep their log_pi. The bins out of the range keep the entropy and the log_pi of `histogram`.
+    void stitch() {
+        std::vector<double> entropy(histogram.bins() + 1, std::numeric_limits<double>::quiet_NaN());
+        for (unsigned int bin = 0; bin <= histogram.bins(); bin++) {
+            if (bin < first_bins.front() or bin > last_bins.back())
+                entropy[bin] = histogram.entropy(bin);
+        }
+
+        double shift = 0;
+        std::vector<double> below;  // of the window below, shifted
+        for (unsigned int w = 0; w < _windows.size(); w++) {
+            Histogram const& window = *_histograms[w];
+            unsigned int offset = first_bins[w] - 1;  // the bin of `histogram` of the bin 0 of the window
+            std::vector<double> current(histogram.bins() + 1, std::numeric_limits<double>::quiet_NaN());
+            for (unsigned int bin = 0; bin < window.bins(); bin++) {
+                typename Observable::Type value = window.value(bin);
+                if (in_window(w, value + (window.value(bin + 1) - value)/2) and std::isfinite(window.entropy(bin)))
+                    current[bin + offset] = window.entropy(bin);
+            }
+
+            unsigned int join = offset;
+            if (w > 0) {
+                double sum = 0;
+                unsigned int first = 0, last = 0, overlap = 0;
+                for (unsigned int bin = offset; bin <= last_bins[w - 1]; bin++) {
+                    if (std::isnan(current[bin]) or std::isnan(below[bin]))
+                        continue;
+                    sum += below[bin] - current[bin];
+                    if (overlap++ == 0)
+                        first = bin;
+                    last = bin;
+                }
+                // the window cannot be aligned with the one below, nor the ones above with it.
+                if (overlap == 0)
+                    break;
+                shift = sum/overlap;
+                join = (first + last + 1)/2;
+            }
+            for (unsigned int bin = 0; bin < current.size(); bin++) {
+                current[bin] += shift;
+                if (bin >= join and not std::isnan(current[bin]))
+                    entropy[bin] = current[bin];
+            }
+            below = current;
+        }
+
+        histogram.reset();
+        histogram.set_entropy(entropy);
+        for (unsigned int bin = first_bins.front(); bin <= last_bins.back(); bin++) {
+            if (std::isfinite(entropy[bin]))
+                histogram.log_pi[bin] = -entropy[bin];
+        }
+    }
+
+public:
+    //! the steps of each walker between two rounds of swaps.
+    unsigned int exchange_steps;
+
+    //! the steps of a walker between two additions of its visits to the ones of its window
+    //! (see `ParallelWangLandau::sync`).
+    unsigned int sync;
+
+    //! the flatness for a stage of a window to end (see `ParallelWangLandau::flatness`); 0 by default.
+    double flatness;
+
+    //! the random numbers of the swaps.
+    aux::Stream stream;
+
+    //! the steps of the Wang-Landau climb from a window to the next before the first round (see `start`).
+    unsigned long max_climb_steps;
+
+    //! `overlap` is the fraction of the width of a window that it shares with the next (e.g. 0.75).
+    ReplicaExchangeWangLandau(Observable const& observable, Proposal const& proposal, Histogram & histogram,
+                              unsigned int windows, double overlap, unsigned int walkers, std::uint64_t seed = 0) :
+            observable(observable), proposal(proposal), histogram(histogram), _walkers(walkers), started(false),
+            attempts(windows - 1, 0), swaps(windows - 1, 0), replicas(windows*walkers), progress(windows*walkers, 0),
+            _round_trips(0), rounds(0), exchange_steps(4), sync(64), flatness(0),
+            stream(seed, windows*walkers), max_climb_steps(1000000) {
+        assert(windows > 0 and walkers > 0 and 0 < overlap and overlap < 1);
+        // the valid bins 1 to bins - 1 in windows of `width` bins, each starting `width*(1 - overlap)` after the last
+        unsigned int bins = histogram.bins() - 1;
+        double width = bins/(1 + (windows - 1)*(1 - overlap));
+        for (unsigned int w = 0; w < windows; w++) {
+            unsigned int first = 1 + (unsigned int) (w*width*(1 - overlap) + 0.5);
+            unsigned int last = w + 1 == windows ? bins : std::min(bins, first + (unsigned int) std::ceil(width) - 1);
+            assert(w == 0 or (first > first_bins.back() and first <= last_bins.back()));
+            first_bins.push_back(first);
+            last_bins.push_back(last);
+            _histograms.push_back(std::unique_ptr<Histogram>(window_histogram(first, last)));
+            _windows.push_back(std::unique_ptr<Window>(
+                    new Window(observable, proposal, *_histograms.back(), walkers, seed, w*walkers)));
+        }
+        for (unsigned int i = 0; i < replicas.size(); i++)
+            replicas[i] = i;
+    }
+
+    unsigned int windows() const {
+        return (unsigned int) _windows.size();
+    }
+
+    //! the histogram of the window `w`, with the visits of its last stage and its log_pi.
+    Histogram const& window(unsigned int w) const {
+        return *_histograms[w];
+    }
+
+    //! the bins of `histogram` of the window `w`, from `first_bin(w)` to `last_bin(w)`.
+    unsigned int first_bin(unsigned int w) const {
+        return first_bins[w];
+    }
+
+    unsigned int last_bin(unsigned int w) const {
+        return last_bins[w];
+    }
+
+    //! the fraction of the attempted swaps between the window `w` and the next that were accepted.
+    double exchange_rate(unsigned int w) const {
+        return attempts[w] > 0 ? swaps[w]/(double) attempts[w] : 0;
+    }
+
+    //! the replicas that went from the first bin of the range to the last and back in the last `sample`.
+    unsigned long round_trips() const {
+        return _round_trips;
+    }
+
+    //! the mean steps of a walker per round trip of a replica in the last `sample` (0 without round trips). The windows
+    //! that end their stages first wait for the others, so it is best measured with `flatness` = 0.
+    double round_trip_steps() const {
+        return _round_trips > 0 ? rounds*(double) exchange_steps*replicas.size()/_round_trips : 0;
+    }
+
+    //! `stages` stages in each window (see `ParallelWangLandau::sample`), until the last window ends its last stage.
+    void sample(unsigned int stages, unsigned long samples) {
+        if (not started)
+            start();
+        _round_trips = 0;
+        rounds = 0;
+        std::vector<unsigned int> left(_windows.size(), stages);  // the stages left in each window
+        for (unsigned int w = 0; w < _windows.size(); w++) {
+            _windows[w]->sync = sync;
+            _windows[w]->flatness = flatness;
+            _windows[w]->early_rejection = true;
+            if (stages > 0)
+                _windows[w]->begin_stage(samples);
+        }
+
+        Pool pool((unsigned int) replicas.size());
+        while (stages > 0 and *std::max_element(left.begin(), left.end()) > 0) {
+            pool.run([this, &left](unsigned int task) {
+                unsigned int w = task/_walkers;
+                if (left[w] > 0)
+                    _windows[w]->run(task % _walkers, exchange_steps);
+            });
+
+            for (unsigned int w = rounds % 2; w + 1 < _windows.size(); w += 2) {
+                if (left[w] == 0 or left[w + 1] == 0)
+                    continue;
+                // each walker of the window with a walker of the next, in a random order
+                std::vector<unsigned int> partners(_walkers);
+                for (unsigned int k = 0; k < _walkers; k++) {
+                    unsigned int j = (unsigned int) (stream.uniform()*(k + 1));
+                    partners[k] = partners[j];
+                    partners[j] = k;
+                }
+                for (unsigned int k = 0; k < _walkers; k++)
+                    exchange(w, k, partners[k]);
+            }
+            rounds++;
+            count_round_trips();
+
+            for (unsigned int w = 0; w < _windows.size(); w++) {
+                if (left[w] > 0 and _windows[w]->stage_done()) {
+                    _windows[w]->end_stage();
+                    if (--left[w] > 0)
+                        _windows[w]->begin_stage(samples);
+                }
+            }
+        }
+        stitch();
+    }
+};
+
 #endif
@@ -0,0 +1,561 @@
+#ifndef chaospp_symbolic_h
+#define chaospp_symbolic_h
+
+/*
+ * Exact symbolic dynamics of the piecewise-linear maps (`map::generic::Tent` and `map::generic::OpenTent`).
+ *
+ * The parameters of the maps are binary rationals (as every floating point number), so the maps have rational
+ * coefficients and evolve a rational state exactly: the state x = N/Q is kept as two GMP integers, and each step only
+ * multiplies them by the (small) integer coefficients of the branch. The itinerary of the state (the branch of each
+ * step), its escape time and its FTLE are then exact, for any number of steps and without choosing a precision.
+ *
+ * The distributions of these observables for uniformly distributed states are computed exactly (in GMP rationals)
+ * by evolving intervals of states instead of states (see `PiecewiseLinear::escape_time_distribution` and
+ * `PiecewiseLinear::lyapunov_distribution`), e.g. to validate the samplers.
+ */
+#include <vector>
+#include <map>
+#include <string>
+#include <limits>
+#include <algorithm>
+#include <ostream>
+#include <assert.h>
+#include <gmp.h>
+
+#include "map.h"
+#include "observable.h"
+
+
+namespace symbolic {
+
+//! An exact rational number (a GMP `mpq_t`).
+class Rational {
+    mpq_t value;
+public:
+    Rational() {mpq_init(value);}
+    Rational(long numerator, unsigned long denominator = 1) {
+        mpq_init(value);
+        mpq_set_si(value, numerator, denominator);
+        mpq_canonicalize(value);
+    }
+    Rational(Rational const& other) {mpq_init(value); mpq_set(value, other.value);}
+    ~Rational() {mpq_clear(value);}
+
+    Rational & operator=(Rational const& other) {
+        mpq_set(value, other.value);
+        return *this;
+    }
+
+    //! the exact value of `x` = m 2^e.
+    static Rational from_2exp(mpz_srcptr m, long e) {
+        Rational result;
+        mpq_set_z(result.value, m);
+        if (e > 0)
+            mpq_mul_2exp(result.value, result.value, e);
+        else
+            mpq_div_2exp(result.value, result.value, -e);
+        return result;
+    }
+
+    mpq_srcptr get() const {return value;}
+    mpq_ptr get() {return value;}
+    mpz_srcptr numerator() const {return mpq_numref(value);}
+    mpz_srcptr denominator() const {return mpq_denref(value);}
+
+    int sign() const {return mpq_sgn(value);}
+
+    //! rounded towards zero
+    double to_double() const {return mpq_get_d(value);}
+
+    std::string to_string() const {
+        char* str = mpq_get_str(nullptr, 10, value);
+        std::string result(str);
+        void (*free)(void*, size_t);
+        mp_get_memory_functions(nullptr, nullptr, &free);
+        free(str, result.size() + 1);
+        return result;
+    }
+
+    Rational & operator+=(Rational const& other) {mpq_add(value, value, other.value); return *this;}
+    Rational & operator-=(Rational const& other) {mpq_sub(value, value, other.value); return *this;}
+    Rational & operator*=(Rational const& other) {mpq_mul(value, value, other.value); return *this;}
+    Rational & operator/=(Rational const& other) {mpq_div(value, value, other.value); return *this;}
+
+    friend Rational operator+(Rational x, Rational const& y) {return x += y;}
+    friend Rational operator-(Rational x, Rational const& y) {return x -= y;}
+    friend Rational operator*(Rational x, Rational const& y) {return x *= y;}
+    friend Rational operator/(Rational x, Rational const& y) {return x /= y;}
+    friend Rational operator-(Rational x) {mpq_neg(x.value, x.value); return x;}
+
+    friend bool operator==(Rational const& x, Rational const& y) {return mpq_equal(x.value, y.value) != 0;}
+    friend bool operator!=(Rational const& x, Rational const& y) {return not (x == y);}
+    friend bool operator<(Rational const& x, Rational const& y) {return mpq_cmp(x.value, y.value) < 0;}
+    friend bool operator>(Rational const& x, Rational const& y) {return y < x;}
+    friend bool operator<=(Rational const& x, Rational const& y) {return not (y < x);}
+    friend bool operator>=(Rational const& x, Rational const& y) {return not (x < y);}
+
+    friend std::ostream & operator<<(std::ostream & os, Rational const& x) {return os << x.to_string();}
+};
+
+inline Rational abs(Rational x) {
+    mpq_abs(x.get(), x.get());
+    return x;
+}
+
+//! x^n
+inline Rational pow(Rational const& x, unsigned long n) {
+    Rational result;
+    mpz_pow_ui(mpq_numref(result.get()), x.numerator(), n);
+    mpz_pow_ui(mpq_denref(result.get()), x.denominator(), n);
+    return result;
+}
+
+//! the natural logarithm of a positive rational; it does not overflow for any size of numerator and denominator.
+inline double log(Rational const& x) {
+    long numerator_exp, denominator_exp;
+    double numerator = mpz_get_d_2exp(&numerator_exp, x.numerator());
+    double denominator = mpz_get_d_2exp(&denominator_exp, x.denominator());
+    return std::log(numerator/denominator) + (numerator_exp - denominator_exp)*std::log(2.);
+}
+
+//! the exact value of `x`.
+inline Rational rational(double x) {
+    Rational result;
+    mpq_set_d(result.get(), x);
+    return result;
+}
+
+inline Rational rational(mpfr::mpreal const& x) {
+    if (x == 0)
+        return Rational(0);
+    mpz_t m;
+    mpz_init(m);
+    long e = mpfr_get_z_2exp(m, x.mpfr_srcptr());
+    Rational result = Rational::from_2exp(m, e);
+    mpz_clear(m);
+    return result;
+}
+
+//! the exact value of `x` of any scalar that is a finite sum of doubles (e.g. long double, `aux::dd_real`),
+//! taken one double at a time.
+template <typename Float>
+Rational rational(Float x) {
+    Rational result;
+    for (unsigned int i = 0; i < 64 and x != 0; i++) {
+        double term = aux::to_double(x);
+        result += rational(term);
+        x -= Float(term);
+    }
+    return result;
+}
+
+//! `x` rounded to `Float` (to nearest for `mpfr::mpreal`, as double otherwise).
+template <typename Float>
+inline Float to(Rational const& x) {
+    return Float(x.to_double());
+}
+
+template <>
+inline mpfr::mpreal to<mpfr::mpreal>(Rational const& x) {
+    mpfr::mpreal result;
+    mpfr_set_q(result.mpfr_ptr(), x.get(), MPFR_RNDN);
+    return result;
+}
+
+
+//! A 1-dimensional map with linear branches x -> slope*x + offset, separated by increasing thresholds: the branch
+//! `i` applies to threshold[i - 1] <= x < threshold[i] (the first and the last branches are unbounded).
+//! A state is inside (has not exited) when lower <= x (or lower < x) and, if `bounded`, x <= upper (or x < upper).
+class PiecewiseLinear {
+public:
+    struct Branch {
+        Rational slope;
+        Rational offset;
+        // x = N/Q -> N' = alpha N + beta Q, Q' = gamma Q, the integer form of slope*x + offset.
+        Rational alpha, beta, gamma;
+
+        Branch(Rational const& slope, Rational const& offset) : slope(slope), offset(offset) {
+            mpz_mul(mpq_numref(alpha.get()), slope.numerator(), offset.denominator());
+            mpz_mul(mpq_numref(beta.get()), offset.numerator(), slope.denominator());
+            mpz_mul(mpq_numref(gamma.get()), slope.denominator(), offset.denominator());
+
+            mpz_t g;
+            mpz_init(g);
+            mpz_gcd(g, mpq_numref(alpha.get()), mpq_numref(beta.get()));
+            mpz_gcd(g, g, mpq_numref(gamma.get()));
+            mpz_divexact(mpq_numref(alpha.get()), mpq_numref(alpha.get()), g);
+            mpz_divexact(mpq_numref(beta.get()), mpq_numref(beta.get()), g);
+            mpz_divexact(mpq_numref(gamma.get()), mpq_numref(gamma.get()), g);
+            mpz_clear(g);
+        }
+    };
+
+    //! A rational state x = N/Q (Q > 0), with the temporaries used to evolve it.
+    class State {
+        friend class PiecewiseLinear;
+        mpz_t N, Q;
+        mutable mpz_t t1, t2;
+    public:
+        State() {mpz_init(N); mpz_init_set_ui(Q, 1); mpz_init(t1); mpz_init(t2);}
+        State(State const& other) : State() {*this = other;}
+        ~State() {mpz_clear(N); mpz_clear(Q); mpz_clear(t1); mpz_clear(t2);}
+
+        State & operator=(State const& other) {
+            mpz_set(N, other.N);
+            mpz_set(Q, other.Q);
+            return *this;
+        }
+
+        template <typename Float>
+        void set(Float const& x) {
+            set(rational(x));
+        }
+
+        void set(Rational const& x) {
+            mpz_set(N, x.numerator());
+            mpz_set(Q, x.denominator());
+        }
+
+        Rational get() const {
+            Rational x;
+            mpz_set(mpq_numref(x.get()), N);
+            mpz_set(mpq_denref(x.get()), Q);
+            mpq_canonicalize(x.get());
+            return x;
+        }
+
+        //! x < c (`strict`) or x <= c.
+        bool below(Rational const& c, bool strict) const {
+            mpz_mul(t1, N, c.denominator());
+            mpz_mul(t2, c.numerator(), Q);
+            int cmp = mpz_cmp(t1, t2);
+            return strict ? cmp < 0 : cmp <= 0;
+        }
+    };
+
+    std::vector<Rational> thresholds;
+    std::vector<Branch> branches;
+    Rational lower, upper;
+    bool lower_open, upper_open, bounded;
+
+    PiecewiseLinear(std::vector<Rational> const& thresholds, std::vector<Branch> const& branches,
+                    Rational const& lower, bool lower_open, Rational const& upper, bool upper_open, bool bounded=true) :
+            thresholds(thresholds), branches(branches), lower(lower), upper(upper), lower_open(lower_open),
+            upper_open(upper_open), bounded(bounded) {
+        assert(branches.size() == thresholds.size() + 1);
+    }
+
+    unsigned int branch(State const& x) const {
+        unsigned int i = 0;
+        while (i < thresholds.size() and not x.below(thresholds[i], true))
+            i++;
+        return i;
+    }
+
+    //! evolves `x` one step with the branch `i`.
+    void apply(State & x, unsigned int i) const {
+        Branch const& branch = branches[i];
+        mpz_mul(x.t1, mpq_numref(branch.alpha.get()), x.N);
+        mpz_addmul(x.t1, mpq_numref(branch.beta.get()), x.Q);
+        mpz_swap(x.N, x.t1);
+        if (mpz_cmp_ui(mpq_numref(branch.gamma.get()), 1) != 0)
+            mpz_mul(x.Q, x.Q, mpq_numref(branch.gamma.get()));
+    }
+
+    //! evolves `x` one step and returns the branch used.
+    unsigned int T(State & x) const {
+        unsigned int i = branch(x);
+        apply(x, i);
+        return i;
+    }
+
+    bool has_exited(State const& x) const {
+        if (x.below(lower, not lower_open))
+            return true;
+        if (bounded and not x.below(upper, upper_open))
+            return true;
+        return false;
+    }
+
+    //! the FTLE of a trajectory that visited `counts[i]` times the branch `i`.
+    double lyapunov(std::vector<unsigned int> const& counts) const {
+        double sum = 0;
+        unsigned int steps = 0;
+        for (unsigned int i = 0; i < counts.size(); i++) {
+            if (counts[i] > 0)
+                sum += counts[i]*log(abs(branches[i].slope));
+            steps += counts[i];
+        }
+        return sum/steps;
+    }
+
+    //! the derivative of a trajectory that visited `counts[i]` times the branch `i`.
+    Rational stretch(std::vector<unsigned int> const& counts) const {
+        Rational result(1);
+        for (unsigned int i = 0; i < counts.size(); i++)
+            result *= pow(branches[i].slope, counts[i]);
+        return result;
+    }
+
+    //! the exact distribution of the escape time (as `observable::generic::EscapeTime` with `max_time`) of states
+    //! uniformly distributed in [`from`, `to`]: the probability of each escape time, 0...max(max_time, 1).
+    std::vector<Rational> escape_time_distribution(Rational const& from, Rational const& to, unsigned int max_time) const {
+        std::vector<Rational> distribution(std::max(max_time, 1u) + 1);
+
+        Cylinders cylinders;
+        cylinders[Cylinder(from, to)] = Rational(1);
+        for (unsigned int t = 1; ; t++) {
+            cylinders = evolve(cylinders, false);
+            if (t >= max_time) {
+                for (Cylinders::const_iterator it = cylinders.begin(); it != cylinders.end(); ++it)
+                    distribution[t] += it->second;
+                return distribution;
+            }
+
+            Cylinders inside;
+            for (Cylinders::const_iterator it = cylinders.begin(); it != cylinders.end(); ++it) {
+                Rational const& image_from = it->first.from;
+                Rational const& image_to = it->first.to;
+                Rational inside_from = lower > image_from ? lower : image_from;
+                Rational inside_to = (bounded and upper < image_to) ? upper : image_to;
+                if (inside_from < inside_to) {
+                    Rational measure = it->second*(inside_to - inside_from)/(image_to - image_from);
+                    distribution[t] += it->second - measure;
+                    inside[Cylinder(inside_from, inside_to)] += measure;
+                }
+                else
+                    distribution[t] += it->second;
+            }
+            cylinders.swap(inside);
+        }
+    }
+
+    //! the exact distribution of the number of visits to each branch in `steps` steps (as `observable::generic::Lyapunov`
+    //! with `tobs` = `steps`) of states uniformly distributed in [`from`, `to`]. The FTLE of each is `lyapunov(counts)`.
+    std::map<std::vector<unsigned int>, Rational> lyapunov_distribution(Rational const& from, Rational const& to,
+                                                                        unsigned int steps) const {
+        Cylinders cylinders;
+        cylinders[Cylinder(from, to, std::vector<unsigned int>(branches.size(), 0))] = Rational(1);
+        for (unsigned int t = 0; t < steps; t++)
+            cylinders = evolve(cylinders, true);
+
+        std::map<std::vector<unsigned int>, Rational> distribution;
+        for (Cylinders::const_iterator it = cylinders.begin(); it != cylinders.end(); ++it)
+            distribution[it->first.counts] += it->second;
+        return distribution;
+    }
+
+private:
+    //! the interval of images [from, to] of states uniformly distributed in it that visited each branch `counts` times.
+    struct Cylinder {
+        Rational from, to;
+        std::vector<unsigned int> counts;
+
+        Cylinder(Rational const& from, Rational const& to, std::vector<unsigned int> const& counts=std::vector<unsigned int>()) :
+                from(from), to(to), counts(counts) {}
+
+        bool operator<(Cylinder const& other) const {
+            if (from != other.from)
+                return from < other.from;
+            if (to != other.to)
+                return to < other.to;
+            return counts < other.counts;
+        }
+    };
+    typedef std::map<Cylinder, Rational> Cylinders;  // the probability of each cylinder
+
+    //! splits the cylinders by branch and maps them one step. A linear map of a uniform distribution is uniform.
+    Cylinders evolve(Cylinders const& cylinders, bool count) const {
+        Cylinders result;
+        for (Cylinders::const_iterator it = cylinders.begin(); it != cylinders.end(); ++it) {
+            Rational const& from = it->first.from;
+            Rational const& to = it->first.to;
+            for (unsigned int i = 0; i < branches.size(); i++) {
+                Rational branch_from = (i > 0 and thresholds[i - 1] > from) ? thresholds[i - 1] : from;
+                Rational branch_to = (i < thresholds.size() and thresholds[i] < to) ? thresholds[i] : to;
+                if (not (branch_from < branch_to))
+                    continue;
+
+                Rational image_from = branches[i].slope*branch_from + branches[i].offset;
+                Rational image_to = branches[i].slope*branch_to + branches[i].offset;
+                if (image_to < image_from)
+                    std::swap(image_from, image_to);
+
+                Cylinder image(image_from, image_to, it->first.counts);
+                if (count)
+                    image.counts[i]++;
+                result[image] += it->second*(branch_to - branch_from)/(to - from);
+            }
+        }
+        return result;
+    }
+};
+
+
+//! The tent map of `map::generic::Tent`, with slope `a` (and a/(a - 1)), that exits below 2/5.
+inline PiecewiseLinear tent(Rational const& a) {
+    std::vector<Rational> thresholds(1, Rational(1)/a);
+    std::vector<PiecewiseLinear::Branch> branches;
+    Rational slope = a/(a - Rational(1));
+    branches.push_back(PiecewiseLinear::Branch(a, Rational(0)));
+    branches.push_back(PiecewiseLinear::Branch(-slope, slope));
+    return PiecewiseLinear(thresholds, branches, Rational(2, 5), false, Rational(0), false, false);
+}
+
+//! The open tent map of `map::generic::OpenTent`, with slopes `a` and -`b`, that exits outside (0, 1).
+inline PiecewiseLinear open_tent(Rational const& a, Rational const& b) {
+    std::vector<Rational> thresholds(1, b/(a + b));
+    std::vector<PiecewiseLinear::Branch> branches;
+    branches.push_back(PiecewiseLinear::Branch(a, Rational(0)));
+    branches.push_back(PiecewiseLinear::Branch(-b, b));
+    return PiecewiseLinear(thresholds, branches, Rational(0), true, Rational(1), true);
+}
+
+//! the exact dynamics of `map`, with its parameters as they are stored (binary rationals).
+template <typename Float, int Dim>
+PiecewiseLinear dynamics(map::generic::Tent<Float, Dim> const& map) {
+    return tent(rational(map.get_a()));
+}
+
+template <typename Float, int Dim>
+PiecewiseLinear dynamics(map::generic::OpenTent<Float, Dim> const& map) {
+    return open_tent(rational(map.get_a()), rational(map.get_b()));
+}
+
+
+//! the exact entropy (the log of the probability of each bin, for `SamplingHistogram::set_entropy`) of the FTLE in
+//! `steps` steps of the states uniformly distributed in the boundary of `map`.
+template <typename Map, typename Histogram>
+std::vector<double> lyapunov_entropy(Map const& map, unsigned int steps, Histogram const& histogram) {
+    PiecewiseLinear dynamics = symbolic::dynamics(map);
+    std::map<std::vector<unsigned int>, Rational> distribution = dynamics.lyapunov_distribution(
+            rational(map.boundary[0].first), rational(map.boundary[0].second), steps);
+
+    std::vector<Rational> probability(histogram.bins() + 1);
+    for (std::map<std::vector<unsigned int>, Rational>::const_iterator it = distribution.begin(); it != distribution.end(); ++it)
+        probability[histogram.bin(dynamics.lyapunov(it->first))] += it->second;
+
+    std::vector<double> entropy(probability.size());
+    for (unsigned int bin = 0; bin < probability.size(); bin++)
+        entropy[bin] = probability[bin].sign() > 0 ? log(probability[bin]) : -std::numeric_limits<double>::infinity();
+    return entropy;
+}
+
+//! the same as `lyapunov_entropy`, for the escape time with `max_time`.
+template <typename Map, typename Histogram>
+std::vector<double> escape_time_entropy(Map const& map, unsigned int max_time, Histogram const& histogram) {
+    std::vector<Rational> distribution = symbolic::dynamics(map).escape_time_distribution(
+            rational(map.boundary[0].first), rational(map.boundary[0].second), max_time);
+
+    std::vector<Rational> probability(histogram.bins() + 1);
+    for (unsigned int t = 0; t < distribution.size(); t++)
+        probability[histogram.bin(t)] += distribution[t];
+
+    std::vector<double> entropy(probability.size());
+    for (unsigned int bin = 0; bin < probability.size(); bin++)
+        entropy[bin] = probability[bin].sign() > 0 ? log(probability[bin]) : -std::numeric_limits<double>::infinity();
+    return entropy;
+}
+
+} // symbolic
+
+
+namespace observable {
+
+//! The observables of the piecewise-linear maps computed exactly (see `symbolic.h`). They are drop-ins of the generic
+//! ones of `Map` (`map::generic::Tent<Float>` or `map::generic::OpenTent<Float>`), e.g.
+//! `observable::symbolic::EscapeTime<map::OpenTent>` instead of `observable::EscapeTime`.
+namespace symbolic {
+
+//! `generic::EscapeTime` with the exact trajectory. It also counts the visits of each branch (`counts`).
+template <typename Map>
+class EscapeTime : public generic::EscapeTime<typename Map::Scalar, Map::Dimension, Map> {
+    typedef generic::EscapeTime<typename Map::Scalar, Map::Dimension, Map> Base;
+    typedef typename Map::Scalar Float;
+public:
+    typedef typename Base::Vector Vector;
+
+    ::symbolic::PiecewiseLinear dynamics;
+    std::vector<unsigned int> counts;  //! the number of visits of each branch.
+
+    EscapeTime(Map const& map, unsigned int max_time=std::numeric_limits<unsigned int>::max()) :
+            Base(map, max_time), dynamics(::symbolic::dynamics(map)), counts(dynamics.branches.size()) {}
+
+    void observe(Vector const& state) {
+        Observable<unsigned int, Float, Map::Dimension>::observe(state);
+        this->initialize();
+        std::fill(counts.begin(), counts.end(), 0);
+
+        x.set(state[0]);
+        do {
+            counts[dynamics.T(x)]++;
+            this->escape_time++;
+        } while (not dynamics.has_exited(x) and this->escape_time < this->horizon());
+        this->finalize();
+    }
+
+    //! the FTLE of the trajectory until it exited.
+    double lyapunov() const {
+        return dynamics.lyapunov(counts);
+    }
+
+    EscapeTime & operator=(EscapeTime const& other) {
+        Base::operator=(other);
+        counts = other.counts;
+        return *this;
+    }
+
+private:
+    ::symbolic::PiecewiseLinear::State x;
+};
+
+
+//! `generic::Lyapunov` with the exact trajectory: `jacobian` is the exact derivative (rounded to `Float`), and
+//! `lyapunov()` is exact (up to the logarithm).
+template <typename Map>
+class Lyapunov : public generic::Lyapunov<typename Map::Scalar, Map::Dimension, Map> {
+    typedef generic::Lyapunov<typename Map::Scalar, Map::Dimension, Map> Base;
+    typedef typename Map::Scalar Float;
+public:
+    typedef typename Base::Vector Vector;
+
+    ::symbolic::PiecewiseLinear dynamics;
+    std::vector<unsigned int> counts;  //! the number of visits of each branch.
+
+    Lyapunov(Map const& map, unsigned int tobs) :
+            Base(map, tobs), dynamics(::symbolic::dynamics(map)), counts(dynamics.branches.size()) {}
+
+    virtual void observe(Vector const& state) {
+        Observable<double, Float, Map::Dimension>::observe(state);
+        std::fill(counts.begin(), counts.end(), 0);
+
+        x.set(state[0]);
+        for (unsigned int t = 0; t < this->tobs; t++)
+            counts[dynamics.T(x)]++;
+
+        this->jacobian(0, 0) = ::symbolic::to<Float>(dynamics.stretch(counts));
+        this->finalise(state);
+    }
+
+    double lyapunov() const {
+        return dynamics.lyapunov(counts);
+    }
+
+    Lyapunov & operator=(Lyapunov const& other) {
+        Base::operator=(other);
+        counts = other.counts;
+        return *this;
+    }
+
+    virtual double observable() const {
+        return lyapunov();
+    }
+
+private:
+    ::symbolic::PiecewiseLinear::State x;
+};
+
+} // symbolic
+} // observable
+
+#endif //chaospp_symbolic_h
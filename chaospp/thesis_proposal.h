@@ -16,6 +16,9 @@ double finite_difference(std::vector<double> const& values, unsigned int index)
 //! the proposal distribution given by the tstar from the thesis
 template <typename Observable>
 class TstarProposal : public proposal::Isotropic<Observable> {
+    typedef typename proposal::Proposal<Observable>::Float Float;
+    typedef typename proposal::Proposal<Observable>::pair pair;
+
     SamplingHistogram<Observable> const& histogram;
     Float delta_0;
     unsigned int tobs;
@@ -62,7 +65,7 @@ class TstarProposal : public proposal::Isotropic<Observable> {
     }
 
 public:
-    TstarProposal(std::vector<aux::pair> const& boundary, Float delta_0, unsigned int tobs, SamplingHistogram<Observable> const& histogram) :
+    TstarProposal(std::vector<pair> const& boundary, Float delta_0, unsigned int tobs, SamplingHistogram<Observable> const& histogram) :
             proposal::Isotropic<Observable>(boundary), delta_0(delta_0), tobs(tobs), histogram(histogram) {}
 };
 
@@ -177,6 +177,25 @@ void us_up(unsigned int tobs, std::string directory="./") {
 }
 
 
+// Uniform sampling of the FTLE of several horizons in one run: "histogram_<i>_sm6_us_up.dat" for the i-th horizon.
+void us_up_horizons(std::vector<unsigned int> const& horizons, std::string directory="./") {
+
+    mpfr::mpreal::set_default_prec(64);
+
+    map::Standard map(6);
+    observable::MultiLyapunov observable(map, horizons);
+
+    MultiHistogram<observable::MultiLyapunov> histogram(-1, 6, 10*observable.tobs, horizons.size());
+    proposal::Uniform<observable::MultiLyapunov> proposal(map.boundary);
+
+    MetropolisHastings<observable::MultiLyapunov> mc(observable, proposal, histogram);
+
+    mc.sample(10000);
+
+    histogram.export_histogram("sm6_us_up.dat", directory);
+}
+
+
 int main() {
     wl_tp(10, 1);
     std::cout << "10 ended" << std::endl;
@@ -190,11 +209,7 @@ int main() {
     std::cout << "20 ended" << std::endl;
     wl_up(30);
 
-    us_up(10);
-    std::cout << "10 ended" << std::endl;
-    us_up(20);
-    std::cout << "20 ended" << std::endl;
-    us_up(30);
+    us_up_horizons({10, 20, 30});
 
     us_tp(10, 1);
     std::cout << "10 ended" << std::endl;
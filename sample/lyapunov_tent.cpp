@@ -7,13 +7,7 @@
 #include "sampler.h"
 #include "observable.h"
 #include "thesis_proposal.h"
-
-
-double log_binomial_coefficient(int n, int k) {
-    if (k == 0 or k == n)
-        return 0;
-    return n*log(n) - k*log(k) - (n - k)*log(n - k);
-}
+#include "symbolic.h"
 
 
 class TestHistogram : public SamplingHistogram<observable::Lyapunov> {
@@ -187,11 +181,7 @@ void fh_tp(unsigned int tobs, double delta, std::string directory="./") {
 
     TstarProposal<observable::Lyapunov> proposal(map.boundary, delta, tobs, histogram);
 
-    std::vector<double> entropy(tobs + 1);
-    for(unsigned int i = 0; i <= tobs; i++) {
-        entropy[i] = log_binomial_coefficient(tobs, i) + log(1/a)*i + log(1/(a / (a - 1)))*(tobs - i);
-    }
-    histogram.set_entropy(entropy);
+    histogram.set_entropy(symbolic::lyapunov_entropy(map, tobs, histogram));
 
     for(unsigned int bin = 0; bin < histogram.log_pi.size(); bin++) {
         histogram.log_pi[bin] = -histogram.entropy(bin);
@@ -218,11 +208,7 @@ void fh_up(unsigned int tobs, std::string directory="./") {
 
     proposal::Uniform<observable::Lyapunov> proposal(map.boundary);
 
-    std::vector<double> entropy(tobs + 1);
-    for(unsigned int i = 0; i <= tobs; i++) {
-        entropy[i] = log_binomial_coefficient(tobs, i) + log(1/a)*i + log(1/(a / (a - 1)))*(tobs - i);
-    }
-    histogram.set_entropy(entropy);
+    histogram.set_entropy(symbolic::lyapunov_entropy(map, tobs, histogram));
 
     for(unsigned int bin = 0; bin < histogram.log_pi.size(); bin++) {
         histogram.log_pi[bin] = -histogram.entropy(bin);
@@ -247,11 +233,7 @@ void us_tp(unsigned int tobs, double delta, std::string directory="./") {
 
     TestHistogram histogram(log(a / (a - 1)) - 0.0001, log(a) - 0.0001, tobs);
 
-    std::vector<double> entropy(tobs + 1);
-    for(unsigned int i = 0; i <= tobs; i++) {
-        entropy[i] = log_binomial_coefficient(tobs, i) + log(1/a)*i + log(1/(a / (a - 1)))*(tobs - i);
-    }
-    histogram.set_entropy(entropy);
+    histogram.set_entropy(symbolic::lyapunov_entropy(map, tobs, histogram));
 
     TstarProposal<observable::Lyapunov> proposal(map.boundary, delta, tobs, histogram);
 
@@ -277,11 +259,7 @@ void fh_sy(unsigned int tobs, std::string directory="./") {
 
     TestHistogram histogram(log(a/(a - 1)) - 0.0001, log(a) - 0.0001, tobs);
 
-    std::vector<double> entropy(tobs + 1);
-    for(unsigned int i = 0; i <= tobs; i++) {
-        entropy[i] = log_binomial_coefficient(tobs, i) + log(1/a)*i + log(1/(a / (a - 1)))*(tobs - i);
-    }
-    histogram.set_entropy(entropy);
+    histogram.set_entropy(symbolic::lyapunov_entropy(map, tobs, histogram));
 
     for(unsigned int bin = 0; bin < histogram.log_pi.size(); bin++) {
         histogram.log_pi[bin] = -histogram.entropy(bin);
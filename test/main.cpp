@@ -1,3 +1,6 @@
+// lets `test_allocation.h` forbid the heap allocations of Eigen
+#define EIGEN_RUNTIME_NO_MALLOC
+
 #include "gtest/gtest.h"
 
 #include "test_sampling.h"
@@ -8,6 +11,15 @@
 #include "test_histogram.h"
 #include "test_isotropic_proposal.h"
 #include "test_anisotropic_proposal.h"
+#include "test_scalar.h"
+#include "test_arena.h"
+#include "test_kernel.h"
+#include "test_batch.h"
+#include "test_symbolic.h"
+#include "test_dual.h"
+#include "test_allocation.h"
+#include "test_threads.h"
+#include "test_random.h"
 
 
 int main(int argc, char **argv) {
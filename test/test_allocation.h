@@ -0,0 +1,98 @@
+#ifndef chaospp_test_allocation_h
+#define chaospp_test_allocation_h
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "gtest/gtest.h"
+#include "arena.h"
+#include "map.h"
+#include "observable.h"
+#include "sampler.h"
+
+
+// counts the calls of the global operator new.
+namespace allocation {
+inline std::atomic<unsigned long> & count() {
+    static std::atomic<unsigned long> value(0);
+    return value;
+}
+}
+
+void * operator new(std::size_t size) {
+    allocation::count()++;
+    void * ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void * ptr) noexcept {
+    std::free(ptr);
+}
+
+
+// the heap allocations of `function`: of the operator new, and of the GMP/MPFR numbers not served by the pool of
+// `aux::Arena`. The heap allocations of Eigen are forbidden (see EIGEN_RUNTIME_NO_MALLOC in main.cpp).
+template <typename Function>
+unsigned long heap_allocations(Function function) {
+    unsigned long system_allocations = aux::Arena::local().counters.system_allocations;
+    unsigned long news = allocation::count();
+    Eigen::internal::set_is_malloc_allowed(false);
+    function();
+    Eigen::internal::set_is_malloc_allowed(true);
+    return allocation::count() - news + aux::Arena::local().counters.system_allocations - system_allocations;
+}
+
+
+// once the observables have the dimension of the states, the Markov steps do not allocate memory.
+template <typename Observable, typename Proposal>
+void expect_no_allocations(Observable & observable, Proposal & proposal, SamplingHistogram<Observable> & histogram) {
+    MetropolisHastings<Observable> mc(observable, proposal, histogram);
+    WangLandau<Observable, Proposal> wang_landau(observable, proposal, histogram);
+    Observable result(observable);
+    result.observe(proposal.proposeUniform());
+    mc.sample(100);
+    wang_landau.sample(1, 100);
+    mc.markov_step(result);
+
+    EXPECT_EQ(0u, heap_allocations([&]() {mc.sample(1000);}));
+    EXPECT_EQ(0u, heap_allocations([&]() {wang_landau.sample(1, 1000);}));
+    EXPECT_EQ(0u, heap_allocations([&]() {
+        for (unsigned int i = 0; i < 1000; i++)
+            mc.markov_step(result);
+    }));
+    EXPECT_EQ(2000u, histogram.count());  // since Wang-Landau reset it
+}
+
+TEST(Allocation, MarkovStep) {
+    map::generic::Standard<double> map(6);
+    typedef observable::generic::EscapeWithVector<double> Escape;
+    Escape escape(map, 20);
+    proposal::LyapunovIsotropic<Escape> isotropic(map.boundary);
+    SamplingHistogram<Escape> escape_histogram(0, 20, 20);
+    expect_no_allocations(escape, isotropic, escape_histogram);
+
+    typedef observable::generic::Lyapunov<double> Lyapunov;
+    Lyapunov lyapunov(map, 5);
+    proposal::Uniform<Lyapunov> uniform(map.boundary);
+    SamplingHistogram<Lyapunov> lyapunov_histogram(0, 3, 30);
+    expect_no_allocations(lyapunov, uniform, lyapunov_histogram);
+
+    // in arbitrary precision, the temporaries are served by the pool.
+    mpfr_prec_t precision = mpfr::mpreal::get_default_prec();
+    mpfr::mpreal::set_default_prec(128);
+    aux::Arena::enable();
+    {
+        map::Standard mp_map(6);
+        observable::EscapeWithVector mp_escape(mp_map, 20);
+        proposal::LyapunovIsotropic<observable::EscapeWithVector> mp_isotropic(mp_map.boundary);
+        SamplingHistogram<observable::EscapeWithVector> mp_histogram(0, 20, 20);
+        expect_no_allocations(mp_escape, mp_isotropic, mp_histogram);
+    }
+    aux::Arena::disable();
+    mpfr::mpreal::set_default_prec(precision);
+}
+
+#endif
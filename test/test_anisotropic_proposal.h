@@ -53,4 +53,40 @@ TEST(Anisotropic, basic) {
     ASSERT_NEAR(avg, 0, 1);
 }
 
+// the singular values and the right singular vectors (up to their signs) of a jacobian U*diag(s)*V^T with known
+// orthogonal U and V, with the Jacobi SVD (D < `proposal::bdcsvd_dimension`) and the divide and conquer SVD.
+TEST(Anisotropic, right_singular) {
+    for (unsigned int D : {4u, 32u}) {
+        SCOPED_TRACE(D);
+        aux::Stream stream(5);
+        Eigen::MatrixXd random(D, D), other(D, D);
+        for (unsigned int i = 0; i < D*D; i++) {
+            random(i) = stream.normal();
+            other(i) = stream.normal();
+        }
+        Eigen::MatrixXd U = Eigen::HouseholderQR<Eigen::MatrixXd>(random).householderQ();
+        Eigen::MatrixXd V = Eigen::HouseholderQR<Eigen::MatrixXd>(other).householderQ();
+        Eigen::VectorXd s(D);
+        for (unsigned int i = 0; i < D; i++)
+            s[i] = pow(1.5, D - i);
+        Eigen::MatrixXd jacobian = U*s.asDiagonal()*V.transpose();
+
+        Eigen::MatrixXd v_matrix;
+        Eigen::VectorXd singular_values;
+        proposal::right_singular(jacobian, v_matrix, singular_values);
+        for (unsigned int i = 0; i < D; i++) {
+            EXPECT_NEAR(s[i], singular_values[i], 1e-10*s[0]);
+            EXPECT_NEAR(1, std::abs(V.col(i).dot(v_matrix.col(i))), 1e-8);
+        }
+
+        // the other algorithm gives the same singular values and vectors.
+        Eigen::JacobiSVD<Eigen::MatrixXd> jacobi(jacobian, Eigen::ComputeFullV);
+        Eigen::BDCSVD<Eigen::MatrixXd> bdc(jacobian, Eigen::ComputeFullV);
+        for (unsigned int i = 0; i < D; i++) {
+            EXPECT_NEAR(jacobi.singularValues()[i], bdc.singularValues()[i], 1e-10*s[0]);
+            EXPECT_NEAR(1, std::abs(jacobi.matrixV().col(i).dot(bdc.matrixV().col(i))), 1e-8);
+        }
+    }
+}
+
 #endif
@@ -0,0 +1,80 @@
+#ifndef chaospp_test_arena_h
+#define chaospp_test_arena_h
+
+#include "gtest/gtest.h"
+#include "arena.h"
+#include "map.h"
+#include "observable.h"
+#include "sampler.h"
+
+
+TEST(Arena, EscapeTime) {
+    mpfr::mpreal::set_default_prec(256);
+
+    map::OpenTent map(3, 5);
+    observable::EscapeTime obs(map);
+    observable::EscapeTime reference(map);
+
+    Vector point(1);
+    point[0] = Float("0.0000000001");
+    reference.observe(point);
+
+    aux::Arena::enable();
+    aux::Arena::Counters before = aux::Arena::local().counters;
+    obs.observe(point);
+    aux::Arena::Counters after = aux::Arena::local().counters;
+    aux::Arena::disable();
+
+    EXPECT_EQ(reference.escape_time, obs.escape_time);
+    // every step allocates temporaries, and they are served by the pool
+    EXPECT_LT(before.allocations + obs.escape_time, after.allocations);
+    EXPECT_LT(before.frees + obs.escape_time, after.frees);
+}
+
+
+TEST(Arena, Reset) {
+    mpfr::mpreal::set_default_prec(256);
+
+    aux::Arena::enable();
+    unsigned long resets = aux::Arena::local().counters.resets;
+    unsigned long in_use = aux::Arena::local().in_use();
+    {
+        aux::Arena::Step step;
+        Float x = Float(3)*Float(2);
+        EXPECT_EQ(in_use + 1, aux::Arena::local().in_use());
+    }
+    EXPECT_EQ(in_use, aux::Arena::local().in_use());
+    if (in_use == 0)
+        EXPECT_EQ(resets + 1, aux::Arena::local().counters.resets);
+    aux::Arena::disable();
+}
+
+
+// sampling with the arena gives the same histogram as without it.
+TEST(Arena, Sampling) {
+    typedef observable::EscapeTime Observable;
+    mpfr::mpreal::set_default_prec(128);
+
+    map::OpenTent map(3, 5);
+    Observable observable(map, 20);
+    proposal::Uniform<Observable> proposal(map.boundary);
+
+    SamplingHistogram<Observable> reference(0, 20, 20);
+    MetropolisHastings<Observable> mc(observable, proposal, reference, aux::Stream(42));
+    mc.sample(1000);
+
+    SamplingHistogram<Observable> histogram(0, 20, 20);
+    MetropolisHastings<Observable> mc_arena(observable, proposal, histogram, aux::Stream(42));
+    aux::Arena::enable();
+    unsigned long system_allocations = aux::Arena::local().counters.system_allocations;
+    mc_arena.sample(1000);
+    system_allocations = aux::Arena::local().counters.system_allocations - system_allocations;
+    aux::Arena::disable();
+
+    for (unsigned int bin = 0; bin <= histogram.bins(); bin++)
+        EXPECT_EQ(reference[bin], histogram[bin]);
+    // the pool is allocated once
+    EXPECT_GT(10, system_allocations);
+}
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef chaospp_test_batch_h
+#define chaospp_test_batch_h
+
+#include "gtest/gtest.h"
+#include "batch.h"
+#include "map.h"
+#include "observable.h"
+#include "proposal.h"
+
+
+typedef Eigen::Matrix<double, Eigen::Dynamic, 1> BatchVector;
+
+void expect_close(BatchVector const& expected, BatchVector const& value) {
+    for (unsigned int d = 0; d < expected.size(); d++)
+        EXPECT_NEAR(expected[d], value[d], 1e-12*std::max(1., std::abs(expected[d])));
+}
+
+
+// the batch map evolves states, tangent vectors and the escape mask as `map`, with every width supported by the CPU.
+template <typename BatchMap, typename Map>
+void expect_same_evolution(BatchMap const& batch_map, Map & map, std::vector<std::pair<double, double> > const& box,
+                           unsigned int steps) {
+    size_t N = 37;  // not a multiple of the packs
+    for (int width = 16; width <= map::batch::simd::max_width(); width *= 2) {
+        map::batch::simd::width() = width;
+
+        map::batch::Block<double> block(map.D, N, true);
+        std::vector<BatchVector> points(N), tangents(N);
+        for (size_t i = 0; i < N; i++) {
+            points[i] = proposal::proposeUniform(box);
+            tangents[i] = aux::unitaryVector<double>(map.D);
+            block.set(i, points[i]);
+            block.set_tangent(i, tangents[i]);
+        }
+
+        std::vector<unsigned char> exited;
+        for (unsigned int t = 0; t < steps; t++) {
+            map::batch::T(batch_map, block);
+            map::batch::has_exited(batch_map, block, exited);
+            for (size_t i = 0; i < N; i++) {
+                map.step(points[i], &tangents[i], nullptr);
+                expect_close(points[i], block.get(i));
+                expect_close(tangents[i], block.get_tangent(i));
+                EXPECT_EQ(map.has_exited(points[i]), (bool) exited[i]);
+            }
+        }
+    }
+    map::batch::simd::width() = map::batch::simd::max_width();
+}
+
+
+// the batch escape time is the one of `observable::EscapeTime`.
+template <typename BatchMap, typename Map>
+void expect_same_escape_time(BatchMap const& batch_map, Map & map, unsigned int max_time) {
+    size_t N = 101;
+    observable::generic::EscapeTime<double> observable(map, max_time);
+
+    map::batch::Block<double> block(map.D, N);
+    std::vector<BatchVector> points(N);
+    for (size_t i = 0; i < N; i++) {
+        points[i] = proposal::proposeUniform(map.boundary);
+        block.set(i, points[i]);
+    }
+
+    std::vector<unsigned int> times;
+    map::batch::escape_time(batch_map, block, max_time, times);
+    for (size_t i = 0; i < N; i++) {
+        observable.observe(points[i]);
+        EXPECT_EQ(observable.escape_time, times[i]);
+    }
+}
+
+
+TEST(Batch, Evolution) {
+    map::generic::Tent<double> tent(3);
+    expect_same_evolution(map::batch::Tent<double>(3), tent, tent.boundary, 10);
+
+    map::generic::OpenTent<double> open_tent(3, 5);
+    expect_same_evolution(map::batch::OpenTent<double>(3, 5), open_tent, open_tent.boundary, 3);
+
+    map::generic::Logistic<double> logistic(4);
+    expect_same_evolution(map::batch::Logistic<double>(4), logistic, logistic.boundary, 10);
+
+    map::generic::Manneville<double> manneville(2.5);
+    expect_same_evolution(map::batch::Manneville<double>(2.5), manneville, manneville.boundary, 10);
+
+    map::generic::Standard<double> standard(6);
+    expect_same_evolution(map::batch::Standard<double>(6), standard, standard.boundary, 10);
+
+    std::vector<std::pair<double, double> > box(6, std::make_pair(-1., 1.));
+    map::generic::NCoupledHenon<double> henon(6);
+    expect_same_evolution(map::batch::NCoupledHenon<double>(6), henon, box, 3);
+
+    map::generic::NCoupledHenon<double> henon2(2);
+    expect_same_evolution(map::batch::NCoupledHenon<double>(2), henon2, std::vector<std::pair<double, double> >(2, box[0]), 3);
+}
+
+
+TEST(Batch, EscapeTime) {
+    map::generic::OpenTent<double> open_tent(3, 5);
+    expect_same_escape_time(map::batch::OpenTent<double>(3, 5), open_tent, 50);
+
+    map::generic::Tent<double> tent(3);
+    expect_same_escape_time(map::batch::Tent<double>(3), tent, 50);
+
+    map::generic::Logistic<double> logistic(4);
+    expect_same_escape_time(map::batch::Logistic<double>(4), logistic, 50);
+
+    map::generic::Standard<double> standard(6);
+    expect_same_escape_time(map::batch::Standard<double>(6), standard, 50);
+
+    map::generic::NCoupledHenon<double> henon(4);
+    expect_same_escape_time(map::batch::NCoupledHenon<double>(4), henon, 50);
+}
+
+
+TEST(Batch, Float) {
+    map::batch::Logistic<float> map(4);
+    map::batch::Block<float> block(1, 20, true);
+    for (size_t i = 0; i < block.size(); i++) {
+        block.state(0)[i] = i/20.f;
+        block.tangent(0)[i] = 1;
+    }
+
+    map::batch::T(map, block);
+    for (size_t i = 0; i < block.size(); i++) {
+        double x = i/20.;
+        EXPECT_NEAR(4*(1 - x)*x, block.state(0)[i], 1e-6);
+        EXPECT_NEAR(4*(1 - 2*x), block.tangent(0)[i], 1e-6);
+    }
+}
+
+#endif
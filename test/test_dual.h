@@ -0,0 +1,216 @@
+#ifndef chaospp_test_dual_h
+#define chaospp_test_dual_h
+
+#include "gtest/gtest.h"
+#include "map.h"
+#include "observable.h"
+#include "proposal.h"
+
+
+TEST(Dual, Derivatives) {
+    typedef aux::Dual<double> Dual;
+    double v = 0.7;
+    Dual dx = Dual::variable(v, 0);
+
+    Dual f = sin(dx)*exp(dx)/(1 + dx*dx) + pow(dx, 3) - sqrt(dx) + log(dx)*cos(dx) + 2/tan(dx);
+    double expected = (cos(v) + sin(v))*exp(v)/(1 + v*v) - sin(v)*exp(v)*2*v/((1 + v*v)*(1 + v*v)) + 3*v*v
+                      - 0.5/sqrt(v) + cos(v)/v - log(v)*sin(v) - 2/(sin(v)*sin(v));
+    EXPECT_DOUBLE_EQ(sin(v)*exp(v)/(1 + v*v) + pow(v, 3) - sqrt(v) + log(v)*cos(v) + 2/tan(v), f.value);
+    EXPECT_NEAR(expected, f.derivative[0], 1e-13);
+
+    // the partial derivatives, with the directions known at compile time and at runtime.
+    aux::Dual<double, 2> x2 = aux::Dual<double, 2>::variable(0.7, 0), y2 = aux::Dual<double, 2>::variable(-1.3, 1);
+    aux::Dual<double, 2> g2 = x2*y2 - x2/y2 + pow(x2, y2*y2);
+    aux::Dual<double, Eigen::Dynamic> x = aux::Dual<double, Eigen::Dynamic>::variable(0.7, 0, 2);
+    aux::Dual<double, Eigen::Dynamic> y = aux::Dual<double, Eigen::Dynamic>::variable(-1.3, 1, 2);
+    aux::Dual<double, Eigen::Dynamic> g = x*y - x/y + pow(x, y*y);
+    x2 *= x2;
+    EXPECT_NEAR(2*0.7, x2.derivative[0], 1e-15);
+
+    double p = pow(0.7, 1.69);
+    EXPECT_NEAR(-1.3 + 1/1.3 + 1.69*p/0.7, g.derivative[0], 1e-14);
+    EXPECT_NEAR(0.7 + 0.7/1.69 - 2*1.3*log(0.7)*p, g.derivative[1], 1e-14);
+    EXPECT_DOUBLE_EQ(g2.derivative[0], g.derivative[0]);
+    EXPECT_DOUBLE_EQ(g2.derivative[1], g.derivative[1]);
+
+    // constants have no derivatives, and the comparisons are of the values.
+    aux::Dual<double, Eigen::Dynamic> c = 2*aux::Dual<double, Eigen::Dynamic>(3.) + 1;
+    EXPECT_EQ(0, (int) c.derivative.size());
+    EXPECT_EQ(2, (int) (c*y).derivative.size());
+    EXPECT_TRUE(x < c and c > 6.5 and 7 == c and y <= x);
+}
+
+
+// the maps of `map.h` written only with their evolution.
+template <typename Float>
+class AutomaticStandard : public map::generic::Automatic<AutomaticStandard<Float>, Float> {
+    Float k;
+    std::vector<std::pair<Float, Float> > bounding_box;
+public:
+    AutomaticStandard(Float k) : map::generic::Automatic<AutomaticStandard<Float>, Float>(2, "sm"),
+                                 k(k/(2*aux::Scalar<Float>::pi())), bounding_box(2, std::make_pair(Float(0), Float(1))) {
+        this->boundary = bounding_box;
+    }
+
+    template <typename Scalar>
+    void evolve(Eigen::Matrix<Scalar, Eigen::Dynamic, 1> & point) const {
+        using std::sin;
+        Float const& pi = aux::Scalar<Float>::pi();
+        point[0] += k*sin(2*pi*point[1]);
+        point[1] += point[0];
+        this->apply_boundary_conditions(point, bounding_box);
+    }
+
+    bool has_exited(Eigen::Matrix<Float, Eigen::Dynamic, 1> const& point) const {
+        return point[1] < 0.1;
+    }
+};
+
+template <typename Float>
+class AutomaticCoupledStandard : public map::generic::Automatic<AutomaticCoupledStandard<Float>, Float> {
+    Float k1, k2, xi;
+    std::vector<std::pair<Float, Float> > bounding_box;
+public:
+    AutomaticCoupledStandard() : map::generic::Automatic<AutomaticCoupledStandard<Float>, Float>(4, "csm"),
+                                 k1(aux::from_string<Float>("-2.25")/(2*aux::Scalar<Float>::pi())),
+                                 k2(aux::from_string<Float>("-3.0")/(2*aux::Scalar<Float>::pi())),
+                                 xi(aux::from_string<Float>("1.0")/(2*aux::Scalar<Float>::pi())),
+                                 bounding_box(4, std::make_pair(aux::from_string<Float>("-0.5"),
+                                                                aux::from_string<Float>("0.5"))) {
+        this->boundary = bounding_box;
+    }
+
+    template <typename Scalar>
+    void evolve(Eigen::Matrix<Scalar, Eigen::Dynamic, 1> & point) const {
+        using std::sin;
+        Float const& pi = aux::Scalar<Float>::pi();
+        point[2] += point[0];
+        point[3] += point[1];
+
+        Scalar coupling = xi*sin(2*pi*(point[2] + point[3]));
+        point[0] += k1*sin(2*pi*point[2]) + coupling;
+        point[1] += k2*sin(2*pi*point[3]) + coupling;
+        this->apply_boundary_conditions(point, bounding_box);
+    }
+};
+
+template <typename Float>
+class AutomaticHenon : public map::generic::Automatic<AutomaticHenon<Float>, Float> {
+    map::generic::NCoupledHenon<Float> henon;  // for its parameters
+public:
+    AutomaticHenon(unsigned int D) : map::generic::Automatic<AutomaticHenon<Float>, Float>(D, "ch"), henon(D) {
+        this->boundary = henon.boundary;
+    }
+
+    template <typename Scalar>
+    void evolve(Eigen::Matrix<Scalar, Eigen::Dynamic, 1> & point) const {
+        unsigned int const D = this->D;
+        Float a_min = 3, a_max = 5, b = aux::from_string<Float>("0.3"), k = aux::from_string<Float>("0.4");
+        Scalar x0 = point[0];
+        for (unsigned int i = 0; i < D/2; i++) {
+            Scalar x = point[i];
+            Scalar u = i + 1 == D/2 ? x0 : point[i + 1];
+            Float a = i + 1 == D/2 ? a_max : a_min + (a_max - a_min)*i/(D/2 - 1);
+            point[i] = a - x*x + b*point[i + D/2] + k*(x - u);
+            point[i + D/2] = x;
+        }
+    }
+};
+
+
+// compares the evolution, the jacobian and the tangent vectors of the two maps along a trajectory.
+template <typename Map, typename Automatic>
+void expect_same_derivatives(Map & map, Automatic & automatic, unsigned int steps, double tolerance) {
+    typedef typename Map::Vector Vector;
+    typedef typename Map::Matrix Matrix;
+    Vector point = proposal::proposeUniform(map.boundary);
+    Vector tangent = aux::unitaryVector<typename Map::Scalar>(map.D);
+    for (unsigned int t = 0; t < steps; t++) {
+        Matrix jacobian = map.jacobian(point);
+        EXPECT_NEAR(0, aux::to_double((jacobian - automatic.jacobian(point)).cwiseAbs().maxCoeff()), tolerance);
+
+        Vector expected_tangent = tangent;
+        map.jvp(point, expected_tangent);
+        Vector automatic_tangent = tangent;
+        automatic.jvp(point, automatic_tangent);
+        EXPECT_NEAR(0, aux::to_double((expected_tangent - automatic_tangent).cwiseAbs().maxCoeff()), tolerance);
+
+        Vector expected_point = point;
+        map.T(expected_point);
+        Vector automatic_point = point;
+        automatic.T(automatic_point);
+        EXPECT_NEAR(0, aux::to_double((expected_point - automatic_point).cwiseAbs().maxCoeff()), tolerance);
+
+        // the fused steps
+        Vector step_point = point, step_tangent = tangent;
+        Matrix step_jacobian;
+        automatic.step(step_point, &step_tangent, nullptr);
+        EXPECT_EQ(automatic_point, step_point);
+        EXPECT_EQ(automatic_tangent, step_tangent);
+        step_point = point;
+        step_tangent = tangent;
+        automatic.step(step_point, &step_tangent, &step_jacobian);
+        EXPECT_EQ(automatic_point, step_point);
+        EXPECT_NEAR(0, aux::to_double((step_tangent - automatic_tangent).cwiseAbs().maxCoeff()), tolerance);
+        EXPECT_NEAR(0, aux::to_double((jacobian - step_jacobian).cwiseAbs().maxCoeff()), tolerance);
+
+        point = expected_point;
+        tangent = expected_tangent;
+        aux::normalize(tangent);
+        if (map.has_exited(point))
+            point = proposal::proposeUniform(map.boundary);
+    }
+}
+
+
+TEST(Automatic, Maps) {
+    map::generic::Standard<double> standard(6);
+    AutomaticStandard<double> automatic_standard(6);
+    expect_same_derivatives(standard, automatic_standard, 100, 1e-12);
+
+    map::generic::CoupledStandard<double> coupled;
+    AutomaticCoupledStandard<double> automatic_coupled;
+    expect_same_derivatives(coupled, automatic_coupled, 100, 1e-12);
+
+    map::generic::NCoupledHenon<double> henon(8);
+    AutomaticHenon<double> automatic_henon(8);
+    expect_same_derivatives(henon, automatic_henon, 100, 1e-12);
+
+    mpfr_prec_t precision = mpfr::mpreal::get_default_prec();
+    mpfr::mpreal::set_default_prec(256);
+    map::Standard mp_standard(6);
+    AutomaticStandard<mpfr::mpreal> mp_automatic_standard(6);
+    expect_same_derivatives(mp_standard, mp_automatic_standard, 20, 1e-65);
+
+    map::CoupledStandard mp_coupled;
+    AutomaticCoupledStandard<mpfr::mpreal> mp_automatic_coupled;
+    expect_same_derivatives(mp_coupled, mp_automatic_coupled, 20, 1e-65);
+
+    map::NCoupledHenon mp_henon(8);
+    AutomaticHenon<mpfr::mpreal> mp_automatic_henon(8);
+    expect_same_derivatives(mp_henon, mp_automatic_henon, 20, 1e-65);
+    mpfr::mpreal::set_default_prec(precision);
+}
+
+
+TEST(Automatic, Observables) {
+    map::generic::Standard<double> standard(6);
+    AutomaticStandard<double> automatic(6);
+    observable::generic::Lyapunov<double> lyapunov(standard, 100);
+    observable::generic::Lyapunov<double, Eigen::Dynamic, AutomaticStandard<double> > automatic_lyapunov(automatic, 100);
+    observable::generic::EscapeWithVector<double> escape(standard, 100);
+    observable::generic::EscapeWithVector<double, Eigen::Dynamic, AutomaticStandard<double> > automatic_escape(automatic, 100);
+
+    for (unsigned int i = 0; i < 100; i++) {
+        Eigen::VectorXd point = proposal::proposeUniform(standard.boundary);
+        lyapunov.observe(point);
+        automatic_lyapunov.observe(point);
+        EXPECT_NEAR(lyapunov.lyapunov(), automatic_lyapunov.lyapunov(), 1e-8);
+
+        escape.observe(point);
+        automatic_escape.observe(point);
+        EXPECT_EQ(escape.escape_time, automatic_escape.escape_time);
+    }
+}
+
+#endif //chaospp_test_dual_h
@@ -0,0 +1,254 @@
+#ifndef chaospp_test_kernel_h
+#define chaospp_test_kernel_h
+
+#include "gtest/gtest.h"
+#include "map.h"
+#include "proposal.h"
+
+
+// the map evaluated with `mpfr::mpreal` expressions instead of the MPFR kernels.
+template <typename Map>
+struct Expression : public Map {
+    typedef typename Map::Workspace Workspace;
+    using Map::Map;
+    using Map::T;
+    using Map::jacobian;
+    using Map::jvp;
+    using Map::step;
+
+    void T(typename Map::Vector & point, Workspace & w) const {
+        Map::T(point, w, std::false_type());
+    }
+
+    typename Map::Matrix const& jacobian(typename Map::Vector const& point, Workspace & w) const {
+        return expression_jacobian(point, w, 0);
+    }
+
+    void jvp(typename Map::Vector const& point, typename Map::Vector & tangent, Workspace & w) const {
+        tangent = jacobian(point, w)*tangent;
+    }
+
+    // `jacobian` followed by `T`
+    void step(typename Map::Vector & point, typename Map::Vector * tangent, typename Map::Matrix * jac,
+              Workspace & w) const {
+        map::generic::Map<typename Map::Scalar, Map::Dimension>::step(point, tangent, jac, w);
+    }
+
+private:
+    // maps without an MPFR kernel for the jacobian
+    typename Map::Matrix const& expression_jacobian(typename Map::Vector const& point, Workspace & w, long) const {
+        return Map::jacobian(point, w);
+    }
+
+    template <typename M = Map>
+    auto expression_jacobian(typename Map::Vector const& point, Workspace & w, int) const
+            -> decltype(M::jacobian(point, w, std::false_type())) {
+        return M::jacobian(point, w, std::false_type());
+    }
+};
+
+
+// compares the kernels of `map` with the expressions of `expression` along a trajectory.
+template <typename Map>
+void expect_same_trajectory(Map & map, Expression<Map> & expression, unsigned int steps, double tolerance) {
+    Vector point = proposal::proposeUniform(map.boundary);
+    Vector point_expression = point;
+    for (unsigned int t = 0; t < steps; t++) {
+        Matrix jacobian = map.jacobian(point);
+        Matrix jacobian_expression = expression.jacobian(point_expression);
+        map.T(point);
+        expression.T(point_expression);
+
+        for (unsigned int i = 0; i < map.D; i++) {
+            EXPECT_NEAR(0, (double) abs(point[i] - point_expression[i]), tolerance);
+            for (unsigned int j = 0; j < map.D; j++)
+                EXPECT_NEAR(0, (double) abs(jacobian(i, j) - jacobian_expression(i, j)), tolerance);
+        }
+        point_expression = point;
+    }
+}
+
+
+TEST(Kernel, Maps) {
+    mpfr::mpreal::set_default_prec(256);
+    double tolerance = 1e-70;
+
+    map::Standard standard(6);
+    Expression<map::Standard> standard_expression(6);
+    expect_same_trajectory(standard, standard_expression, 20, tolerance);
+
+    map::CoupledStandard coupled;
+    Expression<map::CoupledStandard> coupled_expression;
+    expect_same_trajectory(coupled, coupled_expression, 20, tolerance);
+
+    map::Manneville manneville(Float("2.5"));
+    Expression<map::Manneville> manneville_expression(Float("2.5"));
+    expect_same_trajectory(manneville, manneville_expression, 20, tolerance);
+
+    map::Tent tent(3);
+    Expression<map::Tent> tent_expression(3);
+    expect_same_trajectory(tent, tent_expression, 20, tolerance);
+
+    map::OpenTent open_tent(3, 5);
+    Expression<map::OpenTent> open_tent_expression(3, 5);
+    expect_same_trajectory(open_tent, open_tent_expression, 20, tolerance);
+
+    map::Logistic logistic(4);
+    Expression<map::Logistic> logistic_expression(4);
+    expect_same_trajectory(logistic, logistic_expression, 20, tolerance);
+
+    map::NCoupledHenon henon(6);
+    Expression<map::NCoupledHenon> henon_expression(6);
+    expect_same_trajectory(henon, henon_expression, 5, tolerance);
+}
+
+
+// `kernel::wrap_unit` is `Map::apply_boundary_conditions` of [0, 1], also at the integers and with the sign of zero.
+TEST(Kernel, wrap_unit) {
+    mpfr::mpreal::set_default_prec(128);
+    std::vector<std::pair<Float, Float> > box(1, std::make_pair(Float(0), Float(1)));
+    const char* values[] = {"-3", "-2", "-1", "-0.75", "-0.5", "0", "0.5", "1", "1.25", "2", "3", "7.5"};
+    for (const char* value : values) {
+        SCOPED_TRACE(value);
+        Vector expected(1);
+        expected[0] = Float(value);
+        map::Map::apply_boundary_conditions(expected, box);
+        Float wrapped(value);
+        map::kernel::wrap_unit(wrapped);
+        EXPECT_EQ(expected[0], wrapped);
+        EXPECT_EQ(mpfr_signbit(expected[0].mpfr_srcptr()), mpfr_signbit(wrapped.mpfr_srcptr()));
+    }
+
+    // the standard map with its kernels and with expressions at integer states, and with a state of lower precision
+    // than its parameter (kept by `p += k*sin(2*pi*q)`).
+    map::Standard standard(6);
+    Expression<map::Standard> expression(6);
+    const char* integers[][2] = {{"1", "0"}, {"2", "0"}, {"-1", "0"}, {"-2", "0"}, {"0", "0"}};
+    for (auto const& integer : integers) {
+        Vector point(2), point_expression(2);
+        point << Float(integer[0]), Float(integer[1]);
+        point_expression = point;
+        standard.T(point);
+        expression.T(point_expression);
+        for (unsigned int i = 0; i < 2; i++) {
+            EXPECT_EQ(point_expression[i], point[i]);
+            EXPECT_EQ(mpfr_signbit(point_expression[i].mpfr_srcptr()), mpfr_signbit(point[i].mpfr_srcptr()));
+        }
+    }
+
+    Vector point(2), point_expression(2);
+    point << Float("0.3", 64), Float("0.2", 64);
+    point_expression = point;
+    standard.T(point);
+    expression.T(point_expression);
+    for (unsigned int i = 0; i < 2; i++)
+        EXPECT_EQ(point_expression[i].get_prec(), point[i].get_prec());
+
+    // the coupled Henon map with a state and a tangent of lower precision than its coupling `k`: the diagonal of the
+    // jacobian (`k - 2*x`) and the coordinates it assigns take the precision of `k`.
+    map::NCoupledHenon henon(6);
+    Vector henon_point(6), tangent(6);
+    for (unsigned int i = 0; i < 6; i++) {
+        henon_point[i] = Float("0.11", 64);
+        tangent[i] = Float("0.5", 64);
+    }
+    Matrix jacobian = henon.jacobian(henon_point);
+    for (unsigned int i = 0; i < 3; i++)
+        EXPECT_EQ(128, jacobian(i, i).get_prec());
+    henon.jvp(henon_point, tangent);
+    henon.T(henon_point);
+    for (unsigned int i = 0; i < 3; i++) {
+        EXPECT_EQ(128, henon_point[i].get_prec());
+        EXPECT_EQ(128, tangent[i].get_prec());
+    }
+}
+
+// |expected - value| < tolerance*max(1, |expected|)
+template <typename Float>
+void expect_close(Float const& expected, Float const& value, double tolerance) {
+    using std::abs;
+    EXPECT_NEAR(0, aux::to_double(abs(expected - value)), tolerance*std::max(1., aux::to_double(abs(expected))));
+}
+
+
+// `map.step` evolves `point`, `tangent` and the jacobian as `map.jacobian` followed by `map.T`, and `map.jvp` is the
+// product of `map.jacobian` with the tangent.
+template <typename Map>
+void expect_same_step(Map & map, unsigned int steps, double tolerance) {
+    typedef typename Map::Scalar Float;
+    typename Map::Vector point = proposal::proposeUniform(map.boundary);
+    typename Map::Vector tangent = aux::unitaryVector<Float>(map.D);
+    typename Map::Matrix jacobian(map.D, map.D);
+    for (unsigned int t = 0; t < steps; t++) {
+        typename Map::Matrix expected_jacobian = map.jacobian(point);
+        typename Map::Vector expected_tangent = expected_jacobian*tangent;
+        typename Map::Vector expected_point = point;
+        map.T(expected_point);
+
+        // without the jacobian, the tangent is evolved with `jvp`
+        typename Map::Vector jvp_tangent = tangent;
+        map.jvp(point, jvp_tangent);
+        typename Map::Vector step_point = point, step_tangent = tangent;
+        map.step(step_point, &step_tangent, nullptr);
+        for (unsigned int i = 0; i < map.D; i++) {
+            expect_close(expected_tangent[i], jvp_tangent[i], tolerance);
+            expect_close(expected_point[i], step_point[i], tolerance);
+            expect_close(expected_tangent[i], step_tangent[i], tolerance);
+        }
+
+        map.step(point, &tangent, &jacobian);
+
+        for (unsigned int i = 0; i < map.D; i++) {
+            expect_close(expected_point[i], point[i], tolerance);
+            expect_close(expected_tangent[i], tangent[i], tolerance);
+            for (unsigned int j = 0; j < map.D; j++)
+                expect_close(expected_jacobian(i, j), jacobian(i, j), tolerance);
+        }
+        point = expected_point;
+        aux::normalize(tangent);
+    }
+
+    // without tangent space, it is `T`
+    typename Map::Vector expected_point = point;
+    map.T(expected_point);
+    map.step(point, nullptr, nullptr);
+    for (unsigned int i = 0; i < map.D; i++)
+        EXPECT_EQ(expected_point[i], point[i]);
+}
+
+
+template <typename Float>
+void expect_same_step(double tolerance) {
+    map::generic::Standard<Float> standard(6);
+    expect_same_step(standard, 20, tolerance);
+
+    map::generic::CoupledStandard<Float> coupled;
+    expect_same_step(coupled, 20, tolerance);
+
+    map::generic::Manneville<Float> manneville(2);
+    expect_same_step(manneville, 20, tolerance);
+
+    map::generic::Manneville<Float> manneville_real(aux::from_string<Float>("2.5"));
+    expect_same_step(manneville_real, 20, tolerance);
+
+    map::generic::Tent<Float> tent(3);
+    expect_same_step(tent, 20, tolerance);
+
+    map::generic::OpenTent<Float> open_tent(3, 5);
+    expect_same_step(open_tent, 5, tolerance);
+
+    map::generic::Logistic<Float> logistic(4);
+    expect_same_step(logistic, 20, tolerance);
+
+    map::generic::NCoupledHenon<Float> henon(6);
+    expect_same_step(henon, 3, tolerance);
+}
+
+
+TEST(Kernel, Step) {
+    mpfr::mpreal::set_default_prec(256);
+    expect_same_step<mpfr::mpreal>(1e-70);
+    expect_same_step<double>(1e-12);
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "observable.h"
 #include "map.h"
+#include "proposal.h"
 
 
 TEST(NCoupledHenon, T) {
@@ -73,4 +74,167 @@ TEST(NCoupledHenon, jacobian4D) {
 }
 
 
+// the map and observables with a compile-time dimension give the same results.
+TEST(NCoupledHenon, fixedDimension) {
+    typedef observable::generic::EscapeWithMatrix<Float, 4> Observable;
+
+    map::NCoupledHenon map(4);
+    map::generic::NCoupledHenon<Float, 4> fixed_map(4);
+    observable::EscapeWithMatrix observer(map);
+    Observable fixed_observer(fixed_map);
+
+    Vector point(4);
+    point << Float("0.11"), Float("2.15"), Float("0.11"), Float("0.11");
+    Observable::Vector fixed_point(point);
+
+    observer.observe(point);
+    fixed_observer.observe(fixed_point);
+
+    EXPECT_EQ(observer.escape_time, fixed_observer.escape_time);
+    for (unsigned int i = 0; i < 4; i++)
+        for (unsigned int j = 0; j < 4; j++)
+            EXPECT_EQ(observer.jacobian(i, j), fixed_observer.jacobian(i, j));
+
+    proposal::Anisotropic<Observable> proposal(fixed_map.boundary);
+    Observable::Vector proposed = proposal.propose(fixed_observer);
+    EXPECT_FALSE(fixed_map.has_exited(proposed));
+}
+
+
+// the jacobian is zero outside the declared sparsity, and `EscapeWithMatrix` multiplies the sparse jacobians of the
+// steps as the dense product.
+TEST(NCoupledHenon, sparseJacobian) {
+    for (unsigned int D = 2; D <= 32; D *= 2) {
+        SCOPED_TRACE(D);
+        map::generic::NCoupledHenon<double> map(D);
+        observable::generic::EscapeWithMatrix<double> observer(map, 5);
+
+        map::generic::NCoupledHenon<double>::Matrix mask = map::generic::NCoupledHenon<double>::Matrix::Ones(D, D);
+        map::generic::NCoupledHenon<double>::Pattern pattern = map.sparsity();
+        for (unsigned int e = 0; e < pattern.size(); e++)
+            mask(pattern[e].first, pattern[e].second) = 0;
+        EXPECT_GE(3*D, pattern.size());
+
+        std::vector<std::pair<double, double> > box(D, std::make_pair(-1., 1.));
+        for (unsigned int n = 0; n < 10; n++) {
+            Eigen::VectorXd point = proposal::proposeUniform(box);
+            observer.observe(point);
+
+            Eigen::MatrixXd expected = Eigen::MatrixXd::Identity(D, D);
+            for (unsigned int t = 0; t < observer.escape_time; t++) {
+                EXPECT_EQ(0, map.jacobian(point).cwiseProduct(mask).cwiseAbs().maxCoeff());
+                expected *= map.jacobian(point);
+                map.T(point);
+            }
+            EXPECT_NEAR(0, (observer.jacobian - expected).cwiseAbs().maxCoeff(), 1e-10*expected.cwiseAbs().maxCoeff());
+        }
+    }
+}
+
+
+// the linear map x -> 2x without escape, as a subclass of the coupled Henon map.
+class DoublingHenon : public map::generic::NCoupledHenon<double> {
+public:
+    using map::generic::NCoupledHenon<double>::T;
+    using map::generic::NCoupledHenon<double>::jacobian;
+    using map::generic::NCoupledHenon<double>::jvp;
+
+    DoublingHenon(unsigned int D) : map::generic::NCoupledHenon<double>(D) {}
+
+    void T(Vector & point, Workspace &) const {
+        point *= 2;
+    }
+
+    Matrix const& jacobian(Vector const&, Workspace & w) const {
+        w.jacobian = 2*Matrix::Identity(D, D);
+        return w.jacobian;
+    }
+
+    void jvp(Vector const&, Vector & tangent, Workspace &) const {
+        tangent *= 2;
+    }
+
+    bool has_exited(Vector const&) const {return false;}
+
+    Pattern sparsity() const {return Pattern();}
+};
+
+typedef map::generic::Final<DoublingHenon> FinalDoublingHenon;
+
+
+// the observables of `Map`, a map of type DoublingHenon, evolve it with its overrides.
+template <typename Map>
+void expect_doubling(Map const& map) {
+    Eigen::VectorXd point(6);
+    point << 0.11, 2.15, 2.11, 0.11, 0.11, 0.11;
+
+    Eigen::VectorXd state = point;
+    Eigen::VectorXd tangent = Eigen::VectorXd::Unit(6, 0);
+    Eigen::MatrixXd jacobian;
+    map.step(state, &tangent, &jacobian);
+    EXPECT_EQ(Eigen::VectorXd(2*point), state);
+    EXPECT_EQ(Eigen::VectorXd(2*Eigen::VectorXd::Unit(6, 0)), tangent);
+    EXPECT_EQ(Eigen::MatrixXd(2*Eigen::MatrixXd::Identity(6, 6)), jacobian);
+
+    observable::generic::EscapeTime<double, Eigen::Dynamic, Map> observer(map, 10);
+    observer.observe(point);
+    EXPECT_EQ(10u, observer.escape_time);
+
+    observable::generic::EscapeWithVector<double, Eigen::Dynamic, Map> vector_observer(map, 10);
+    vector_observer.observe(point);
+    EXPECT_EQ(10u, vector_observer.escape_time);
+    EXPECT_NEAR(log(2.), vector_observer.lyapunov(), 1e-12);
+
+    observable::generic::EscapeWithMatrix<double, Eigen::Dynamic, Map> matrix_observer(map, 10);
+    matrix_observer.observe(point);
+    EXPECT_EQ(Eigen::MatrixXd(1024*Eigen::MatrixXd::Identity(6, 6)), matrix_observer.jacobian);
+
+    observable::generic::Lyapunov<double, Eigen::Dynamic, Map> lyapunov(map, 10);
+    lyapunov.observe(point);
+    EXPECT_NEAR(log(2.), lyapunov.lyapunov(), 1e-12);
+}
+
+
+// the observables of a concrete map that is not final call the overrides of its subclasses, also in `step`; the final
+// ones are called without virtual dispatch.
+TEST(NCoupledHenon, subclass_override) {
+    EXPECT_FALSE(aux::is_final<map::generic::NCoupledHenon<double> >::value);
+    EXPECT_TRUE(aux::is_final<FinalDoublingHenon>::value);
+
+    DoublingHenon map(6);
+    expect_doubling<map::generic::NCoupledHenon<double> >(map);
+    expect_doubling<map::generic::Map<double> >(map);
+
+    FinalDoublingHenon final_map(6);
+    expect_doubling<FinalDoublingHenon>(final_map);
+}
+
+
+// the built-in maps are called without virtual dispatch through `map::Final`.
+TEST(NCoupledHenon, final_builtin_maps) {
+    EXPECT_TRUE(map::Static<map::Final<map::Manneville> >::devirtualized::value);
+    EXPECT_TRUE(map::Static<map::Final<map::Standard> >::devirtualized::value);
+    EXPECT_TRUE(map::Static<map::Final<map::CoupledStandard> >::devirtualized::value);
+    EXPECT_TRUE(map::Static<map::Final<map::Tent> >::devirtualized::value);
+    EXPECT_TRUE(map::Static<map::Final<map::OpenTent> >::devirtualized::value);
+    EXPECT_TRUE(map::Static<map::Final<map::Logistic> >::devirtualized::value);
+    EXPECT_TRUE(map::Static<map::Final<map::NCoupledHenon> >::devirtualized::value);
+    EXPECT_TRUE((map::Static<map::generic::Final<map::generic::Tent<double, 1> > >::devirtualized::value));
+    EXPECT_FALSE(map::Static<map::Tent>::devirtualized::value);
+
+    map::NCoupledHenon henon(6);
+    map::Final<map::NCoupledHenon> final_henon(6);
+    Vector point = proposal::proposeUniform(henon.boundary);
+    Vector final_point = point;
+    Vector tangent = Vector::Unit(6, 0);
+    Vector final_tangent = tangent;
+    for (unsigned int t = 0; t < 5; t++) {
+        henon.step(point, &tangent, nullptr);
+        map::Static<map::Final<map::NCoupledHenon> >::step(final_henon, final_point, &final_tangent, nullptr,
+                                                          final_henon.local_workspace());
+    }
+    EXPECT_EQ(point, final_point);
+    EXPECT_EQ(tangent, final_tangent);
+}
+
 #endif
@@ -2,6 +2,7 @@
 #define test_map_standard_h
 
 #include "map.h"
+#include "multi_double.h"
 
 TEST(TestStandardMap, iteration) {
     map::Standard map(Float(4));
@@ -41,4 +42,57 @@ TEST(TestStandardMap, derivative) {
 }
 
 
+// the map with a compile-time dimension gives the same results.
+TEST(TestStandardMap, fixedDimension) {
+    typedef map::generic::Standard<Float, 2> Standard;
+    Standard map(Float(4));
+
+    Standard::Vector point;
+    point << Float("0.1"), Float("0.1");
+    Standard::Vector vector;
+    vector << 1/sqrt(Float(2)), 1/sqrt(Float(2));
+
+    map.dT(point, vector);
+    map.T(point);
+
+    EXPECT_DOUBLE_EQ(0.47419571351545561328516762646, (double)point[0]);
+    EXPECT_DOUBLE_EQ(0.57419571351545561328516762646, (double)point[1]);
+    EXPECT_DOUBLE_EQ(2.995352392457285, (double)vector[0]);
+    EXPECT_DOUBLE_EQ(3.702459173643832, (double)vector[1]);
+}
+
+
+// the double-double and quad-double maps evolve as the map in a higher precision, up to their last bits.
+template <typename Scalar>
+void expect_standard_map_as_mpreal(double tolerance) {
+    mpfr::mpreal::set_default_prec(300);
+    map::generic::Standard<Scalar> map(Scalar(6));
+    map::Standard reference_map(Float(6));
+
+    typename map::generic::Standard<Scalar>::Vector point(2), vector(2);
+    point << Scalar("0.1"), Scalar("0.3");
+    vector << 1/sqrt(Scalar(2)), 1/sqrt(Scalar(2));
+    Vector reference_point(2), reference_vector(2);
+    for (unsigned int i = 0; i < 2; i++) {
+        reference_point[i] = (mpfr::mpreal) point[i];
+        reference_vector[i] = (mpfr::mpreal) vector[i];
+    }
+
+    for (unsigned int t = 0; t < 10; t++) {
+        map.step(point, &vector, nullptr);
+        reference_map.step(reference_point, &reference_vector, nullptr);
+        for (unsigned int i = 0; i < 2; i++) {
+            EXPECT_GT(tolerance, (double) abs((mpfr::mpreal) point[i] - reference_point[i]));
+            EXPECT_GT(tolerance*abs(reference_vector[i]), abs((mpfr::mpreal) vector[i] - reference_vector[i]));
+        }
+    }
+}
+
+TEST(TestStandardMap, multipleDouble) {
+    // the errors grow by about 3 per step
+    expect_standard_map_as_mpreal<aux::dd_real>(1e-25);
+    expect_standard_map_as_mpreal<aux::qd_real>(1e-57);
+}
+
+
 #endif
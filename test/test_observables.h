@@ -2,6 +2,8 @@
 #define CHAOSPP_TEST_OBSERVABLES_H
 
 #include "observable.h"
+#include "proposal.h"
+#include "multi_double.h"
 
 TEST(TentMap, Lyapunov) {
     map::Tent map(3);
@@ -47,4 +49,363 @@ TEST(TentMap, EscapeTime) {
 }
 
 
+TEST(TentMap, AdaptiveEscapeTime) {
+    map::generic::OpenTent<double> fast_map(3, 5);
+    map::OpenTent map(3, 5);
+    observable::AdaptiveEscapeTime<> obs(fast_map, map);
+    observable::EscapeTime reference(map);
+
+    Vector point(1);
+
+    // short trajectories are computed in double precision
+    point[0] = Float("0.0000000001");
+    obs.observe(point);
+    EXPECT_EQ(21, obs.escape_time);
+    EXPECT_EQ(53, obs.precision);
+
+    // a stretch of 3^63 does not fit in a double: the state is re-observed with higher precision
+    point[0] = Float("1e-30");
+    obs.observe(point);
+    reference.observe(point);
+    EXPECT_EQ(reference.escape_time, obs.escape_time);
+    EXPECT_LT(53, obs.precision);
+    EXPECT_NEAR(log(3.), obs.lyapunov(), 1e-10);
+
+    for (unsigned int i = 0; i < 100; i++) {
+        point[0] = aux::urandom();
+        obs.observe(point);
+        reference.observe(point);
+        EXPECT_EQ(reference.escape_time, obs.escape_time);
+    }
+
+    // the precision follows the FTLE, 1 bit per step, over the 60 steps of the observation.
+    map::generic::OpenTent<double> fast_doubling(2, 2);
+    map::OpenTent doubling(2, 2);
+    observable::AdaptiveEscapeTime<> obs2(fast_doubling, doubling, 60);
+    point[0] = Float("0.3");
+    obs2.observe(point);
+    EXPECT_EQ(obs2.margin + 60, obs2.precision);
+    EXPECT_NEAR(log(2.), obs2.lyapunov(), 1e-12);
+
+    // the observation does not exceed its maximum precision.
+    observable::AdaptiveEscapeTime<> obs3(fast_doubling, doubling, 1000, 16, 80);
+    EXPECT_THROW(obs3.observe(point), std::overflow_error);
+}
+
+
+TEST(TentMap, AdaptiveLyapunov) {
+    map::generic::Tent<double> fast_map(3);
+    map::Tent map(3);
+
+    Vector point(1);
+    point[0] = Float("0.0000000001");
+
+    observable::AdaptiveLyapunov<> obs(fast_map, map, 10);
+    obs.observe(point);
+    EXPECT_EQ(53, obs.precision);
+    EXPECT_NEAR(log(3.), obs.lyapunov(), 1e-12);
+
+    // a stretch of 2^62 does not fit in a double
+    observable::AdaptiveLyapunov<> obs1(fast_map, map, 50);
+    observable::Lyapunov reference(map, 50);
+    obs1.observe(point);
+    reference.observe(point);
+    EXPECT_LT(53, obs1.precision);
+    EXPECT_NEAR(reference.lyapunov(), obs1.lyapunov(), 1e-12);
+
+    // a stretch of more than 1.5^2000 = 2^1170 overflows the jacobian in double.
+    observable::AdaptiveLyapunov<> obs2(fast_map, map, 2000);
+    obs2.observe(point);
+    EXPECT_LT(1170 + obs2.margin, obs2.precision);
+    Vector precise_point(1);
+    precise_point[0] = point[0];
+    precise_point[0].set_prec(obs2.precision);
+    observable::Lyapunov reference2(map, 2000);
+    reference2.observe(precise_point);
+    EXPECT_TRUE(std::isfinite(obs2.lyapunov()));
+    EXPECT_NEAR(reference2.lyapunov(), obs2.lyapunov(), 1e-12);
+
+    // the observation does not exceed its maximum precision.
+    observable::AdaptiveLyapunov<> obs3(fast_map, map, 2000, 16, 1024);
+    EXPECT_THROW(obs3.observe(point), std::overflow_error);
+}
+
+
+TEST(TentMap, LyapunovSpectrum) {
+    map::Tent map(3);
+    Vector point(1);
+    point[0] = Float("0.0000000001");
+
+    observable::LyapunovSpectrum obs(map, 10);
+    obs.observe(point);
+    EXPECT_NEAR(log(3.), obs.lyapunov(), 1e-12);
+
+    // a stretch of more than 1.5^2000 overflows the jacobian in double, but not the log-stretches.
+    map::generic::Tent<double> double_map(3);
+    observable::generic::LyapunovSpectrum<double> spectrum(double_map, 2000, 10);
+    Eigen::VectorXd double_point(1);
+    double_point[0] = 0.1;
+    spectrum.observe(double_point);
+    EXPECT_LT(log(std::numeric_limits<double>::max()), spectrum.log_stretch());
+    EXPECT_LE(log(1.5) - 1e-12, spectrum.lyapunov());
+    EXPECT_GE(log(3.) + 1e-12, spectrum.lyapunov());
+}
+
+
+TEST(StandardMap, LyapunovSpectrum) {
+    typedef map::generic::Standard<double>::Matrix Matrix;
+    map::generic::Standard<double> map(6);
+
+    for (unsigned int period = 1; period <= 7; period += 3) {
+        observable::generic::LyapunovSpectrum<double> obs(map, 20, period);
+        observable::generic::EscapeWithSpectrum<double> escape(map, 20, period);
+        for (unsigned int i = 0; i < 20; i++) {
+            Eigen::VectorXd point = proposal::proposeUniform(map.boundary);
+            obs.observe(point);
+            escape.observe(point);
+
+            // the jacobian of the trajectory
+            Matrix jacobian = Matrix::Identity(2, 2), step(2, 2);
+            for (unsigned int t = 0; t < 20; t++) {
+                map.step(point, nullptr, &step);
+                jacobian = step*jacobian;
+            }
+
+            // the first log-stretch is the one of the first vector of the basis; the sum is log|det| = 0 (symplectic),
+            // up to the condition number of the basis after `period` steps.
+            std::vector<double> spectrum = obs.spectrum();
+            EXPECT_NEAR(log(jacobian.col(0).norm())/20, obs.lyapunov(), 1e-10);
+            EXPECT_NEAR(0, spectrum[0] + spectrum[1], period == 1 ? 1e-12 : 1e-6);
+
+            if (escape.escape_time == 20)
+                EXPECT_NEAR(spectrum[0], escape.spectrum()[0], 1e-10);
+        }
+    }
+}
+
+
+// `EscapeWithVector` and `EscapeWithFastVector` starting from the same tangent vector.
+class FixedEscapeWithVector : public observable::EscapeWithVector {
+public:
+    Vector initial_tangent;
+
+    FixedEscapeWithVector(map::Map & map, unsigned int max_time) :
+            observable::EscapeWithVector(map, max_time), initial_tangent(aux::unitaryVector(map.D)) {}
+protected:
+    void initialize() {
+        observable::EscapeWithVector::initialize();
+        tangent = initial_tangent;
+    }
+};
+
+class FixedEscapeWithFastVector : public observable::EscapeWithFastVector {
+public:
+    Eigen::VectorXd initial_tangent;
+
+    FixedEscapeWithFastVector(map::Map & map, unsigned int max_time, Vector const& initial_tangent) :
+            observable::EscapeWithFastVector(map, max_time), initial_tangent(initial_tangent.size()) {
+        for (unsigned int i = 0; i < initial_tangent.size(); i++)
+            this->initial_tangent[i] = (double) initial_tangent[i];
+    }
+protected:
+    void initialize() {
+        observable::EscapeWithFastVector::initialize();
+        tangent = initial_tangent;
+    }
+};
+
+
+// the stretches in double precision along trajectories in arbitrary precision are the ones of the all-MPFR
+// observables, and so are the scales of `proposal::LyapunovIsotropic`.
+TEST(StandardMap, FastTangent) {
+    mpfr_prec_t precision = mpfr::mpreal::get_default_prec();
+    mpfr::mpreal::set_default_prec(256);
+    map::Standard map(6);
+
+    FixedEscapeWithVector escape(map, 100);
+    FixedEscapeWithFastVector fast_escape(map, 100, escape.initial_tangent);
+    proposal::LyapunovIsotropic<observable::EscapeWithVector> proposal(map.boundary);
+    proposal::LyapunovIsotropic<observable::EscapeWithFastVector> fast_proposal(map.boundary);
+
+    // long enough for the stretch to overflow a double.
+    observable::Lyapunov lyapunov(map, 1000);
+    observable::FastLyapunov fast_lyapunov(map, 1000);
+    proposal::LyapunovIsotropic<observable::Lyapunov> lyapunov_proposal(map.boundary);
+    proposal::LyapunovIsotropic<observable::FastLyapunov> fast_lyapunov_proposal(map.boundary);
+
+    for (unsigned int i = 0; i < 20; i++) {
+        Vector point = proposal::proposeUniform(map.boundary);
+        escape.observe(point);
+        fast_escape.observe(point);
+        EXPECT_EQ(escape.escape_time, fast_escape.escape_time);
+        EXPECT_NEAR(escape.lyapunov(), fast_escape.lyapunov(), 1e-12);
+        EXPECT_NEAR(1, (double) (fast_proposal.sigma(fast_escape)/proposal.sigma(escape)), 1e-10);
+
+        lyapunov.observe(point);
+        fast_lyapunov.observe(point);
+        EXPECT_LT(700, lyapunov.lyapunov()*1000);
+        EXPECT_NEAR(lyapunov.lyapunov(), fast_lyapunov.lyapunov(), 1e-12);
+        EXPECT_NEAR(0, (double) log(fast_lyapunov_proposal.sigma(fast_lyapunov)/lyapunov_proposal.sigma(lyapunov)), 1e-8);
+    }
+    mpfr::mpreal::set_default_prec(precision);
+}
+
+
+// `ComputeMatrix` of a given jacobian.
+template <typename Float>
+class GivenMatrix : public ComputeMatrix<Float> {
+public:
+    GivenMatrix(typename ComputeMatrix<Float>::Matrix const& jacobian) :
+            ComputeMatrix<Float>(jacobian.rows(), std::vector<std::vector<unsigned int> >()) {
+        this->jacobian = jacobian;
+        this->finalise();
+    }
+};
+
+// the closed-form stretch (D <= 2) is the largest absolute eigenvalue, and a real `eigenvector` is one of it.
+template <typename Float>
+void expect_stretch_as_eigen_solver(typename ComputeMatrix<Float>::Matrix const& jacobian,
+                                    double tolerance) {
+    using std::abs;
+    typedef typename ComputeMatrix<Float>::Vector Vector;
+    Eigen::EigenSolver<typename ComputeMatrix<Float>::Matrix> es(jacobian);
+    Float expected = 0;
+    bool real = true;
+    for (unsigned int i = 0; i < jacobian.rows(); i++)
+        if (abs(es.eigenvalues()[i]) > expected) {
+            expected = abs(es.eigenvalues()[i]);
+            real = es.eigenvalues()[i].imag() == 0;
+        }
+    Float scale = jacobian.cwiseAbs().maxCoeff();
+
+    GivenMatrix<Float> matrix(jacobian);
+    EXPECT_NEAR(0, aux::to_double((matrix.stretch() - expected)/(scale == 0 ? Float(1) : scale)), tolerance);
+    Vector vector = matrix.eigenvector();
+    EXPECT_EQ(jacobian.rows(), vector.size());
+    if (real) {
+        Vector image = jacobian*vector;
+        Float lambda = image.dot(vector)/vector.squaredNorm();
+        EXPECT_NEAR(0, aux::to_double((abs(lambda) - expected)/(scale == 0 ? Float(1) : scale)), tolerance);
+        EXPECT_NEAR(0, aux::to_double((image - lambda*vector).cwiseAbs().maxCoeff()/vector.norm()/
+                                      (scale == 0 ? Float(1) : scale)), tolerance);
+    }
+
+    // read in the other order, and copied
+    GivenMatrix<Float> other(jacobian);
+    other.eigenvector();
+    GivenMatrix<Float> copy(jacobian*2);
+    copy = other;
+    EXPECT_EQ(matrix.stretch(), copy.stretch());
+}
+
+template <typename Float>
+void expect_stretches_as_eigen_solver(double tolerance) {
+    typedef typename ComputeMatrix<Float>::Matrix Matrix;
+    map::generic::Standard<Float> map(6);
+    Matrix step(2, 2);
+    for (unsigned int i = 0; i < 20; i++) {
+        expect_stretch_as_eigen_solver<Float>(Matrix::Random(1, 1), tolerance);
+        expect_stretch_as_eigen_solver<Float>(Matrix::Random(2, 2), tolerance);
+        expect_stretch_as_eigen_solver<Float>(Matrix::Random(3, 3), tolerance);
+
+        // the jacobians of trajectories: hyperbolic and elliptic, with determinant 1.
+        typename map::generic::Standard<Float>::Vector point = proposal::proposeUniform(map.boundary);
+        Matrix jacobian = Matrix::Identity(2, 2);
+        for (unsigned int t = 0; t < 10; t++) {
+            map.step(point, nullptr, &step);
+            jacobian *= step;
+        }
+        expect_stretch_as_eigen_solver<Float>(jacobian, tolerance);
+        jacobian = Matrix::Identity(2, 2);
+        jacobian(0, 1) = Float(i + 1)/10;
+        jacobian(1, 0) = -Float(i + 1)/10;
+        expect_stretch_as_eigen_solver<Float>(jacobian, tolerance);
+    }
+
+    Matrix singular(2, 2), degenerate(2, 2);
+    singular << 1, 2, 2, 4;
+    degenerate << -3, 0, 0, -3;
+    expect_stretch_as_eigen_solver<Float>(singular, tolerance);
+    expect_stretch_as_eigen_solver<Float>(degenerate, tolerance);
+    expect_stretch_as_eigen_solver<Float>(Matrix::Zero(2, 2), tolerance);
+}
+
+TEST(ComputeMatrix, ClosedFormStretch) {
+    expect_stretches_as_eigen_solver<double>(1e-12);
+
+    mpfr_prec_t precision = mpfr::mpreal::get_default_prec();
+    mpfr::mpreal::set_default_prec(256);
+    expect_stretches_as_eigen_solver<mpfr::mpreal>(1e-60);
+    mpfr::mpreal::set_default_prec(precision);
+}
+
+
+// the escape times of the Standard map with the double-double and quad-double scalars are the ones of the map in
+// a higher precision, for times shorter than their ~106 and ~212 bits over the Lyapunov exponent.
+template <typename Scalar>
+void expect_escape_time_as_mpreal(unsigned int max_time) {
+    mpfr::mpreal::set_default_prec(300);
+    map::generic::Standard<Scalar> map(Scalar(6));
+    map::Standard reference_map(Float(6));
+    observable::generic::EscapeTime<Scalar> obs(map, max_time);
+    observable::EscapeTime reference(reference_map, max_time);
+
+    unsigned int longest = 0;
+    Vector reference_point(2);
+    for (unsigned int i = 0; i < 200; i++) {
+        typename map::generic::Standard<Scalar>::Vector point = proposal::proposeUniform(map.boundary);
+        for (unsigned int d = 0; d < 2; d++)
+            reference_point[d] = (mpfr::mpreal) point[d];
+        obs.observe(point);
+        reference.observe(reference_point);
+        EXPECT_EQ(reference.escape_time, obs.escape_time);
+        longest = std::max(longest, obs.escape_time);
+    }
+    // in double precision some of the trajectories would diverge
+    EXPECT_LT(40u, longest);
+}
+
+TEST(StandardMap, MultipleDoubleEscapeTime) {
+    expect_escape_time_as_mpreal<aux::dd_real>(50);
+    expect_escape_time_as_mpreal<aux::qd_real>(100);
+}
+
+
+// the FTLEs of the horizons and of the (overlapping) windows of one trajectory are the ones of separate observations.
+TEST(StandardMap, MultiLyapunov) {
+    map::generic::Standard<double> map(6);
+    std::vector<unsigned int> horizons = {20, 5, 10};
+    observable::generic::MultiLyapunov<double> multi(map, horizons, 8, 3);
+    EXPECT_EQ(5u, multi.windows());
+    EXPECT_EQ(20u, multi.tobs);
+
+    for (unsigned int i = 0; i < 20; i++) {
+        Eigen::VectorXd state = proposal::proposeUniform(map.boundary);
+        multi.observe(state);
+
+        std::sort(horizons.begin(), horizons.end());
+        for (unsigned int h = 0; h < horizons.size(); h++) {
+            observable::generic::Lyapunov<double> lyapunov(map, horizons[h]);
+            lyapunov.observe(state);
+            EXPECT_DOUBLE_EQ(lyapunov.lyapunov(), multi.lyapunov(h));
+        }
+        EXPECT_DOUBLE_EQ(multi.lyapunov(2), multi.lyapunov());
+
+        observable::generic::Lyapunov<double> lyapunov(map, 8);
+        Eigen::VectorXd point = state;
+        for (unsigned int w = 0; w < multi.windows(); w++) {
+            lyapunov.observe(point);
+            EXPECT_DOUBLE_EQ(lyapunov.lyapunov(), multi.window_lyapunov(w));
+            for (unsigned int t = 0; t < 3; t++)
+                map.T(point);
+        }
+    }
+
+    // without stride, the windows are contiguous.
+    observable::generic::MultiLyapunov<double> halves(map, std::vector<unsigned int>(1, 16), 8);
+    EXPECT_EQ(2u, halves.windows());
+    EXPECT_EQ(3u, (unsigned int) halves.values().size());
+}
+
+
 #endif //CHAOSPP_TEST_OBSERVABLES_H
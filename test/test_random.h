@@ -0,0 +1,150 @@
+#ifndef chaospp_test_random_h
+#define chaospp_test_random_h
+
+#include "gtest/gtest.h"
+#include "random.h"
+#include "map.h"
+#include "observable.h"
+#include "proposal.h"
+#include "sampler.h"
+
+
+// the known answers of Philox4x32-10 of Random123.
+TEST(Random, Philox) {
+    std::uint32_t counter[4] = {0, 0, 0, 0};
+    std::uint32_t key[2] = {0, 0};
+    aux::Stream::philox(counter, key);
+    EXPECT_EQ(0x6627e8d5u, counter[0]);
+    EXPECT_EQ(0xe169c58du, counter[1]);
+    EXPECT_EQ(0xbc57ac4cu, counter[2]);
+    EXPECT_EQ(0x9b00dbd8u, counter[3]);
+
+    std::uint32_t pi_counter[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+    std::uint32_t pi_key[2] = {0xa4093822, 0x299f31d0};
+    aux::Stream::philox(pi_counter, pi_key);
+    EXPECT_EQ(0xd16cfe09u, pi_counter[0]);
+    EXPECT_EQ(0x94fdccebu, pi_counter[1]);
+    EXPECT_EQ(0x5001e420u, pi_counter[2]);
+    EXPECT_EQ(0x24126ea1u, pi_counter[3]);
+}
+
+
+// a stream is reproducible from any position, and the streams of different ids differ.
+TEST(Random, Streams) {
+    aux::Stream stream(3, 1), other(3, 2);
+    std::vector<std::uint64_t> numbers(10);
+    for (unsigned int i = 0; i < numbers.size(); i++)
+        numbers[i] = stream();
+    EXPECT_EQ(10u, stream.position());
+    EXPECT_NE(numbers[0], other());
+
+    stream.seek(5);
+    for (unsigned int i = 5; i < numbers.size(); i++)
+        EXPECT_EQ(numbers[i], stream());
+    EXPECT_NE(aux::Stream::unique().id(), aux::Stream::unique().id());
+}
+
+
+// the buffer of a stream has the blocks of Philox of its counters, also across the 32 bits of the counter.
+TEST(Random, Buffer) {
+    aux::Stream stream(0x243f6a8885a308d3, 0x13198a2e03707344);
+    std::uint64_t const starts[3] = {0, 2*aux::Stream::buffer_words - 6, (std::uint64_t(1) << 33) - 100};
+    for (std::uint64_t start : starts) {
+        stream.seek(start);
+        for (std::uint64_t position = start; position < start + 3*aux::Stream::buffer_words; position += 2) {
+            std::uint64_t block = position/2;
+            std::uint32_t counter[4] = {(std::uint32_t) block, (std::uint32_t) (block >> 32), 0x03707344, 0x13198a2e};
+            std::uint32_t key[2] = {0x85a308d3, 0x243f6a88};
+            aux::Stream::philox(counter, key);
+            EXPECT_EQ(counter[0] | (std::uint64_t) counter[1] << 32, stream());
+            EXPECT_EQ(counter[2] | (std::uint64_t) counter[3] << 32, stream());
+        }
+    }
+}
+
+
+// the moments and the tails of the normal variates of the ziggurat.
+TEST(Random, Normals) {
+    aux::Stream stream(9);
+    unsigned int const N = 1000000;
+    std::vector<double> normals(N);
+    stream.normals(normals.data(), N);
+    double mean = 0, variance = 0, within_one = 0, beyond_three = 0, beyond_r = 0;
+    for (double x : normals) {
+        mean += x/N;
+        variance += x*x/N;
+        within_one += (std::abs(x) < 1)/(double) N;
+        beyond_three += (std::abs(x) > 3)/(double) N;
+        beyond_r += (std::abs(x) > 3.654152885361009)/(double) N;
+    }
+    EXPECT_NEAR(0, mean, 0.005);
+    EXPECT_NEAR(1, variance, 0.01);
+    EXPECT_NEAR(0.682689, within_one, 0.002);
+    EXPECT_NEAR(0.0026998, beyond_three, 0.0003);
+    EXPECT_NEAR(0.0002580, beyond_r, 0.00008);
+}
+
+
+// the random directions of `mpfr::mpreal` are unitary and isotropic.
+TEST(Random, Directions) {
+    mpfr::mpreal::set_default_prec(128);
+    aux::Stream stream(13);
+    unsigned int const N = 20000;
+    Vector direction(16);
+    Eigen::VectorXd mean = Eigen::VectorXd::Zero(16);
+    for (unsigned int i = 0; i < N; i++) {
+        aux::unitaryVector(direction, stream);
+        EXPECT_NEAR(1, aux::to_double(direction.norm()), 1e-15);
+        for (unsigned int d = 0; d < 16; d++)
+            mean[d] += aux::to_double(direction[d])/N;
+    }
+    EXPECT_GT(0.01, mean.cwiseAbs().maxCoeff());
+}
+
+
+// the uniform variates of `mpfr::mpreal` have the random bits of the default precision.
+TEST(Random, Precision) {
+    aux::Stream stream(5);
+    for (mpfr_prec_t precision : {20, 64, 100, 512}) {
+        mpfr::mpreal::set_default_prec(precision);
+        double mean = 0;
+        bool has_last_bit = false;
+        for (unsigned int i = 0; i < 1000; i++) {
+            mpfr::mpreal u = aux::urandom<mpfr::mpreal>(stream);
+            EXPECT_EQ(precision, u.get_prec());
+            EXPECT_TRUE(0 <= u and u < 1);
+            // u*2^precision is an integer
+            mpfr::mpreal scaled = u;
+            mpfr_mul_2ui(scaled.mpfr_ptr(), scaled.mpfr_srcptr(), precision, MPFR_RNDN);
+            EXPECT_TRUE(mpfr_integer_p(scaled.mpfr_srcptr()));
+            mpfr_div_2ui(scaled.mpfr_ptr(), scaled.mpfr_srcptr(), 1, MPFR_RNDN);
+            has_last_bit = has_last_bit or not mpfr_integer_p(scaled.mpfr_srcptr());
+            mean += u.toDouble()/1000;
+        }
+        EXPECT_TRUE(has_last_bit);
+        EXPECT_NEAR(0.5, mean, 0.05);
+    }
+}
+
+
+// a chain is reproducible from its stream.
+TEST(Random, Chains) {
+    mpfr::mpreal::set_default_prec(64);
+    map::OpenTent map(3, 5);
+    observable::EscapeTime observable(map, 20);
+    proposal::PowerLawIsotropic<observable::EscapeTime> proposal(map.boundary, -1, 20);
+
+    SamplingHistogram<observable::EscapeTime> first(0, 20, 20), second(0, 20, 20);
+    SamplingHistogram<observable::EscapeTime> * histograms[2] = {&first, &second};
+    for (unsigned int i = 0; i < 2; i++) {
+        MetropolisHastings<observable::EscapeTime> mc(observable, proposal, *histograms[i], aux::Stream(11, 4));
+        aux::Stream::local().seek(i*1000);  // the chain does not use the stream of the thread
+        mc.sample(500);
+    }
+    EXPECT_EQ(500u, first.count());
+    for (unsigned int bin = 0; bin <= first.bins(); bin++)
+        EXPECT_EQ(first[bin], second[bin]);
+}
+
+
+#endif
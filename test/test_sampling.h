@@ -1,6 +1,8 @@
 #ifndef chaospp_test_sampling_h
 #define chaospp_test_sampling_h
 
+#include <memory>
+
 #include "map.h"
 #include "sampler.h"
 #include "observable.h"
@@ -22,6 +24,238 @@ TEST(TestUniform, lyapunov_tent_map) {
 }
 
 
+// the FTLE of the Standard map in double precision, proposed with its own stretch.
+TEST(TestLyapunovIsotropic, spectrum_standard_map) {
+    typedef observable::generic::LyapunovSpectrum<double> Observable;
+    map::generic::Standard<double> map(6);
+    Observable observable(map, 20);
+
+    SamplingHistogram<Observable> histogram(0, 3, 30);
+    proposal::LyapunovIsotropic<Observable> proposal(map.boundary, 1);
+
+    MetropolisHastings<Observable> mc(observable, proposal, histogram);
+
+    mc.sample(200);
+
+    EXPECT_EQ(histogram.count(), 200);
+    EXPECT_TRUE(std::isfinite(observable.lyapunov()));
+}
+
+
+// the longest observation of all its copies.
+class LongestEscape : public observable::generic::EscapeTime<double> {
+public:
+    std::shared_ptr<unsigned int> longest;
+
+    LongestEscape(map::generic::Map<double> & map, unsigned int max_time) :
+            observable::generic::EscapeTime<double>(map, max_time), longest(new unsigned int(0)) {}
+protected:
+    void finalize() {
+        *longest = std::max(*longest, escape_time);
+    }
+};
+
+
+// the proposals above the range of the histogram are not evolved beyond it.
+TEST(TestUniform, histogram_upper_bound) {
+    map::generic::Standard<double> map(6);
+    LongestEscape observable(map, 1000);
+
+    // without a bound, the escape times of the standard map are longer than the histogram.
+    for (unsigned int i = 0; i < 1000; i++)
+        observable.observe(proposal::proposeUniform(map.boundary));
+    EXPECT_LT(10u, *observable.longest);
+
+    *observable.longest = 0;
+    SamplingHistogram<LongestEscape> histogram(0, 10, 10);
+    proposal::Uniform<LongestEscape> proposal(map.boundary);
+    MetropolisHastings<LongestEscape> mc(observable, proposal, histogram);
+    mc.sample(1000);
+
+    EXPECT_EQ(10u, *observable.longest);
+    EXPECT_EQ(1000u, histogram.count());
+
+    // an observation stops at the bound, out of the range.
+    observable::generic::EscapeTime<double> bounded(map, 1000);
+    bounded.set_upper_bound(3);
+    Eigen::VectorXd point;
+    do {
+        point = proposal::proposeUniform(map.boundary);
+        observable.observe(point);
+    } while (observable.escape_time <= 3);
+    bounded.observe(point);
+    EXPECT_EQ(3u, bounded.escape_time);
+    EXPECT_TRUE(histogram.invalid_value(histogram.upper_bound()));
+}
+
+
+// `Observable` without the bound of the samplers: its observations are complete.
+template <typename Observable>
+class Unbounded : public Observable {
+public:
+    using Observable::Observable;
+
+    void set_upper_bound(unsigned int const&) {}
+};
+
+
+// the histogram of a chain of `proposal` from the stream 3, in a range of escape times below many of the proposals.
+template <typename Observable, typename Proposal>
+std::vector<unsigned int> chain_histogram(map::generic::Map<double> & map, Proposal & proposal) {
+    Observable observable(map, 1000);
+    SamplingHistogram<Observable> histogram(0, 4, 4);
+    MetropolisHastings<Observable, Proposal> mc(observable, proposal, histogram, aux::Stream(3));
+    mc.sample(2000);
+
+    std::vector<unsigned int> counts;
+    for (unsigned int b = 0; b <= histogram.bins(); b++)
+        counts.push_back(histogram[b]);
+    return counts;
+}
+
+
+// the proposals are updated in the same way with the observations stopped at the upper bound of the histogram.
+TEST(TestAdaptive, histogram_upper_bound) {
+    map::generic::OpenTent<double> map(3, 5);
+
+    typedef observable::generic::EscapeTime<double> Escape;
+    proposal::Adaptive<Escape> adaptive(map.boundary);
+    proposal::Adaptive<Unbounded<Escape> > unbounded_adaptive(map.boundary);
+    EXPECT_EQ(chain_histogram<Escape>(map, adaptive), chain_histogram<Unbounded<Escape> >(map, unbounded_adaptive));
+    EXPECT_EQ(adaptive.sigma(Escape(map)), unbounded_adaptive.sigma(Unbounded<Escape>(map)));
+
+    typedef observable::generic::EscapeWithVector<double> EscapeWithVector;
+    proposal::LyapunovIsotropic<EscapeWithVector> lyapunov(map.boundary, 1);
+    proposal::LyapunovIsotropic<Unbounded<EscapeWithVector> > unbounded_lyapunov(map.boundary, 1);
+    EXPECT_EQ(chain_histogram<EscapeWithVector>(map, lyapunov),
+              chain_histogram<Unbounded<EscapeWithVector> >(map, unbounded_lyapunov));
+}
+
+
+// the number of steps of all the observations of its copies.
+class CountingEscape : public observable::generic::EscapeTime<double> {
+public:
+    std::shared_ptr<unsigned long> steps;
+
+    CountingEscape(map::generic::Map<double> & map, unsigned int max_time=std::numeric_limits<unsigned int>::max()) :
+            observable::generic::EscapeTime<double>(map, max_time), steps(new unsigned long(0)) {}
+
+    void evolve(Eigen::VectorXd & point) {
+        observable::generic::EscapeTime<double>::evolve(point);
+        (*steps)++;
+    }
+};
+
+
+// the mean escape time of the canonical ensemble exp(-beta t) of the open tent map, P(t) = (8/15)^(t - 1) 7/15, in
+// the range of `histogram` (one bin per escape time).
+double canonical_mean_escape(double beta, SamplingHistogram<CountingEscape> const& histogram) {
+    double Z = 0, mean = 0;
+    for (unsigned int t = 1; t < histogram.upper_bound(); t++) {
+        double weight = pow(8/15., t - 1)*7/15.*exp(-beta*t);
+        Z += weight;
+        mean += t*weight;
+    }
+    return mean/Z;
+}
+
+
+double mean_escape(SamplingHistogram<CountingEscape> const& histogram) {
+    double mean = 0;
+    for (unsigned int b = 0; b < histogram.bins(); b++)
+        mean += histogram.value(b)*histogram[b]*1./histogram.count();
+    return mean;
+}
+
+
+// the early rejection samples the same distribution with fewer steps of the map, when the escape times cannot be above
+// the range of the histogram.
+TEST(TestUniform, early_rejection) {
+    map::generic::OpenTent<double> map(3, 5);
+    double beta = 1;
+    unsigned int samples = 20000;
+
+    double mean[2];
+    unsigned long steps[2];
+    for (unsigned int early = 0; early < 2; early++) {
+        CountingEscape observable(map, 29);
+        SamplingHistogram<CountingEscape> histogram(0, 30, 30);
+        for (unsigned int b = 0; b <= histogram.bins(); b++)
+            histogram.log_pi[b] = -beta*b;
+        proposal::Uniform<CountingEscape> proposal(map.boundary);
+        MetropolisHastings<CountingEscape, proposal::Uniform<CountingEscape> > mc(observable, proposal, histogram);
+        mc.early_rejection = early == 1;
+
+        mc.sample(samples, 1000);
+        EXPECT_EQ(samples, histogram.count());
+        EXPECT_NEAR(canonical_mean_escape(beta, histogram), mean_escape(histogram), 0.03);
+        mean[early] = mean_escape(histogram);
+        steps[early] = *observable.steps;
+    }
+    EXPECT_NEAR(mean[0], mean[1], 0.04);
+    EXPECT_LT(steps[1], 0.9*steps[0]);
+}
+
+
+// with and without early rejection, a chain is the same from the same stream, also when proposals are out of the range
+// of the histogram: below it (an escape time of 1) and, without a maximum escape time, above it.
+TEST(TestUniform, early_rejection_same_chain) {
+    map::generic::OpenTent<double> map(3, 5);
+    unsigned int const max_times[2] = {5, std::numeric_limits<unsigned int>::max()};
+
+    for (unsigned int m = 0; m < 2; m++) {
+        std::vector<unsigned int> counts[2];
+        std::vector<double> log_pi[2];
+        unsigned long steps[2];
+        for (unsigned int early = 0; early < 2; early++) {
+            CountingEscape observable(map, max_times[m]);
+            SamplingHistogram<CountingEscape> histogram(1, 6, 5);
+            proposal::Uniform<CountingEscape> proposal(map.boundary);
+            WangLandau<CountingEscape, proposal::Uniform<CountingEscape> > mc(observable, proposal, histogram,
+                                                                             aux::Stream(7));
+            mc.early_rejection = early == 1;
+            mc.sample(4, 2000);
+
+            for (unsigned int b = 0; b <= histogram.bins(); b++)
+                counts[early].push_back(histogram[b]);
+            log_pi[early] = histogram.log_pi;
+            steps[early] = *observable.steps;
+        }
+        EXPECT_EQ(counts[0], counts[1]);
+        EXPECT_EQ(log_pi[0], log_pi[1]);
+        if (m == 0)
+            EXPECT_LT(steps[1], steps[0]);
+    }
+}
+
+
+// the histograms of the FTLE of several horizons in one run, reweighted to the uniform distribution of the states.
+TEST(TestUniform, multi_horizon_tent_map) {
+    typedef observable::generic::MultiLyapunov<double> Observable;
+    map::generic::Tent<double> map(3);
+    Observable observable(map, {5, 10});
+
+    MultiHistogram<Observable> histogram(0, 2, 200, (unsigned int) observable.values().size());
+    for (unsigned int b = 0; b <= histogram.bins(); b++)
+        histogram.log_pi[b] = 3*histogram.value(b);
+    proposal::Uniform<Observable> proposal(map.boundary);
+    MetropolisHastings<Observable> mc(observable, proposal, histogram);
+    mc.sample(20000, 100);
+
+    // each FTLE is the mean of log(3) (1/3 of the steps) and log(3/2) (2/3 of the steps) under uniform sampling.
+    double expected = log(3)/3 + 2*log(1.5)/3;
+    for (unsigned int i = 0; i < histogram.values(); i++) {
+        double mean = 0, total = 0;
+        for (unsigned int b = 0; b <= histogram.bins(); b++) {
+            mean += (histogram.value(b) + 0.5*histogram.h())*histogram.distribution(i, b);
+            total += histogram.distribution(i, b);
+        }
+        EXPECT_NEAR(1, total, 1e-12);
+        EXPECT_NEAR(expected, mean, 0.03);
+    }
+}
+
+
 class SamplingHist : public SamplingHistogram<observable::EscapeTime> {
 public:
     double mean_escape;
@@ -86,20 +320,27 @@ TEST(WangLandau, escape_time_tent_map) {
     mpfr::mpreal::set_default_prec(64);
 
     map::OpenTent map(3, 5);
-    observable::EscapeTime observable(map, 10);
 
-    SamplingHist histogram(0, 10, 10);
-    proposal::PowerLawIsotropic<observable::EscapeTime> proposal(map.boundary, -1, 20);
+    // a single chain spreads by about 0.13 around the expected value, so the test averages
+    // independent chains, each with its own fixed stream so the test is reproducible.
+    const unsigned int chains = 8;
+    double mean_escape = 0;
+    for (unsigned int chain = 0; chain < chains; chain++) {
+        observable::EscapeTime observable(map, 10);
+        SamplingHist histogram(0, 10, 10);
+        proposal::PowerLawIsotropic<observable::EscapeTime> proposal(map.boundary, -1, 20);
 
-    WangLandau<observable::EscapeTime> mc(observable, proposal, histogram);
+        WangLandau<observable::EscapeTime> mc(observable, proposal, histogram, aux::Stream(chain + 1));
 
-    mc.sample(10, 10000);
+        mc.sample(10, 10000);
+        mean_escape += histogram.mean_escape/chains;
+    }
 
     // The histogram is flat, thus the expected measured mean escape time is the mean
-    // of the uniform distribution over [0, 10]
+    // of the uniform distribution over [0, 10]. The tolerance is 4 standard deviations
+    // of the mean of the chains.
     double expected = (10 - 0)/2.;
-    EXPECT_NEAR(histogram.mean_escape, expected, expected*0.01);
+    EXPECT_NEAR(mean_escape, expected, 4*0.13/sqrt(chains));
 }
 
-
 #endif
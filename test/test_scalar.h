@@ -0,0 +1,231 @@
+#ifndef chaospp_test_scalar_h
+#define chaospp_test_scalar_h
+
+#include "gtest/gtest.h"
+#include "map.h"
+#include "observable.h"
+#include "sampler.h"
+#include "optimizer.h"
+#include "multi_double.h"
+#if defined(__GNUC__) && !defined(__clang__)
+#include "float128.h"
+#endif
+
+
+// the same observables of `test_observables.h`, in hardware precision.
+template <typename Float>
+class TestScalar : public ::testing::Test {};
+
+#if defined(__GNUC__) && !defined(__clang__)
+typedef ::testing::Types<double, long double, aux::float128, aux::dd_real, aux::qd_real, mpfr::mpreal> Scalars;
+#else
+typedef ::testing::Types<double, long double, aux::dd_real, aux::qd_real, mpfr::mpreal> Scalars;
+#endif
+TYPED_TEST_CASE(TestScalar, Scalars);
+
+
+TYPED_TEST(TestScalar, TentLyapunov) {
+    typedef TypeParam Float;
+    mpfr::mpreal::set_default_prec(64);
+
+    map::generic::Tent<Float> map(3);
+    observable::generic::Lyapunov<Float> obs(map, 10);
+
+    typename map::generic::Tent<Float>::Vector point(1);
+    point[0] = aux::from_string<Float>("0.0000000001");
+
+    obs.observe(point);
+
+    EXPECT_NEAR(log(3.), obs.lyapunov(), 1e-12);
+}
+
+
+TYPED_TEST(TestScalar, OpenTentEscapeTime) {
+    typedef TypeParam Float;
+    mpfr::mpreal::set_default_prec(64);
+
+    map::generic::OpenTent<Float> map(3, 5);
+    observable::generic::EscapeTime<Float> obs(map);
+
+    typename map::generic::OpenTent<Float>::Vector point(1);
+
+    point[0] = aux::from_string<Float>("0.334");
+    obs.observe(point);
+    EXPECT_EQ(1, obs.escape_time);
+
+    point[0] = aux::from_string<Float>("0.0000000001");
+    obs.observe(point);
+    EXPECT_EQ(21, obs.escape_time);
+}
+
+
+TYPED_TEST(TestScalar, StandardMap) {
+    typedef TypeParam Float;
+    mpfr::mpreal::set_default_prec(64);
+
+    map::generic::Standard<Float> map(4);
+
+    typename map::generic::Standard<Float>::Vector point(2);
+    point << aux::from_string<Float>("0.1"), aux::from_string<Float>("0.1");
+
+    map.T(point);
+
+    // same as in `test_map_standard.h`
+    EXPECT_NEAR(0.47419571351545561328516762646, aux::to_double(point[0]), 1e-14);
+    EXPECT_NEAR(0.57419571351545561328516762646, aux::to_double(point[1]), 1e-14);
+}
+
+
+// tests that we obtain the expected mean escape time under uniform sampling (see `test_sampling.h`)
+TYPED_TEST(TestScalar, UniformSampling) {
+    typedef TypeParam Float;
+    typedef observable::generic::EscapeTime<Float> Observable;
+    mpfr::mpreal::set_default_prec(64);
+
+    map::generic::OpenTent<Float> map(3, 5);
+    Observable observable(map, 20);
+
+    SamplingHistogram<Observable> histogram(0, 20, 20);
+    proposal::Uniform<Observable> proposal(map.boundary);
+
+    MetropolisHastings<Observable> mc(observable, proposal, histogram);
+
+    mc.sample(10000);
+
+    double mean = 0;
+    for (unsigned int bin = 0; bin <= histogram.bins(); bin++)
+        mean += histogram.value(bin)*histogram[bin];
+    mean /= histogram.count();
+
+    double expected = 1./(1 - (1/3. + 1/5.));
+    EXPECT_NEAR(expected, mean, expected*0.05);
+}
+
+
+// observables, samplers and optimizers with concrete map and proposal types, called without virtual dispatch.
+TYPED_TEST(TestScalar, StaticDispatch) {
+    typedef TypeParam Float;
+    typedef map::generic::OpenTent<Float> Map;
+    typedef observable::generic::EscapeTime<Float, Eigen::Dynamic, Map> Observable;
+    mpfr::mpreal::set_default_prec(64);
+
+    Map map(3, 5);
+    Observable observable(map, 20);
+    observable::generic::EscapeTime<Float> erased(map, 20);
+    for (unsigned int i = 0; i < 100; i++) {
+        typename Map::Vector point = proposal::proposeUniform(map.boundary);
+        observable.observe(point);
+        erased.observe(point);
+        EXPECT_EQ(erased.escape_time, observable.escape_time);
+    }
+
+    map::generic::Tent<Float> tent(3);
+    observable::generic::Lyapunov<Float, Eigen::Dynamic, map::generic::Tent<Float> > lyapunov(tent, 10);
+    typename Map::Vector point(1);
+    point[0] = aux::from_string<Float>("0.0000000001");
+    lyapunov.observe(point);
+    EXPECT_NEAR(log(3.), lyapunov.lyapunov(), 1e-12);
+
+    // the same as `UniformSampling`
+    typedef proposal::Uniform<Observable> Proposal;
+    SamplingHistogram<Observable> histogram(0, 20, 20);
+    Proposal proposal(map.boundary);
+    MetropolisHastings<Observable, Proposal> mc(observable, proposal, histogram);
+    mc.sample(10000);
+
+    double mean = 0;
+    for (unsigned int bin = 0; bin <= histogram.bins(); bin++)
+        mean += histogram.value(bin)*histogram[bin];
+    mean /= histogram.count();
+
+    double expected = 1./(1 - (1/3. + 1/5.));
+    EXPECT_NEAR(expected, mean, expected*0.05);
+
+    optimizer::generic::Adaptive<Float, Map> optimizer(map, 10);
+    EXPECT_EQ(10, optimizer.get_point().escape_time);
+}
+
+// pi of `mpfr::mpreal` has the default precision, also after it changed (`aux::pi` keeps the one at startup).
+TEST(Mpreal, pi) {
+    mpfr_prec_t precision = mpfr::mpreal::get_default_prec();
+
+    mpfr::mpreal::set_default_prec(300);
+    EXPECT_EQ(300, aux::Scalar<mpfr::mpreal>::pi().get_prec());
+    EXPECT_EQ(mpfr::const_pi(300), aux::Scalar<mpfr::mpreal>::pi());
+
+    mpfr::mpreal::set_default_prec(64);
+    EXPECT_EQ(64, aux::Scalar<mpfr::mpreal>::pi().get_prec());
+    EXPECT_EQ(mpfr::const_pi(64), aux::Scalar<mpfr::mpreal>::pi());
+
+    mpfr::mpreal::set_default_prec(precision);
+}
+
+// the arithmetic and the math functions of the double-double and quad-double scalars, against `mpfr::mpreal`.
+template <typename Scalar>
+void expect_as_mpreal(Scalar const& value, mpfr::mpreal const& expected, double ulps) {
+    mpfr::mpreal error = abs((mpfr::mpreal) value - expected)/std::max(abs(expected), mpfr::mpreal(1));
+    EXPECT_GT(ulps*ldexp(1., -(int) aux::Scalar<Scalar>::digits()), error.toDouble()) << expected;
+}
+
+template <typename Scalar>
+void expect_functions_as_mpreal() {
+    mpfr::mpreal::set_default_prec(600);
+    for (unsigned int i = 0; i < 200; i++) {
+        Scalar a = 20*aux::urandom<Scalar>() - 10;
+        Scalar b = 3*aux::urandom<Scalar>() + Scalar("0.01");
+        mpfr::mpreal A = (mpfr::mpreal) a, B = (mpfr::mpreal) b;
+
+        expect_as_mpreal(a + b, A + B, 4);
+        expect_as_mpreal(a - b, A - B, 4);
+        expect_as_mpreal(a*b, A*B, 4);
+        expect_as_mpreal(a/b, A/B, 4);
+        expect_as_mpreal(sqrt(b), sqrt(B), 4);
+        expect_as_mpreal(exp(a), exp(A), 8);
+        expect_as_mpreal(log(b), log(B), 8);
+        expect_as_mpreal(sin(a), sin(A), 8);
+        expect_as_mpreal(cos(a), cos(A), 8);
+        expect_as_mpreal(atan2(a, b - 1), atan2(A, B - 1), 8);
+        // the condition number of x^y is |y log(x)| < 40
+        expect_as_mpreal(pow(b, a), pow(B, A), 400);
+        expect_as_mpreal(floor(a), floor(A), 0.5);
+        EXPECT_EQ(A < B, a < b);
+    }
+
+    // cancellation
+    Scalar a = aux::urandom<Scalar>();
+    Scalar small = ldexp(aux::urandom<Scalar>(), -100);
+    expect_as_mpreal(a + (small - a), (mpfr::mpreal) small, 4);
+
+    std::stringstream stream;
+    stream.precision(std::numeric_limits<Scalar>::max_digits10);
+    stream << aux::Scalar<Scalar>::pi();
+    EXPECT_EQ(aux::Scalar<Scalar>::pi(), Scalar(stream.str().c_str()));
+}
+
+TEST(MultiDouble, Functions) {
+    expect_functions_as_mpreal<aux::dd_real>();
+    expect_functions_as_mpreal<aux::qd_real>();
+}
+
+// the logarithm near 1, and far from it, where the error of the double logarithm, |log(x)|*2^-53, is the largest.
+template <typename Scalar>
+void expect_log_as_mpreal() {
+    mpfr::mpreal::set_default_prec(600);
+    for (unsigned int i = 0; i < 200; i++) {
+        Scalar u = aux::urandom<Scalar>();
+        Scalar near_one = 1 + ldexp(u - Scalar("0.5"), -20);
+        Scalar small = ldexp(1 + u, -500);
+        Scalar large = ldexp(1 + u, 500);
+
+        expect_as_mpreal(log(near_one), log((mpfr::mpreal) near_one), 8);
+        expect_as_mpreal(log(small), log((mpfr::mpreal) small), 8);
+        expect_as_mpreal(log(large), log((mpfr::mpreal) large), 8);
+    }
+}
+
+TEST(MultiDouble, log) {
+    expect_log_as_mpreal<aux::dd_real>();
+    expect_log_as_mpreal<aux::qd_real>();
+}
+
+#endif
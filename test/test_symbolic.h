@@ -0,0 +1,130 @@
+#ifndef chaospp_test_symbolic_h
+#define chaospp_test_symbolic_h
+
+#include "gtest/gtest.h"
+#include "symbolic.h"
+#include "proposal.h"
+#include "sampler.h"
+
+
+TEST(Symbolic, EscapeTime) {
+    mpfr_prec_t precision = mpfr::mpreal::get_default_prec();
+    mpfr::mpreal::set_default_prec(1000);
+    map::OpenTent map(3, 5);
+    observable::EscapeTime obs(map, 200);
+    observable::symbolic::EscapeTime<map::OpenTent> exact(map, 200);
+
+    for (unsigned int i = 0; i < 200; i++) {
+        Vector point = proposal::proposeUniform(map.boundary);
+        obs.observe(point);
+        exact.observe(point);
+        EXPECT_EQ(obs.escape_time, exact.escape_time);
+        EXPECT_EQ(exact.escape_time, exact.counts[0] + exact.counts[1]);
+    }
+
+    Vector point(1);
+    point[0] = Float("0.334");
+    exact.observe(point);
+    EXPECT_EQ(1, exact.escape_time);
+
+    point[0] = Float("0.0000000001");
+    exact.observe(point);
+    EXPECT_EQ(21, exact.escape_time);
+    mpfr::mpreal::set_default_prec(precision);
+}
+
+
+TEST(Symbolic, Lyapunov) {
+    mpfr_prec_t precision = mpfr::mpreal::get_default_prec();
+    mpfr::mpreal::set_default_prec(1000);
+    map::Tent map(3);
+    observable::Lyapunov obs(map, 100);
+    observable::symbolic::Lyapunov<map::Tent> exact(map, 100);
+
+    for (unsigned int i = 0; i < 100; i++) {
+        Vector point = proposal::proposeUniform(map.boundary);
+        obs.observe(point);
+        exact.observe(point);
+        EXPECT_NEAR(obs.lyapunov(), exact.lyapunov(), 1e-12);
+        EXPECT_NEAR(obs.lyapunov(), (double) log(exact.stretch())/100, 1e-12);
+    }
+
+    // a trajectory much longer than the precision of the state (2^-53): only the exact one follows it.
+    map::generic::Tent<double> double_map(3);
+    observable::symbolic::Lyapunov<map::generic::Tent<double> > exact_double(double_map, 2000);
+    Eigen::VectorXd point(1);
+    point[0] = 0.1;
+    exact_double.observe(point);
+    EXPECT_EQ(2000u, exact_double.counts[0] + exact_double.counts[1]);
+    EXPECT_LT(0u, exact_double.counts[0]);
+    EXPECT_LT(0u, exact_double.counts[1]);
+    mpfr::mpreal::set_default_prec(precision);
+}
+
+
+TEST(Symbolic, LyapunovDistribution) {
+    // the tent map with a = 3: P(k visits to the left branch) = C(t, k) (1/3)^k (2/3)^(t - k)
+    unsigned int t = 12;
+    symbolic::PiecewiseLinear dynamics = symbolic::tent(3);
+    std::map<std::vector<unsigned int>, symbolic::Rational> distribution = dynamics.lyapunov_distribution(0, 1, t);
+
+    EXPECT_EQ(t + 1, distribution.size());
+    symbolic::Rational binomial(1);
+    for (unsigned int k = 0; k <= t; k++) {
+        std::vector<unsigned int> counts(2);
+        counts[0] = k;
+        counts[1] = t - k;
+        EXPECT_EQ(binomial*pow(symbolic::Rational(1, 3), k)*pow(symbolic::Rational(2, 3), t - k), distribution[counts]);
+        binomial = binomial*symbolic::Rational(t - k, k + 1);
+    }
+}
+
+
+TEST(Symbolic, EscapeTimeDistribution) {
+    // the open tent map with a = 3, b = 5: P(T = t) = (8/15)^(t - 1) 7/15
+    map::OpenTent map(3, 5);
+    std::vector<symbolic::Rational> distribution = symbolic::dynamics(map).escape_time_distribution(0, 1, 30);
+
+    EXPECT_EQ(symbolic::Rational(0), distribution[0]);
+    for (unsigned int t = 1; t < 30; t++)
+        EXPECT_EQ(pow(symbolic::Rational(8, 15), t - 1)*symbolic::Rational(7, 15), distribution[t]);
+    EXPECT_EQ(pow(symbolic::Rational(8, 15), 29), distribution[30]);
+
+    // the tent map: the escape times of uniform samples follow the exact distribution.
+    map::generic::Tent<double> tent(3);
+    unsigned int max_time = 20;
+    distribution = symbolic::dynamics(tent).escape_time_distribution(0, 1, max_time);
+    symbolic::Rational total;
+    double mean = 0, mean2 = 0;
+    for (unsigned int t = 0; t <= max_time; t++) {
+        total += distribution[t];
+        mean += t*distribution[t].to_double();
+        mean2 += t*t*distribution[t].to_double();
+    }
+    EXPECT_EQ(symbolic::Rational(1), total);
+
+    observable::symbolic::EscapeTime<map::generic::Tent<double> > obs(tent, max_time);
+    unsigned int samples = 10000;
+    double sample_mean = 0;
+    for (unsigned int i = 0; i < samples; i++) {
+        obs.observe(proposal::proposeUniform(tent.boundary));
+        sample_mean += obs.escape_time*1./samples;
+    }
+    EXPECT_NEAR(mean, sample_mean, 5*sqrt((mean2 - mean*mean)/samples));
+}
+
+
+TEST(Symbolic, Entropy) {
+    // the entropy of `sample/lyapunov_tent.cpp`: one bin per number of visits to the left branch.
+    unsigned int t = 20;
+    double a = 3;
+    map::Tent map(a);
+    SamplingHistogram<observable::Lyapunov> histogram(log(a/(a - 1)) - 0.0001, log(a) - 0.0001, t);
+
+    std::vector<double> entropy = symbolic::lyapunov_entropy(map, t, histogram);
+    for (unsigned int k = 0; k <= t; k++)
+        EXPECT_NEAR(lgamma(t + 1) - lgamma(k + 1) - lgamma(t - k + 1) + k*log(1/a) + (t - k)*log((a - 1)/a),
+                    entropy[k], 1e-10);
+}
+
+#endif //chaospp_test_symbolic_h
@@ -0,0 +1,288 @@
+#ifndef chaospp_test_threads_h
+#define chaospp_test_threads_h
+
+#include <memory>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "map.h"
+#include "observable.h"
+#include "proposal.h"
+#include "sampler.h"
+
+
+// observes `points` with copies of `observable` in `threads` threads, which share its map.
+template <typename Observable>
+std::vector<double> observe_in_threads(Observable const& observable, std::vector<typename Observable::Vector> const& points,
+                                       unsigned int threads, mpfr_prec_t precision) {
+    std::vector<double> values(points.size());
+    std::vector<std::thread> workers;
+    for (unsigned int t = 0; t < threads; t++)
+        workers.push_back(std::thread([&, t]() {
+            mpfr::mpreal::set_default_prec(precision);
+            Observable copy(observable);
+            for (size_t i = t; i < points.size(); i += threads) {
+                copy.observe(points[i]);
+                values[i] = copy.lyapunov();
+            }
+        }));
+    for (unsigned int t = 0; t < threads; t++)
+        workers[t].join();
+    return values;
+}
+
+
+// one map evaluated concurrently by the observables of several threads gives the results of the serial evaluation.
+TEST(Threads, shared_map) {
+    mpfr::mpreal::set_default_prec(128);
+    unsigned int const threads = 4, N = 40;
+
+    map::generic::Standard<double> standard(6);
+    observable::generic::Lyapunov<double> standard_observable(standard, 50);
+    map::NCoupledHenon henon(6);
+    observable::LyapunovSpectrum henon_observable(henon, 20);
+
+    std::vector<Eigen::VectorXd> standard_points(N);
+    std::vector<Vector> henon_points(N);
+    std::vector<double> standard_expected(N), henon_expected(N);
+    for (unsigned int i = 0; i < N; i++) {
+        standard_points[i] = proposal::proposeUniform(standard.boundary);
+        standard_observable.observe(standard_points[i]);
+        standard_expected[i] = standard_observable.lyapunov();
+
+        henon_points[i] = proposal::proposeUniform(henon.boundary)/4;
+        henon_observable.observe(henon_points[i]);
+        henon_expected[i] = henon_observable.lyapunov();
+    }
+
+    std::vector<double> standard_values = observe_in_threads(standard_observable, standard_points, threads, 128);
+    std::vector<double> henon_values = observe_in_threads(henon_observable, henon_points, threads, 128);
+    for (unsigned int i = 0; i < N; i++) {
+        EXPECT_EQ(standard_expected[i], standard_values[i]);
+        EXPECT_EQ(henon_expected[i], henon_values[i]);
+    }
+
+    // the evaluations without a workspace use one per thread.
+    std::vector<Matrix> jacobians(threads);
+    std::vector<std::thread> workers;
+    for (unsigned int t = 0; t < threads; t++)
+        workers.push_back(std::thread([&, t]() {
+            mpfr::mpreal::set_default_prec(128);
+            jacobians[t] = henon.jacobian(henon_points[t]);
+        }));
+    for (unsigned int t = 0; t < threads; t++) {
+        workers[t].join();
+        EXPECT_EQ(0, (jacobians[t] - henon.jacobian(henon_points[t])).cwiseAbs().maxCoeff());
+    }
+}
+
+
+
+// the workspaces of the maps destroyed in other threads are deleted by the threads that evaluated them.
+TEST(Threads, workspaces_of_destroyed_maps) {
+    std::size_t workspaces = 0;
+    std::thread worker([&]() {
+        Eigen::VectorXd point(1);
+        for (unsigned int batch = 0; batch < 10; batch++) {
+            std::vector<std::unique_ptr<map::generic::Tent<double> > > maps;
+            for (unsigned int i = 0; i < 100; i++) {
+                maps.push_back(std::unique_ptr<map::generic::Tent<double> >(new map::generic::Tent<double>(3)));
+                point[0] = 0.1;
+                maps.back()->T(point);
+            }
+            std::thread([&]() {maps.clear();}).join();
+        }
+        workspaces = map::generic::Map<double>::local_workspaces();
+    });
+    worker.join();
+
+    EXPECT_LT(0u, workspaces);
+    EXPECT_GE(256u, workspaces);
+}
+
+
+// a chain draws the tangent vectors of its observations from its stream: two chains with the same stream give the
+// same histogram in different threads, whatever the threads drew before.
+TEST(Threads, chain_stream_of_observations) {
+    typedef observable::generic::EscapeWithVector<double> Observable;
+    typedef proposal::LyapunovIsotropic<Observable> Proposal;
+    typedef SamplingHistogram<Observable> Histogram;
+    map::generic::Standard<double> map(6);
+    Observable observable(map, 10);
+
+    std::vector<std::unique_ptr<Histogram> > histograms;
+    std::vector<std::thread> workers;
+    for (unsigned int t = 0; t < 2; t++)
+        histograms.push_back(std::unique_ptr<Histogram>(new Histogram(0, 10, 10)));
+    for (unsigned int t = 0; t < 2; t++)
+        workers.push_back(std::thread([&, t]() {
+            for (unsigned int i = 0; i < 7*t; i++)
+                aux::Stream::local()();
+            Proposal proposal(map.boundary, 1);
+            WangLandau<Observable, Proposal> mc(observable, proposal, *histograms[t], aux::Stream(11));
+            mc.sample(2, 500);
+        }));
+    for (unsigned int t = 0; t < 2; t++)
+        workers[t].join();
+
+    EXPECT_EQ(500u, histograms[0]->count());
+    for (unsigned int bin = 0; bin <= histograms[0]->bins(); bin++) {
+        EXPECT_EQ((*histograms[0])[bin], (*histograms[1])[bin]);
+        EXPECT_EQ(histograms[0]->log_pi[bin], histograms[1]->log_pi[bin]);
+    }
+}
+
+
+// with one walker, the parallel Wang-Landau is the serial one with the same stream.
+TEST(Threads, parallel_wang_landau_one_walker) {
+    mpfr::mpreal::set_default_prec(64);
+    map::OpenTent map(3, 5);
+    observable::EscapeTime observable(map, 10);
+    typedef proposal::PowerLawIsotropic<observable::EscapeTime> Proposal;
+    Proposal proposal(map.boundary, -1, 20);
+
+    SamplingHistogram<observable::EscapeTime> serial_histogram(0, 10, 10), parallel_histogram(0, 10, 10);
+    WangLandau<observable::EscapeTime, Proposal> serial(observable, proposal, serial_histogram, aux::Stream(3));
+    serial.sample(3, 2000);
+    ParallelWangLandau<observable::EscapeTime, Proposal> parallel(observable, proposal, parallel_histogram, 1, 3);
+    parallel.sample(3, 2000);
+
+    EXPECT_EQ(2000u, parallel_histogram.count());
+    for (unsigned int bin = 0; bin <= serial_histogram.bins(); bin++) {
+        EXPECT_EQ(serial_histogram[bin], parallel_histogram[bin]);
+        EXPECT_EQ(serial_histogram.log_pi[bin], parallel_histogram.log_pi[bin]);
+    }
+}
+
+
+// the walkers estimate the density of states of the escape time of the open tent map, exp(t*log(8/15)).
+TEST(Threads, parallel_wang_landau) {
+    mpfr::mpreal::set_default_prec(64);
+    map::OpenTent map(3, 5);
+    observable::EscapeTime observable(map, 10);
+    typedef proposal::PowerLawIsotropic<observable::EscapeTime> Proposal;
+    Proposal proposal(map.boundary, -1, 20);
+
+    SamplingHistogram<observable::EscapeTime> histogram(0, 10, 10);
+    ParallelWangLandau<observable::EscapeTime, Proposal> mc(observable, proposal, histogram, 4, 5);
+    mc.flatness = 0.8;
+    mc.sample(12, 20000);
+
+    EXPECT_LE(20000u, histogram.count());
+    EXPECT_EQ(1./(1 << 12), mc.modification_factor());
+
+    // the slope of the least squares fit of the entropy over the bins of the range, 1 to 9.
+    double sum_t = 0, sum_s = 0, sum_tt = 0, sum_ts = 0;
+    for (unsigned int bin = 1; bin < 10; bin++) {
+        sum_t += bin;
+        sum_s += histogram.entropy(bin);
+        sum_tt += bin*bin;
+        sum_ts += bin*histogram.entropy(bin);
+    }
+    EXPECT_NEAR(log(8./15), (9*sum_ts - sum_t*sum_s)/(9*sum_tt - sum_t*sum_t), 0.05);
+}
+
+
+// the windows of replica exchange estimate the density of states of the escape time of the open tent map,
+// exp(t*log(8/15)), up to t = 23, with their swaps accepted, and it is stitched into the histogram.
+TEST(Threads, replica_exchange_wang_landau) {
+    mpfr::mpreal::set_default_prec(128);
+    map::OpenTent map(3, 5);
+    observable::EscapeTime observable(map, 24);
+    typedef proposal::PowerLawIsotropic<observable::EscapeTime> Proposal;
+    Proposal proposal(map.boundary, -1, 48);
+
+    SamplingHistogram<observable::EscapeTime> histogram(0, 24, 24);
+    ReplicaExchangeWangLandau<observable::EscapeTime, Proposal> mc(observable, proposal, histogram, 3, 0.5, 2, 7);
+    mc.flatness = 0.8;
+    mc.sample(14, 10000);
+
+    EXPECT_EQ(1u, mc.first_bin(0));
+    EXPECT_EQ(23u, mc.last_bin(2));
+    for (unsigned int w = 0; w + 1 < mc.windows(); w++) {
+        EXPECT_LE(mc.first_bin(w + 1), mc.last_bin(w));
+        EXPECT_LT(0, mc.exchange_rate(w));
+    }
+    EXPECT_LT(0u, mc.round_trips());
+
+    EXPECT_EQ(-std::numeric_limits<double>::infinity(), histogram.entropy(0));
+    double sum_t = 0, sum_s = 0, sum_tt = 0, sum_ts = 0;
+    for (unsigned int bin = 1; bin < 24; bin++) {
+        EXPECT_EQ(-histogram.entropy(bin), histogram.log_pi[bin]);
+        sum_t += bin;
+        sum_s += histogram.entropy(bin);
+        sum_tt += bin*bin;
+        sum_ts += bin*histogram.entropy(bin);
+    }
+    EXPECT_NEAR(log(8./15), (23*sum_ts - sum_t*sum_s)/(23*sum_tt - sum_t*sum_t), 0.05);
+}
+
+
+
+// access to the stitching of the entropies of the windows.
+class StitchedReplicaExchange : public ReplicaExchangeWangLandau<observable::EscapeTime,
+                                                                 proposal::PowerLawIsotropic<observable::EscapeTime> > {
+public:
+    using ReplicaExchangeWangLandau<observable::EscapeTime,
+                                    proposal::PowerLawIsotropic<observable::EscapeTime> >::ReplicaExchangeWangLandau;
+    using ReplicaExchangeWangLandau<observable::EscapeTime,
+                                    proposal::PowerLawIsotropic<observable::EscapeTime> >::stitch;
+
+    //! the entropy S(t) = slope*t + constant in the window `w`, with the escape time `gap` not visited.
+    void set_window_entropy(unsigned int w, double slope, double constant, unsigned int gap) {
+        std::vector<double> entropy(_histograms[w]->bins() + 1);
+        for (unsigned int bin = 0; bin < entropy.size(); bin++) {
+            unsigned int t = bin + first_bin(w) - 1;
+            entropy[bin] = t == gap ? -std::numeric_limits<double>::infinity() : slope*t + constant;
+        }
+        _histograms[w]->set_entropy(entropy);
+    }
+};
+
+
+// the windows are stitched in their range; the bins that no window visited have an unknown (NaN) entropy, and the
+// bins out of the range keep theirs.
+TEST(Threads, replica_exchange_stitch_gap) {
+    mpfr::mpreal::set_default_prec(64);
+    map::OpenTent map(3, 5);
+    observable::EscapeTime observable(map, 12);
+    proposal::PowerLawIsotropic<observable::EscapeTime> proposal(map.boundary, -1, 20);
+
+    SamplingHistogram<observable::EscapeTime> histogram(0, 12, 12);
+    StitchedReplicaExchange mc(observable, proposal, histogram, 2, 0.5, 1);
+    ASSERT_EQ(1u, mc.first_bin(0));
+    ASSERT_EQ(11u, mc.last_bin(1));
+    ASSERT_LT(mc.first_bin(1), mc.last_bin(0));
+    ASSERT_LT(mc.last_bin(0), 10u);
+
+    mc.set_window_entropy(0, -0.5, 3, 0);
+    mc.set_window_entropy(1, -0.5, -7, 10);
+    mc.stitch();
+
+    EXPECT_EQ(-std::numeric_limits<double>::infinity(), histogram.entropy(0));
+    EXPECT_EQ(-std::numeric_limits<double>::infinity(), histogram.entropy(12));
+    EXPECT_TRUE(std::isnan(histogram.entropy(10)));
+    for (unsigned int t = 1; t <= 11; t++) {
+        if (t == 10)
+            continue;
+        EXPECT_NEAR(-0.5*t + 3, histogram.entropy(t), 1e-12);
+        EXPECT_EQ(-histogram.entropy(t), histogram.log_pi[t]);
+    }
+}
+
+
+// the climb to a window that cannot be reached (above `max_time`) stops.
+TEST(Threads, replica_exchange_unreachable_window) {
+    mpfr::mpreal::set_default_prec(64);
+    map::OpenTent map(3, 5);
+    observable::EscapeTime observable(map, 5);
+    typedef proposal::PowerLawIsotropic<observable::EscapeTime> Proposal;
+    Proposal proposal(map.boundary, -1, 20);
+
+    SamplingHistogram<observable::EscapeTime> histogram(0, 24, 24);
+    ReplicaExchangeWangLandau<observable::EscapeTime, Proposal> mc(observable, proposal, histogram, 3, 0.5, 1);
+    mc.max_climb_steps = 1000;
+    EXPECT_THROW(mc.sample(1, 100), std::runtime_error);
+}
+
+#endif
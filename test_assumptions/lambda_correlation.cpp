@@ -1,5 +1,5 @@
 /*
- * Moves the trajectory t/2 steps and measures \lambda1, advances more t/2 and measures \lambda2,
+ * Measures \lambda1 in the first t/2 steps of a trajectory and \lambda2 in the next t/2 steps,
  * output lambda1, lambda2. They should be independent of each other.
  */
 
@@ -25,25 +25,15 @@ void measure(std::string directory="./") {
 
     proposal::Uniform<observable::EscapeTime> proposal(map.boundary);
 
+    // the windows [0, t/2] and [t/2, t] of a single trajectory.
+    observable::MultiLyapunov result(map, std::vector<unsigned int>(1, 16), 8);
+
     std::vector<std::vector<double> > data;
     for (unsigned int i = 0; i < 10000; i++) {
-        Vector state = proposal.proposeUniform();
-
-        // measures [0, t/2]
-        observable::Lyapunov result(map, 8);
-        result.observe(state);
-
-        // advances `state` to t/2
-        for (unsigned int t = 0; t < 8; t++) {
-            map.T(state);
-        }
-
-        // measures [t/2, t]
-        observable::Lyapunov result_prime(map, 8);
-        result_prime.observe(state);
+        result.observe(proposal.proposeUniform());
 
         // stores both results
-        std::vector<double> temp = {result.lyapunov(), result_prime.lyapunov()};
+        std::vector<double> temp = {result.window_lyapunov(0), result.window_lyapunov(1)};
         data.push_back(temp);
     }
 